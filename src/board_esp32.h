@@ -70,6 +70,10 @@
 		#define CORE_COUNT 2 // amount of CPU cores available to board
 	#endif
 
+	#ifndef CACHE_LINE_SIZE
+		#define CACHE_LINE_SIZE 32 // bytes per CPU cache line
+	#endif
+
 	#include <hal/gpio_types.h>
 
 	#ifndef EXTERNAL_LED_PIN
@@ -92,6 +96,38 @@
 		#define NVM_INTERNAL // uses internal nvm functions
 	#endif
 
+	/****************************
+	 * Serial Config
+	****************************/
+
+	#ifndef SERIAL_TX_BUFFER_SIZE
+		#define SERIAL_TX_BUFFER_SIZE 16384 // bytes of UART TX ring buffer for binary frames
+	#endif
+
+	#ifndef SERIAL_RX_BUFFER_SIZE
+		#define SERIAL_RX_BUFFER_SIZE 1024 // bytes of UART RX ring buffer (over 128)
+	#endif
+
+	#ifndef FRAME_MAX_PAYLOAD
+		#define FRAME_MAX_PAYLOAD 4096 // max payload bytes of a binary frame
+	#endif
+
+	#ifndef SERIAL_BAUD_MAX
+		#define SERIAL_BAUD_MAX 5000000 // highest baud tried when SERIAL_NEGOTIATE is set
+	#endif
+
+	#ifndef SERIAL_LINK_WAIT_MS
+		#define SERIAL_LINK_WAIT_MS 100 // time to wait for host reply while negotiating
+	#endif
+
+	#ifndef SERIAL_PATTERN_SIZE
+		#define SERIAL_PATTERN_SIZE 1024 // bytes of test pattern checked at each baud
+	#endif
+
+	#ifndef SERIAL_MEASURE_SIZE
+		#define SERIAL_MEASURE_SIZE 65536 // bytes sent to measure sustained rate
+	#endif
+
 	/****************************
 	 * NVM Config
 	****************************/
@@ -103,6 +139,117 @@
 		#define __NVM_BEGIN_RETURN__ // Checks return parameter of nvm begin
 	#endif
 
+	#ifndef NVM_CACHE_SIZE
+		#define NVM_CACHE_SIZE 64 // values kept in RAM cache (power of 2)
+	#endif
+
+	#ifndef NVM_COMMIT_DELAY_MS
+		#define NVM_COMMIT_DELAY_MS 500 // time cached writes wait to be committed together
+	#endif
+
+	#ifndef NVM_JOURNAL_SIZE
+		#define NVM_JOURNAL_SIZE 16 // values committed under their own keys before config record is rewritten
+	#endif
+
+	#ifndef NVM_BATCH_SIZE
+		#define NVM_BATCH_SIZE 64 // writes a batch can stage
+	#endif
+
+	#ifndef NVM_LOCK_WAIT_MS
+		#define NVM_LOCK_WAIT_MS 100 // time NVM calls wait for other holders before failing busy
+	#endif
+
+	#ifndef NVM_ASYNC_QUEUE_SIZE
+		#define NVM_ASYNC_QUEUE_SIZE 32 // async writes waiting for writer task
+	#endif
+
+	#ifndef NVM_ASYNC_CORE
+		#define NVM_ASYNC_CORE PROCESS_CORE // core running async writer task
+	#endif
+
+	#ifndef NVM_ASYNC_PRIORITY
+		#define NVM_ASYNC_PRIORITY 2 // FreeRTOS priority of async writer task
+	#endif
+
+	#ifndef NVM_ASYNC_FLUSH_MS
+		#define NVM_ASYNC_FLUSH_MS 1000 // time flush waits for queued async writes
+	#endif
+
+	/****************************
+	 * Multi Core Config
+	 * 
+	 * Acquisition and its ISRs stay on one core,
+	 * processing and transport use the other
+	****************************/
+
+	#ifndef ACQUIRE_CORE
+		#define ACQUIRE_CORE 0 // core for acquisition tasks and timer ISRs
+	#endif
+
+	#ifndef PROCESS_CORE
+		#define PROCESS_CORE 1 // core for processing and transport tasks
+	#endif
+
+	#ifndef PIPELINE_PRIORITY
+		#define PIPELINE_PRIORITY 10 // FreeRTOS priority of pipeline tasks
+	#endif
+
+	#ifndef PIPELINE_IDLE_MS
+		#define PIPELINE_IDLE_MS 1 // max time a pipeline stage sleeps without new data
+	#endif
+
+	#ifndef PIPELINE_POLL_MS
+		#define PIPELINE_POLL_MS 10 // max time acquisition polls before blocking a tick for IDLE
+	#endif
+
+	/****************************
+	 * ADC Config
+	 * 
+	 * Continuous capture runs ADC1 through I2S0 DMA
+	****************************/
+
+	#define ADC_FREQ_MAX 2000000 // max sample rate of continuous ADC capture
+
+	#ifndef ADC_BLOCK_SIZE
+		#define ADC_BLOCK_SIZE 1024 // samples per DMA block (max 1024)
+	#endif
+
+	#ifndef ADC_DMA_BUF_COUNT
+		#define ADC_DMA_BUF_COUNT 2 // amount of DMA descriptors cycled by I2S driver
+	#endif
+
+	#ifndef ADC_BLOCK_COUNT
+		#define ADC_BLOCK_COUNT 2 // amount of blocks passed between capture and consumer
+	#endif
+
+	#ifndef ADC_CAPTURE_ATTEN
+		#define ADC_CAPTURE_ATTEN ADC_ATTEN_DB_11 // input attenuation of captured pins
+	#endif
+
+	#ifndef ADC_CAPTURE_CORE
+		#define ADC_CAPTURE_CORE ACQUIRE_CORE // core capture task runs on
+	#endif
+
+	#ifndef ADC_CAPTURE_PRIORITY
+		#define ADC_CAPTURE_PRIORITY 20 // FreeRTOS priority of capture task
+	#endif
+
+	/****************************
+	 * Calibration Config
+	****************************/
+
+	#ifndef CALIB_ATTEN_MASK
+		#define CALIB_ATTEN_MASK 0x08 // attenuations given a table, bit n is ADC_ATTEN n
+	#endif
+
+	#ifndef CALIB_DEFAULT_VREF
+		#define CALIB_DEFAULT_VREF 1100 // reference in mV used when eFuse has none
+	#endif
+
+	#ifndef CALIB_NVM_KEY
+		#define CALIB_NVM_KEY 0xCA10 // NVM key of attenuation 0 table, attenuation n uses key + n
+	#endif
+
 	/****************************
 	 * Timer Config
 	 * 
@@ -115,6 +262,22 @@
 		#define NUM_TIMERS 4 // amount of hardware timers to use
 	#endif
 
+	#ifndef TIMER_JOB_MAX
+		#define TIMER_JOB_MAX 16 // jobs sharing one hardware timer (max 32)
+	#endif
+
+	#ifndef WHEEL_TICK_US
+		#define WHEEL_TICK_US 10 // resolution of virtual timers in us
+	#endif
+
+	#ifndef WHEEL_CORE
+		#define WHEEL_CORE PROCESS_CORE // core running virtual timer callbacks and tick ISR
+	#endif
+
+	#ifndef WHEEL_PRIORITY
+		#define WHEEL_PRIORITY 5 // FreeRTOS priority of virtual timer callbacks
+	#endif
+
 	typedef bool hard_timer_return_t; // return type of timer function
 	typedef void* hard_timer_param_t; // parameter type of timer function
 
@@ -141,7 +304,7 @@
 	 * @note 	HARD_TIMER_END();
 	 * @note }
 	 * 
-	 * @warning emptyParams doesn't include any user input parameters
+	 * @warning emptyParams doesn't include any user input parameters unless set with 'setHardTimerContext'
 	 * @warning 64-bit counter
 	 * @warning 16-bit scalar
 	 */
@@ -0,0 +1,500 @@
+/*
+	board_esp32_adc.c - continuous ADC capture for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_adc.h"
+#include "board_esp32_trigger.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <driver/i2s.h>
+#include <driver/adc.h>
+#include <esp_intr_alloc.h>
+
+#define ADC_I2S_PORT I2S_NUM_0 // only I2S0 can be driven by ADC1
+#define ADC_EVENT_QUEUE_LEN (ADC_DMA_BUF_COUNT * 2) // I2S event queue length
+#define ADC_BLOCK_BYTES (ADC_BLOCK_SIZE * sizeof(adc_sample_t)) // bytes per block
+#define ADC_CAPTURE_STACK 4096U // stack size of capture task
+#define ADC_STOP_POLL_MS 10U // how often capture task checks for stop
+#define ADC_READ_WAIT_MS 10U // max wait for DMA data after event
+#define ADC1_CHANNEL_COUNT 8U // channel tags ADC1 can produce
+#define SCAN_SLOT_NONE UINT8_MAX // channel tag not in scan list
+#define NS_PER_SECOND 1000000000ULL // nanoseconds in a second
+
+typedef struct adc_pin_s {
+	uint8_t pin; // GPIO number
+	adc1_channel_t channel; // ADC1 channel on GPIO
+} adc_pin_channel_t;
+
+// ADC1 channels and their GPIO
+static const adc_pin_channel_t adcPins[] = {
+	{.pin=D36, .channel=ADC1_CHANNEL_0},
+	{.pin=D39, .channel=ADC1_CHANNEL_3},
+	{.pin=D32, .channel=ADC1_CHANNEL_4},
+	{.pin=D33, .channel=ADC1_CHANNEL_5},
+	{.pin=D34, .channel=ADC1_CHANNEL_6},
+	{.pin=D35, .channel=ADC1_CHANNEL_7},
+};
+
+// blocks passed to consumer
+static adc_sample_t adcBlocks[ADC_BLOCK_COUNT][ADC_BLOCK_SIZE];
+static uint32_t blockSequence[ADC_BLOCK_COUNT];
+static uint16_t blockLength[ADC_BLOCK_COUNT];
+
+// DMA data kept inside capture (triggering or consumer behind)
+static adc_sample_t scratchBlock[ADC_BLOCK_SIZE];
+
+static QueueHandle_t i2sEvents = NULL; // events from I2S driver
+static QueueHandle_t readyBlocks = NULL; // slots waiting for consumer
+static QueueHandle_t freeBlocks = NULL; // slots waiting for DMA data
+static SemaphoreHandle_t captureStopped = NULL; // given when capture task exits
+static SemaphoreHandle_t frameReady = NULL; // given when trigger completes a frame
+static TaskHandle_t captureTask = NULL;
+
+static volatile bool captureRunning = false;
+static uint32_t captureUsers = 0U; // tasks inside take, release or frame wait, kept until they leave stop
+static struct adcCaptureStats captureStats;
+static trigger_t * volatile captureTrigger = NULL; // trigger fed inside capture task
+
+// scan list
+static adc_digi_pattern_table_t scanPattern[ADC_COUNT];
+static uint8_t scanSlot[ADC1_CHANNEL_COUNT]; // scan position of each channel tag
+static uint8_t scanCount = 0U;
+static freq_t scanRate = 0U; // aggregate conversions per second
+
+/**
+ * Frees capture queues and DMA driver
+ *
+ * @param driverInstalled if I2S driver needs uninstalled
+ */
+static void adcCaptureFree(bool driverInstalled) {
+
+	if (driverInstalled) {
+		i2s_adc_disable(ADC_I2S_PORT);
+		i2s_driver_uninstall(ADC_I2S_PORT);
+	}
+	i2sEvents = NULL;
+
+	if (readyBlocks != NULL) {
+		vQueueDelete(readyBlocks);
+		readyBlocks = NULL;
+	}
+	if (freeBlocks != NULL) {
+		vQueueDelete(freeBlocks);
+		freeBlocks = NULL;
+	}
+	if (captureStopped != NULL) {
+		vSemaphoreDelete(captureStopped);
+		captureStopped = NULL;
+	}
+	if (frameReady != NULL) {
+		vSemaphoreDelete(frameReady);
+		frameReady = NULL;
+	}
+}
+
+/**
+ * Enters a call that uses capture queues or semaphores
+ *
+ * @note pairs with 'adcCaptureLeave', stop frees nothing while a call is inside
+ *
+ * @return if capture is running, left again when not
+ */
+static bool adcCaptureEnter(void) {
+
+	__atomic_add_fetch(&captureUsers, 1U, __ATOMIC_SEQ_CST);
+	if (!__atomic_load_n(&captureRunning, __ATOMIC_SEQ_CST)) {
+		__atomic_sub_fetch(&captureUsers, 1U, __ATOMIC_SEQ_CST);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Leaves a call entered with 'adcCaptureEnter'
+ */
+static void adcCaptureLeave(void) {
+	__atomic_sub_fetch(&captureUsers, 1U, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Moves full DMA blocks into free slots for the consumer
+ *
+ * @param params unused
+ *
+ * @note one copy per block, no work per sample
+ */
+static void adcCaptureTask(void *params) {
+
+	uint32_t sequence = 0U;
+	i2s_event_t event;
+
+	while (captureRunning) {
+
+		if (xQueueReceive(i2sEvents, &event, pdMS_TO_TICKS(ADC_STOP_POLL_MS)) != pdTRUE) {
+			continue;
+		}
+
+		if (event.type == I2S_EVENT_RX_Q_OVF) {
+			// driver dropped its oldest block
+			captureStats.dmaOverruns++;
+			sequence++;
+			continue;
+		}
+		if (event.type != I2S_EVENT_RX_DONE) {
+			continue;
+		}
+
+		trigger_t *trigger = captureTrigger;
+		if (trigger != NULL) {
+			// only completed frames leave the capture task
+			size_t bytesRead = 0U;
+			i2s_read(ADC_I2S_PORT, scratchBlock, ADC_BLOCK_BYTES, &bytesRead, pdMS_TO_TICKS(ADC_READ_WAIT_MS));
+			if (bytesRead == 0U) {
+				continue;
+			}
+
+			adc_block_t block = {
+				.samples = scratchBlock,
+				.length = bytesRead / sizeof(adc_sample_t),
+				.sequence = sequence++,
+				.slot = ADC_BLOCK_COUNT,
+			};
+			if (triggerFeedBlock(trigger, &block) > 0U && trigger -> state == TRIGGER_DONE) {
+				xSemaphoreGive(frameReady);
+			}
+			continue;
+		}
+
+		uint8_t slot;
+		adc_sample_t *dest;
+
+		if (xQueueReceive(freeBlocks, &slot, 0) == pdTRUE) {
+			dest = adcBlocks[slot];
+		}
+		else {
+			// consumer is behind, drain block so DMA keeps running
+			dest = scratchBlock;
+		}
+
+		size_t bytesRead = 0U;
+		i2s_read(ADC_I2S_PORT, dest, ADC_BLOCK_BYTES, &bytesRead, pdMS_TO_TICKS(ADC_READ_WAIT_MS));
+
+		if (bytesRead == 0U) {
+			// event of a buffer the driver already dropped
+			if (dest != scratchBlock) {
+				xQueueSend(freeBlocks, &slot, 0);
+			}
+			continue;
+		}
+		if (dest == scratchBlock) {
+			captureStats.blockOverruns++;
+			sequence++;
+			continue;
+		}
+
+		blockSequence[slot] = sequence++;
+		blockLength[slot] = bytesRead / sizeof(adc_sample_t);
+		captureStats.blocks++;
+		xQueueSend(readyBlocks, &slot, 0);
+	}
+
+	xSemaphoreGive(captureStopped);
+	vTaskDelete(NULL);
+}
+
+bool adcPinChannel(pin_t pin, uint8_t *channel) {
+
+	if (channel == NULL) {
+		return false;
+	}
+
+	for (uint8_t i = 0U; i < sizeof(adcPins) / sizeof(adcPins[0]); i++) {
+		if (adcPins[i].pin == pin) {
+			*channel = adcPins[i].channel;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool adcCaptureStart(pin_t pin, freq_t *freq) {
+	return adcScanStart(&pin, 1U, freq);
+}
+
+bool adcScanStart(const pin_t *pins, uint8_t pinCount, freq_t *freq) {
+
+	if (pins == NULL || freq == NULL || captureRunning) {
+		return false;
+	}
+	if (pinCount == 0U || pinCount > ADC_COUNT) {
+		return false;
+	}
+	if (*freq == (freq_t)0 || *freq > ADC_FREQ_MAX) {
+		return false;
+	}
+
+	// builds scan list
+	for (uint8_t i = 0U; i < ADC1_CHANNEL_COUNT; i++) {
+		scanSlot[i] = SCAN_SLOT_NONE;
+	}
+	for (uint8_t i = 0U; i < pinCount; i++) {
+		uint8_t channel;
+		if (!adcPinChannel(pins[i], &channel)) {
+			return false;
+		}
+		if (scanSlot[channel] != SCAN_SLOT_NONE) {
+			// pin listed twice
+			return false;
+		}
+		scanSlot[channel] = i;
+		scanPattern[i].atten = ADC_CAPTURE_ATTEN;
+		scanPattern[i].bit_width = ADC_WIDTH_BIT_12;
+		scanPattern[i].channel = channel;
+	}
+	scanCount = pinCount;
+
+	i2s_config_t config = {
+		.mode = I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN,
+		.sample_rate = *freq,
+		.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+		.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+		.communication_format = I2S_COMM_FORMAT_STAND_I2S,
+		.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+		.dma_buf_count = ADC_DMA_BUF_COUNT,
+		.dma_buf_len = ADC_BLOCK_SIZE,
+		.use_apll = false,
+	};
+
+	if (i2s_driver_install(ADC_I2S_PORT, &config, ADC_EVENT_QUEUE_LEN, &i2sEvents) != ESP_OK) {
+		return false;
+	}
+	if (i2s_set_adc_mode(ADC_UNIT_1, (adc1_channel_t)scanPattern[0].channel) != ESP_OK) {
+		adcCaptureFree(true);
+		return false;
+	}
+	for (uint8_t i = 0U; i < pinCount; i++) {
+		adc1_config_channel_atten((adc1_channel_t)scanPattern[i].channel, ADC_CAPTURE_ATTEN);
+	}
+
+	readyBlocks = xQueueCreate(ADC_BLOCK_COUNT, sizeof(uint8_t));
+	freeBlocks = xQueueCreate(ADC_BLOCK_COUNT, sizeof(uint8_t));
+	captureStopped = xSemaphoreCreateBinary();
+	frameReady = xSemaphoreCreateBinary();
+	if (readyBlocks == NULL || freeBlocks == NULL || captureStopped == NULL || frameReady == NULL) {
+		adcCaptureFree(true);
+		return false;
+	}
+	for (uint8_t slot = 0U; slot < ADC_BLOCK_COUNT; slot++) {
+		xQueueSend(freeBlocks, &slot, 0);
+	}
+
+	captureStats.blocks = 0U;
+	captureStats.dmaOverruns = 0U;
+	captureStats.blockOverruns = 0U;
+	captureRunning = true;
+
+	if (xTaskCreatePinnedToCore(adcCaptureTask, "adcCapture", ADC_CAPTURE_STACK, NULL, ADC_CAPTURE_PRIORITY, &captureTask, ADC_CAPTURE_CORE) != pdPASS) {
+		captureRunning = false;
+		adcCaptureFree(true);
+		return false;
+	}
+
+	i2s_adc_enable(ADC_I2S_PORT);
+
+	if (pinCount > 1U) {
+		// enabling resets ADC1 pattern to a single channel, so scan list goes after
+		adc_digi_config_t scanConfig = {
+			.conv_limit_en = false,
+			.conv_limit_num = 0U,
+			.adc1_pattern_len = pinCount,
+			.adc2_pattern_len = 0U,
+			.adc1_pattern = scanPattern,
+			.adc2_pattern = NULL,
+			.conv_mode = ADC_CONV_SINGLE_UNIT_1,
+			.format = ADC_DIGI_FORMAT_12BIT,
+		};
+		if (adc_digi_controller_config(&scanConfig) != ESP_OK) {
+			adcCaptureStop();
+			return false;
+		}
+	}
+
+	scanRate = (freq_t)i2s_get_clk(ADC_I2S_PORT);
+	*freq = scanRate;
+
+	return true;
+}
+
+uint16_t RUN_IN_RAM(adcScanSplit) adcScanSplit(const adc_block_t *block, adc_scan_buffers_t *buffers) {
+
+	if (block == NULL || buffers == NULL || block -> samples == NULL) {
+		return 0U;
+	}
+
+	// swapped pairs need whole 32-bit words, lone last sample has no partner
+	uint16_t length = block -> length & (uint16_t)~1U;
+	uint16_t dropped = block -> length - length;
+	const adc_sample_t *samples = block -> samples;
+
+	for (uint16_t i = 0U; i < length; i++) {
+		adc_sample_t sample = samples[ADC_SAMPLE_INDEX(i)];
+		uint8_t slot = scanSlot[ADC_SAMPLE_CHANNEL(sample) & (ADC1_CHANNEL_COUNT - 1U)];
+
+		if (slot == SCAN_SLOT_NONE || buffers -> length[slot] >= buffers -> capacity) {
+			dropped++;
+			continue;
+		}
+		buffers -> channels[slot][buffers -> length[slot]++] = ADC_SAMPLE_VALUE(sample);
+	}
+
+	return dropped;
+}
+
+bool adcScanGetRate(freq_t *aggregate, freq_t *perChannel) {
+
+	if (!captureRunning || scanCount == 0U) {
+		return false;
+	}
+
+	if (aggregate != NULL) {
+		*aggregate = scanRate;
+	}
+	if (perChannel != NULL) {
+		*perChannel = scanRate / scanCount;
+	}
+
+	return true;
+}
+
+uint32_t adcScanGetSkewNS(uint8_t index) {
+
+	if (!captureRunning || index >= scanCount || scanRate == (freq_t)0) {
+		return 0U;
+	}
+
+	// conversions run back to back, one aggregate period apart
+	return (uint32_t)((uint64_t)index * NS_PER_SECOND / scanRate);
+}
+
+bool adcCaptureStop(void) {
+
+	if (!captureRunning) {
+		return false;
+	}
+
+	__atomic_store_n(&captureRunning, false, __ATOMIC_SEQ_CST);
+	xSemaphoreTake(captureStopped, portMAX_DELAY);
+	captureTask = NULL;
+
+	// wakes tasks blocked on queues and semaphores before they are freed
+	uint8_t wake = ADC_BLOCK_COUNT;
+	while (__atomic_load_n(&captureUsers, __ATOMIC_SEQ_CST) != 0U) {
+		xQueueSend(readyBlocks, &wake, 0);
+		xSemaphoreGive(frameReady);
+		vTaskDelay(1U);
+	}
+
+	adcCaptureFree(true);
+
+	return true;
+}
+
+bool adcCaptureRunning(void) {
+	return captureRunning;
+}
+
+bool adcCaptureTake(adc_block_t *block, uint32_t waitMS) {
+
+	if (block == NULL || !adcCaptureEnter()) {
+		return false;
+	}
+
+	uint8_t slot;
+	bool taken = xQueueReceive(readyBlocks, &slot, pdMS_TO_TICKS(waitMS)) == pdTRUE;
+	adcCaptureLeave();
+
+	// stop wakes waiters with slot ADC_BLOCK_COUNT
+	if (!taken || slot >= ADC_BLOCK_COUNT || !captureRunning) {
+		return false;
+	}
+
+	block -> samples = adcBlocks[slot];
+	block -> length = blockLength[slot];
+	block -> sequence = blockSequence[slot];
+	block -> slot = slot;
+
+	return true;
+}
+
+bool adcCaptureRelease(adc_block_t *block) {
+
+	if (block == NULL || block -> samples == NULL || block -> slot >= ADC_BLOCK_COUNT) {
+		return false;
+	}
+	if (!adcCaptureEnter()) {
+		return false;
+	}
+
+	xQueueSend(freeBlocks, &block -> slot, 0);
+	adcCaptureLeave();
+	block -> samples = NULL;
+
+	return true;
+}
+
+bool adcCaptureSetTrigger(trigger_t *trigger) {
+
+	if (trigger != NULL && trigger -> state == TRIGGER_IDLE) {
+		// trigger must be armed to collect frames
+		return false;
+	}
+
+	captureTrigger = trigger;
+
+	return true;
+}
+
+bool adcCaptureWaitFrame(uint32_t waitMS) {
+
+	if (captureTrigger == NULL || !adcCaptureEnter()) {
+		return false;
+	}
+
+	bool ready = xSemaphoreTake(frameReady, pdMS_TO_TICKS(waitMS)) == pdTRUE;
+	adcCaptureLeave();
+
+	// stop wakes waiters without a frame
+	return ready && captureRunning;
+}
+
+void adcCaptureGetStats(struct adcCaptureStats *stats) {
+
+	if (stats == NULL) {
+		return;
+	}
+
+	*stats = captureStats;
+}
+
+#endif
@@ -0,0 +1,235 @@
+/*
+	board_esp32_adc.h - continuous ADC capture for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_ADC_H
+#define BOARD_ESP32_ADC_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "../../board_common.h"
+#include "../../hard_timer.h"
+
+/****************************
+ * Sample Format
+ *
+ * I2S delivers 16-bit words holding
+ * the ADC1 channel in the top 4 bits
+ * and the conversion in the low 12 bits
+****************************/
+
+typedef uint16_t adc_sample_t; // raw sample type produced by DMA
+
+#define ADC_SAMPLE_BITS 12U // resolution of a sample
+#define ADC_SAMPLE_MAX 4095U // max value of a sample
+
+/**
+ * Gets conversion value from raw sample
+ *
+ * @param sample raw sample
+ */
+#define ADC_SAMPLE_VALUE(sample) ((sample) & 0x0FFFU)
+
+/**
+ * Gets ADC1 channel from raw sample
+ *
+ * @param sample raw sample
+ */
+#define ADC_SAMPLE_CHANNEL(sample) ((sample) >> 12U)
+
+/**
+ * Gets position of sample within block in time order
+ *
+ * @param index sample number in time order
+ *
+ * @note I2S stores samples with each 32-bit word half swapped
+ */
+#define ADC_SAMPLE_INDEX(index) ((index) ^ 1U)
+
+/****************************
+ * Capture Types
+****************************/
+
+typedef struct adc_block_s {
+	adc_sample_t *samples; // raw samples in DMA order
+	uint16_t length; // amount of samples in block
+	uint32_t sequence; // DMA block number since start, gaps are lost blocks
+	uint8_t slot; // buffer slot of block
+} adc_block_t;
+
+typedef struct adc_scan_buffers_s {
+	uint16_t *channels[ADC_COUNT]; // per channel storage in scan list order
+	uint16_t length[ADC_COUNT]; // samples stored per channel
+	uint16_t capacity; // max samples per channel storage
+} adc_scan_buffers_t;
+
+struct adcCaptureStats {
+	uint32_t blocks; // blocks handed to consumer
+	uint32_t dmaOverruns; // blocks dropped by the I2S driver
+	uint32_t blockOverruns; // blocks dropped while consumer held every slot
+};
+
+struct trigger_s; // see board_esp32_trigger.h
+
+/****************************
+ * Capture Functions
+****************************/
+
+/**
+ * Gets ADC1 channel connected to pin
+ *
+ * @param pin pin to look up (ADC0..ADC5)
+ * @param channel pointer to store ADC1 channel
+ *
+ * @return if pin is connected to ADC1
+ */
+bool adcPinChannel(pin_t pin, uint8_t *channel);
+
+/**
+ * Starts continuous DMA capture of pin
+ *
+ * @param pin pin to capture (ADC0..ADC5)
+ * @param freq pointer to desired sample rate in Hz
+ *
+ * @note freq value is changed to actual sample rate
+ *
+ * @return if capture was started
+ */
+bool adcCaptureStart(pin_t pin, freq_t *freq);
+
+/**
+ * Starts continuous DMA capture of several pins interleaved
+ *
+ * @param pins pins to capture in scan order (ADC0..ADC5)
+ * @param pinCount amount of pins (1..ADC_COUNT)
+ * @param freq pointer to desired aggregate sample rate in Hz
+ *
+ * @note freq value is changed to actual aggregate sample rate
+ * @note each pin is sampled at freq / pinCount
+ *
+ * @return if capture was started
+ */
+bool adcScanStart(const pin_t *pins, uint8_t pinCount, freq_t *freq);
+
+/**
+ * Splits interleaved block into per channel buffers in one pass
+ *
+ * @param block block from 'adcCaptureTake'
+ * @param buffers per channel storage, lengths are appended to
+ *
+ * @note samples are routed by channel tag so blocks may end mid scan
+ * @note odd last sample of block is counted as dropped, see 'ADC_SAMPLE_INDEX'
+ * @note stored samples are conversion values without channel tag
+ *
+ * @return amount of samples dropped, storage full or channel not scanned
+ */
+uint16_t adcScanSplit(const adc_block_t *block, adc_scan_buffers_t *buffers);
+
+/**
+ * Gets scan sample rates
+ *
+ * @param aggregate pointer to store conversions per second over all pins, can be NULL
+ * @param perChannel pointer to store samples per second of each pin, can be NULL
+ *
+ * @return if capture is running
+ */
+bool adcScanGetRate(freq_t *aggregate, freq_t *perChannel);
+
+/**
+ * Gets time channel is sampled after first channel of a scan
+ *
+ * @param index position of channel in scan list
+ *
+ * @return skew in nanoseconds, 0 if index or capture is invalid
+ */
+uint32_t adcScanGetSkewNS(uint8_t index);
+
+/**
+ * Stops continuous capture and frees DMA driver
+ *
+ * @warning blocks taken before stopping are invalid after
+ *
+ * @note safe while other tasks wait in 'adcCaptureTake' or
+ * 'adcCaptureWaitFrame', they are woken and return false
+ * before queues are freed
+ *
+ * @return if capture was stopped
+ */
+bool adcCaptureStop(void);
+
+/**
+ * Gets whether continuous capture is running
+ *
+ * @return if capture is running
+ */
+bool adcCaptureRunning(void);
+
+/**
+ * Takes next full block from capture
+ *
+ * @param block pointer to store block
+ * @param waitMS max time to wait for block
+ *
+ * @note block must be given back with 'adcCaptureRelease'
+ *
+ * @return if block was taken
+ */
+bool adcCaptureTake(adc_block_t *block, uint32_t waitMS);
+
+/**
+ * Gives block back to capture for refilling
+ *
+ * @param block block from 'adcCaptureTake'
+ *
+ * @return if block was released
+ */
+bool adcCaptureRelease(adc_block_t *block);
+
+/**
+ * Moves triggering inside capture
+ *
+ * @param trigger armed trigger, NULL to stream blocks again
+ *
+ * @note while set, blocks only feed trigger and are not handed to consumer
+ * @note re-arm with 'triggerArm' after reading frame
+ *
+ * @return if trigger was set
+ */
+bool adcCaptureSetTrigger(struct trigger_s *trigger);
+
+/**
+ * Waits for trigger set in capture to complete a frame
+ *
+ * @param waitMS max time to wait for frame
+ *
+ * @note read frame with 'triggerGetFrame'
+ *
+ * @return if frame completed
+ */
+bool adcCaptureWaitFrame(uint32_t waitMS);
+
+/**
+ * Gets capture counters since start
+ *
+ * @param stats pointer to store counters
+ */
+void adcCaptureGetStats(struct adcCaptureStats *stats);
+
+#endif
+#endif
@@ -0,0 +1,271 @@
+/*
+	board_esp32_calib.c - ADC calibration tables for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_calib.h"
+#include "board_esp32_nvm.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+
+#define CALIB_VERSION 2U // changes invalidate every stored table
+#define CALIB_COEFF_A_SCALE 65536U // scale of characterization gain, matches IDF
+
+// amount of tables kept in RAM
+#define CALIB_TABLE_COUNT ( \
+	((CALIB_ATTEN_MASK >> 0) & 1) + ((CALIB_ATTEN_MASK >> 1) & 1) + \
+	((CALIB_ATTEN_MASK >> 2) & 1) + ((CALIB_ATTEN_MASK >> 3) & 1))
+
+typedef struct calib_blob_header_s {
+	uint16_t version; // CALIB_VERSION table was stored with
+	uint16_t length; // entries in table
+	uint8_t atten; // attenuation of table
+	uint8_t calType; // eFuse source of characterization
+	uint8_t fracBits; // CALIB_FRAC_BITS of entries
+	uint8_t deltaBytes; // bytes per stored step, 1 or 2
+	uint16_t first; // entry of raw code 0
+	uint32_t coeffA; // characterization gain
+	uint32_t coeffB; // characterization offset
+	uint32_t vref; // characterization reference
+} calib_blob_header_t;
+
+// table stored as steps between codes, bytes when every step fits
+typedef struct calib_blob_s {
+	calib_blob_header_t header;
+	union {
+		int8_t narrow[CALIB_TABLE_SIZE - 1U]; // steps when all fit in a byte
+		int16_t wide[CALIB_TABLE_SIZE - 1U]; // steps when any needs more
+	} deltas;
+} calib_blob_t;
+
+/**
+ * Gets bytes of blob holding steps of a size
+ *
+ * @param deltaBytes bytes per step
+ */
+#define CALIB_BLOB_SIZE(deltaBytes) (offsetof(calib_blob_t, deltas) + (CALIB_TABLE_SIZE - 1U) * (deltaBytes))
+
+static uint16_t calibStorage[CALIB_TABLE_COUNT][CALIB_TABLE_SIZE];
+const uint16_t *calibTables[CALIB_ATTEN_COUNT] = {NULL, NULL, NULL, NULL};
+static uint8_t loadedCount = 0U;
+
+/**
+ * Fills header describing characterization
+ *
+ * @param header header to fill
+ * @param atten attenuation of table
+ * @param calType eFuse source of characterization
+ * @param chars characterization table is built from
+ */
+static void calibFillHeader(calib_blob_header_t *header, uint8_t atten, esp_adc_cal_value_t calType, const esp_adc_cal_characteristics_t *chars) {
+	header -> version = CALIB_VERSION;
+	header -> length = CALIB_TABLE_SIZE;
+	header -> atten = atten;
+	header -> calType = (uint8_t)calType;
+	header -> fracBits = CALIB_FRAC_BITS;
+	header -> deltaBytes = 0U;
+	header -> first = 0U;
+	header -> coeffA = chars -> coeff_a;
+	header -> coeffB = chars -> coeff_b;
+	header -> vref = chars -> vref;
+}
+
+/**
+ * Builds fixed point table from characterization
+ *
+ * @param table table to fill
+ * @param chars characterization of attenuation
+ *
+ * @note linear part keeps sub millivolt steps, IDF curve corrections are whole mV
+ */
+static void calibBuild(uint16_t *table, const esp_adc_cal_characteristics_t *chars) {
+
+	for (uint16_t raw = 0U; raw < CALIB_TABLE_SIZE; raw++) {
+		uint64_t gain = (uint64_t)chars -> coeff_a * raw;
+		int64_t linearMV = (int64_t)((gain + CALIB_COEFF_A_SCALE / 2U) / CALIB_COEFF_A_SCALE) + chars -> coeff_b;
+		int64_t linearFixed = (int64_t)((gain * CALIB_ONE_MV + CALIB_COEFF_A_SCALE / 2U) / CALIB_COEFF_A_SCALE) + (int64_t)chars -> coeff_b * CALIB_ONE_MV;
+		int64_t correction = (int64_t)esp_adc_cal_raw_to_voltage(raw, chars) - linearMV;
+
+		int64_t value = linearFixed + correction * CALIB_ONE_MV;
+		if (value < 0) {
+			value = 0;
+		}
+		else if (value > UINT16_MAX) {
+			value = UINT16_MAX;
+		}
+		table[raw] = (uint16_t)value;
+	}
+}
+
+#ifdef NVM_INTERNAL
+
+/**
+ * Loads table from NVM if it matches characterization
+ *
+ * @param blob scratch blob storage
+ * @param expected header of current characterization
+ * @param table table to fill
+ *
+ * @return if table was loaded
+ */
+static bool calibLoad(calib_blob_t *blob, const calib_blob_header_t *expected, uint16_t *table) {
+
+	size_t length = sizeof(calib_blob_t);
+	if (!nvmGetBlob(CALIB_NVM_KEY + expected -> atten, blob, &length)) {
+		return false;
+	}
+	if (length < sizeof(calib_blob_header_t)) {
+		return false;
+	}
+
+	// stale when layout, eFuse data or IDF math changed
+	const calib_blob_header_t *header = &blob -> header;
+	if (header -> version != expected -> version || header -> length != expected -> length ||
+		header -> atten != expected -> atten || header -> calType != expected -> calType ||
+		header -> fracBits != expected -> fracBits ||
+		header -> coeffA != expected -> coeffA || header -> coeffB != expected -> coeffB ||
+		header -> vref != expected -> vref) {
+		return false;
+	}
+	if ((header -> deltaBytes != sizeof(int8_t) && header -> deltaBytes != sizeof(int16_t)) ||
+		length != CALIB_BLOB_SIZE(header -> deltaBytes)) {
+		return false;
+	}
+
+	table[0] = header -> first;
+	for (uint16_t raw = 1U; raw < CALIB_TABLE_SIZE; raw++) {
+		int16_t delta = (header -> deltaBytes == sizeof(int8_t)) ? blob -> deltas.narrow[raw - 1U] : blob -> deltas.wide[raw - 1U];
+		table[raw] = (uint16_t)(table[raw - 1U] + delta);
+	}
+
+	return true;
+}
+
+/**
+ * Stores table in NVM
+ *
+ * @param blob scratch blob storage
+ * @param header header of current characterization
+ * @param table table to store
+ *
+ * @note steps are widened to 2 bytes when any does not fit in 1
+ *
+ * @return if table was stored, false if a step does not fit in 2 bytes
+ */
+static bool calibStore(calib_blob_t *blob, const calib_blob_header_t *header, const uint16_t *table) {
+
+	blob -> header = *header;
+	blob -> header.first = table[0];
+	blob -> header.deltaBytes = sizeof(int8_t);
+
+	for (uint16_t raw = 1U; raw < CALIB_TABLE_SIZE; raw++) {
+		int32_t delta = (int32_t)table[raw] - table[raw - 1U];
+		if (delta < INT16_MIN || delta > INT16_MAX) {
+			// never truncated, table is rebuilt each boot instead
+			return false;
+		}
+		if (delta < INT8_MIN || delta > INT8_MAX) {
+			blob -> header.deltaBytes = sizeof(int16_t);
+		}
+	}
+
+	for (uint16_t raw = 1U; raw < CALIB_TABLE_SIZE; raw++) {
+		int32_t delta = (int32_t)table[raw] - table[raw - 1U];
+		if (blob -> header.deltaBytes == sizeof(int8_t)) {
+			blob -> deltas.narrow[raw - 1U] = (int8_t)delta;
+		}
+		else {
+			blob -> deltas.wide[raw - 1U] = (int16_t)delta;
+		}
+	}
+
+	return nvmWriteBlob(CALIB_NVM_KEY + header -> atten, blob, CALIB_BLOB_SIZE(blob -> header.deltaBytes));
+}
+
+#else
+
+// without NVM tables are built every boot
+#define calibLoad(blob, expected, table) false
+#define calibStore(blob, header, table) false
+
+#endif
+
+bool calibInit(void) {
+
+	calib_blob_t *blob = malloc(sizeof(calib_blob_t));
+	uint8_t slot = 0U;
+
+	for (uint8_t atten = 0U; atten < CALIB_ATTEN_COUNT; atten++) {
+
+		if (!(CALIB_ATTEN_MASK & (1U << atten))) {
+			continue;
+		}
+
+		uint16_t *table = calibStorage[slot++];
+		if (calibTables[atten] != NULL) {
+			continue;
+		}
+
+		esp_adc_cal_characteristics_t chars;
+		esp_adc_cal_value_t calType = esp_adc_cal_characterize(ADC_UNIT_1, (adc_atten_t)atten, ADC_WIDTH_BIT_12, CALIB_DEFAULT_VREF, &chars);
+
+		calib_blob_header_t header;
+		calibFillHeader(&header, atten, calType, &chars);
+
+		if (blob != NULL && calibLoad(blob, &header, table)) {
+			loadedCount++;
+		}
+		else {
+			calibBuild(table, &chars);
+			if (blob != NULL) {
+				calibStore(blob, &header, table);
+			}
+		}
+
+		calibTables[atten] = table;
+	}
+
+	free(blob);
+
+	for (uint8_t atten = 0U; atten < CALIB_ATTEN_COUNT; atten++) {
+		if ((CALIB_ATTEN_MASK & (1U << atten)) && calibTables[atten] == NULL) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool calibReady(uint8_t atten) {
+
+	if (atten >= CALIB_ATTEN_COUNT) {
+		return false;
+	}
+	return calibTables[atten] != NULL;
+}
+
+uint8_t calibLoadedCount(void) {
+	return loadedCount;
+}
+
+#endif
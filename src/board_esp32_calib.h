@@ -0,0 +1,103 @@
+/*
+	board_esp32_calib.h - ADC calibration tables for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_CALIB_H
+#define BOARD_ESP32_CALIB_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_adc.h"
+
+/****************************
+ * Calibration Tables
+ *
+ * One fixed point millivolt entry per raw
+ * code for each attenuation in CALIB_ATTEN_MASK
+****************************/
+
+#define CALIB_ATTEN_COUNT 4U // attenuation settings of ADC1
+#define CALIB_TABLE_SIZE (ADC_SAMPLE_MAX + 1U) // entries per table
+#define CALIB_FRAC_BITS 4U // fractional bits of table entries, 1/16 mV
+#define CALIB_ONE_MV (1U << CALIB_FRAC_BITS) // table value of 1 mV
+
+// tables indexed by attenuation, NULL when not in CALIB_ATTEN_MASK
+extern const uint16_t *calibTables[CALIB_ATTEN_COUNT];
+
+/**
+ * Converts raw sample to fixed point millivolts
+ *
+ * @param atten attenuation sample was taken with
+ * @param sample raw sample, channel tag is ignored
+ *
+ * @note keeps sub millivolt steps for averaging and filtering
+ *
+ * @warning attenuation must be ready, see 'calibReady'
+ *
+ * @return voltage in 1 / CALIB_ONE_MV mV
+ */
+static inline uint16_t RUN_IN_RAM(calibToFixed) calibToFixed(uint8_t atten, adc_sample_t sample) {
+	return calibTables[atten][ADC_SAMPLE_VALUE(sample)];
+}
+
+/**
+ * Converts raw sample to millivolts
+ *
+ * @param atten attenuation sample was taken with
+ * @param sample raw sample, channel tag is ignored
+ *
+ * @warning attenuation must be ready, see 'calibReady'
+ *
+ * @return voltage in mV, rounded to nearest
+ */
+static inline uint16_t RUN_IN_RAM(calibToMV) calibToMV(uint8_t atten, adc_sample_t sample) {
+	return (uint16_t)((calibToFixed(atten, sample) + (CALIB_ONE_MV / 2U)) >> CALIB_FRAC_BITS);
+}
+
+/****************************
+ * Calibration Functions
+****************************/
+
+/**
+ * Loads tables from NVM or builds and stores them
+ *
+ * @note call after 'nvmInit', without NVM tables are built every boot
+ *
+ * @return if every table in CALIB_ATTEN_MASK is ready
+ */
+bool calibInit(void);
+
+/**
+ * Gets whether attenuation has a table
+ *
+ * @param atten attenuation to check
+ *
+ * @return if 'calibToMV' can be used with attenuation
+ */
+bool calibReady(uint8_t atten);
+
+/**
+ * Gets how many tables were loaded from NVM instead of built
+ *
+ * @return amount of tables loaded
+ */
+uint8_t calibLoadedCount(void);
+
+#endif
+#endif
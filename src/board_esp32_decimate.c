@@ -0,0 +1,149 @@
+/*
+	board_esp32_decimate.c - min/max envelope decimation for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_decimate.h"
+
+/**
+ * Starts new empty bucket
+ *
+ * @param decimator decimator to reset
+ */
+static inline void decimatorReset(decimator_t *decimator) {
+	decimator -> bucketSize = decimator -> nextBucketSize;
+	decimator -> count = 0U;
+	decimator -> min = UINT16_MAX;
+	decimator -> max = 0U;
+	decimator -> sum = 0U;
+}
+
+/**
+ * Stores current bucket as point and starts next bucket
+ *
+ * @param decimator decimator to output
+ * @param out storage for point
+ */
+static inline void decimatorEmit(decimator_t *decimator, envelope_point_t *out) {
+	out -> min = decimator -> min;
+	out -> max = decimator -> max;
+	out -> mean = decimator -> mean ? (uint16_t)(decimator -> sum / decimator -> count) : 0U;
+	out -> count = decimator -> count;
+	decimatorReset(decimator);
+}
+
+/**
+ * Adds sample to current bucket
+ *
+ * @param decimator decimator to add to
+ * @param sample raw sample
+ *
+ * @return if bucket is full
+ */
+static inline bool decimatorAdd(decimator_t *decimator, adc_sample_t sample) {
+
+	uint16_t value = ADC_SAMPLE_VALUE(sample);
+
+	if (value < decimator -> min) {
+		decimator -> min = value;
+	}
+	if (value > decimator -> max) {
+		decimator -> max = value;
+	}
+	decimator -> sum += value;
+
+	return ++decimator -> count >= decimator -> bucketSize;
+}
+
+bool decimatorInit(decimator_t *decimator, uint16_t bucketSize, bool mean) {
+
+	if (decimator == NULL || bucketSize == 0U) {
+		return false;
+	}
+
+	decimator -> nextBucketSize = bucketSize;
+	decimator -> mean = mean;
+	decimatorReset(decimator);
+
+	return true;
+}
+
+bool decimatorSetBucket(decimator_t *decimator, uint16_t bucketSize) {
+
+	if (decimator == NULL || bucketSize == 0U) {
+		return false;
+	}
+
+	decimator -> nextBucketSize = bucketSize;
+
+	return true;
+}
+
+uint16_t RUN_IN_RAM(decimatorFeed) decimatorFeed(decimator_t *decimator, const adc_sample_t *samples, uint16_t count, envelope_point_t *out, uint16_t maxOut, uint16_t *used) {
+
+	uint16_t points = 0U;
+	uint16_t i = 0U;
+
+	if (decimator != NULL && samples != NULL && out != NULL) {
+		while (i < count && points < maxOut) {
+			if (decimatorAdd(decimator, samples[i++])) {
+				decimatorEmit(decimator, &out[points++]);
+			}
+		}
+	}
+
+	if (used != NULL) {
+		*used = i;
+	}
+
+	return points;
+}
+
+uint16_t RUN_IN_RAM(decimatorFeedBlock) decimatorFeedBlock(decimator_t *decimator, const adc_block_t *block, envelope_point_t *out, uint16_t maxOut) {
+
+	if (decimator == NULL || block == NULL || block -> samples == NULL || out == NULL) {
+		return 0U;
+	}
+
+	// samples are stored in swapped pairs
+	uint16_t length = block -> length & ~1U;
+	uint16_t points = 0U;
+
+	for (uint16_t i = 0U; i < length && points < maxOut; i++) {
+		if (decimatorAdd(decimator, block -> samples[ADC_SAMPLE_INDEX(i)])) {
+			decimatorEmit(decimator, &out[points++]);
+		}
+	}
+
+	return points;
+}
+
+bool decimatorFlush(decimator_t *decimator, envelope_point_t *out) {
+
+	if (decimator == NULL || out == NULL || decimator -> count == 0U) {
+		return false;
+	}
+
+	decimatorEmit(decimator, out);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+	board_esp32_decimate.h - min/max envelope decimation for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_DECIMATE_H
+#define BOARD_ESP32_DECIMATE_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_adc.h"
+
+/****************************
+ * Decimator Types
+ *
+ * Each bucket of samples becomes one
+ * min/max pair so glitches stay visible
+****************************/
+
+typedef struct envelope_point_s {
+	uint16_t min; // lowest value in bucket
+	uint16_t max; // highest value in bucket
+	uint16_t mean; // average of bucket, 0 if mean disabled
+	uint16_t count; // samples in bucket
+} envelope_point_t;
+
+typedef struct decimator_s {
+	uint16_t bucketSize; // samples per point of current bucket
+	volatile uint16_t nextBucketSize; // samples per point from next bucket on
+	uint16_t count; // samples in current bucket
+	uint16_t min; // lowest value in current bucket
+	uint16_t max; // highest value in current bucket
+	uint32_t sum; // sum of current bucket when mean enabled
+	bool mean; // if mean is computed
+} decimator_t;
+
+/****************************
+ * Decimator Functions
+****************************/
+
+/**
+ * Sets up decimator
+ *
+ * @param decimator decimator to set up
+ * @param bucketSize samples per output point
+ * @param mean if mean of each bucket is computed
+ *
+ * @return if decimator was set up
+ */
+bool decimatorInit(decimator_t *decimator, uint16_t bucketSize, bool mean);
+
+/**
+ * Changes bucket size without reallocating
+ *
+ * @param decimator decimator to change
+ * @param bucketSize samples per output point
+ *
+ * @note applies from next bucket on, safe while another task feeds
+ *
+ * @return if bucket size is valid
+ */
+bool decimatorSetBucket(decimator_t *decimator, uint16_t bucketSize);
+
+/**
+ * Reduces samples in time order to envelope points in one pass
+ *
+ * @param decimator decimator to feed
+ * @param samples samples in time order, channel tags are ignored
+ * @param count amount of samples
+ * @param out storage for points
+ * @param maxOut max amount of points to store
+ * @param used pointer to store amount of samples used, can be NULL
+ *
+ * @note buckets carry over between calls
+ * @note stops early when out is full
+ *
+ * @return amount of points stored
+ */
+uint16_t decimatorFeed(decimator_t *decimator, const adc_sample_t *samples, uint16_t count, envelope_point_t *out, uint16_t maxOut, uint16_t *used);
+
+/**
+ * Reduces DMA block to envelope points in one pass
+ *
+ * @param decimator decimator to feed
+ * @param block block from capture
+ * @param out storage for points
+ * @param maxOut max amount of points to store
+ *
+ * @note stops early when out is full
+ *
+ * @return amount of points stored
+ */
+uint16_t decimatorFeedBlock(decimator_t *decimator, const adc_block_t *block, envelope_point_t *out, uint16_t maxOut);
+
+/**
+ * Outputs partially filled bucket
+ *
+ * @param decimator decimator to flush
+ * @param out storage for point
+ *
+ * @return if a point was stored
+ */
+bool decimatorFlush(decimator_t *decimator, envelope_point_t *out);
+
+#endif
+#endif
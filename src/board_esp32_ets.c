@@ -0,0 +1,288 @@
+/*
+	board_esp32_ets.c - equivalent time sampling for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_ets.h"
+#include "board_esp32_timer.h"
+
+#include <stdlib.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#define ETS_STACK 4096U // stack size of merge task
+#define ETS_POLL_MS 10U // how often merge task checks for stop
+#define ETS_BITS 32U // bits per filled flag word
+
+static struct etsConfig ets;
+static uint32_t outputLength = 0U; // samples in reconstructed waveform
+static uint32_t *filledBits = NULL; // set once output sample is written
+static volatile uint32_t filledCount = 0U;
+static volatile uint32_t passCount = 0U;
+
+static hard_timer_t etsTimer = HARD_TIMER_INVALID;
+static timertick_t stepTicks = 0U; // phase shift between passes
+static freq_t realFreq = 0U; // actual real sample rate
+
+static TaskHandle_t etsTask = NULL;
+static SemaphoreHandle_t etsReady = NULL; // given once timer setup finished
+static SemaphoreHandle_t etsFilled = NULL; // given once output is filled
+static SemaphoreHandle_t etsExited = NULL; // given when merge task exits
+static volatile bool etsRunning = false;
+
+/**
+ * Samples signal and feeds trigger
+ *
+ * @param emptyParams unused
+ *
+ * @return if a higher priority task was woken
+ */
+static hard_timer_return_t RUN_IN_RAM(etsTimerISR) etsTimerISR(hard_timer_param_t emptyParams) {
+
+	BaseType_t woken = pdFALSE;
+
+	if (triggerPush(ets.trigger, ets.read())) {
+		vTaskNotifyGiveFromISR(etsTask, &woken);
+	}
+
+	return woken == pdTRUE;
+}
+
+/**
+ * Places triggered frame into output by its crossing time
+ *
+ * @note crossing is interpolated between the samples around the trigger
+ */
+static void etsMerge(void) {
+
+	uint16_t length;
+	const adc_sample_t *frame = triggerGetFrame(ets.trigger, &length);
+	if (frame == NULL) {
+		return;
+	}
+
+	int32_t preCount = ets.trigger -> config.preCount;
+	int32_t steps = ets.steps;
+	int32_t level = ets.trigger -> config.level;
+	int32_t before = ADC_SAMPLE_VALUE(frame[preCount - 1]);
+	int32_t after = ADC_SAMPLE_VALUE(frame[preCount]);
+
+	// steps between sample before trigger and crossing, whole period when after sample sits on level
+	int32_t fraction = steps;
+	if (after != before) {
+		fraction = (level - before) * steps / (after - before);
+	}
+	if (fraction < 0) {
+		fraction = 0;
+	}
+	else if (fraction > steps) {
+		fraction = steps;
+	}
+
+	for (int32_t i = preCount - 1; i < length; i++) {
+		int32_t bin = (i - preCount + 1) * steps - fraction;
+		if (bin < 0 || (uint32_t)bin >= outputLength) {
+			continue;
+		}
+
+		ets.output[bin] = frame[i];
+		if (!(filledBits[bin / ETS_BITS] & (1UL << (bin % ETS_BITS)))) {
+			filledBits[bin / ETS_BITS] |= (1UL << (bin % ETS_BITS));
+			filledCount++;
+		}
+	}
+
+	passCount++;
+}
+
+/**
+ * Owns sampling timer on ACQUIRE_CORE and merges passes
+ *
+ * @param params unused
+ */
+static void etsMergeTask(void *params) {
+
+	// timer set here so its ISR is allocated on this core
+	timertick_t periodTicks;
+	freq_t freq = ets.freq;
+	etsTimer = HARD_TIMER_INVALID;
+
+	triggerArm(ets.trigger);
+	if (setHardTimerFine(&etsTimer, &freq, etsTimerISR, ets.priority, &periodTicks)) {
+		realFreq = freq;
+		stepTicks = periodTicks / ets.steps;
+		if (stepTicks == 0U) {
+			// steps finer than one timer tick
+			cancelHardTimer(etsTimer);
+			etsTimer = HARD_TIMER_INVALID;
+		}
+	}
+	else {
+		etsTimer = HARD_TIMER_INVALID;
+	}
+
+	if (etsTimer == HARD_TIMER_INVALID) {
+		etsRunning = false;
+	}
+	xSemaphoreGive(etsReady);
+
+	while (etsRunning && filledCount < outputLength) {
+		if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ETS_POLL_MS)) == 0U) {
+			continue;
+		}
+
+		etsMerge();
+
+		// next pass lands a fraction of a period later
+		hardTimerShiftPhase(etsTimer, stepTicks);
+		triggerArm(ets.trigger);
+	}
+
+	if (etsTimer != HARD_TIMER_INVALID) {
+		cancelHardTimer(etsTimer);
+		etsTimer = HARD_TIMER_INVALID;
+	}
+	if (filledCount >= outputLength) {
+		xSemaphoreGive(etsFilled);
+	}
+
+	xSemaphoreGive(etsExited);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Frees capture storage and semaphores
+ */
+static void etsFree(void) {
+
+	free(filledBits);
+	filledBits = NULL;
+
+	if (etsReady != NULL) {
+		vSemaphoreDelete(etsReady);
+		etsReady = NULL;
+	}
+	if (etsFilled != NULL) {
+		vSemaphoreDelete(etsFilled);
+		etsFilled = NULL;
+	}
+	if (etsExited != NULL) {
+		vSemaphoreDelete(etsExited);
+		etsExited = NULL;
+	}
+}
+
+bool etsStart(const struct etsConfig *config, freq_t *effectiveFreq) {
+
+	if (config == NULL || etsRunning || etsTask != NULL) {
+		return false;
+	}
+	if (config -> read == NULL || config -> trigger == NULL || config -> output == NULL || config -> steps == 0U) {
+		return false;
+	}
+	if (config -> trigger -> config.preCount == 0U) {
+		// sample before trigger is needed to place crossing
+		return false;
+	}
+	if (config -> trigger -> config.mode != TRIGGER_RISING && config -> trigger -> config.mode != TRIGGER_FALLING) {
+		return false;
+	}
+
+	ets = *config;
+	outputLength = (uint32_t)config -> trigger -> config.postCount * config -> steps;
+	filledCount = 0U;
+	passCount = 0U;
+
+	filledBits = calloc((outputLength + ETS_BITS - 1U) / ETS_BITS, sizeof(uint32_t));
+	etsReady = xSemaphoreCreateBinary();
+	etsFilled = xSemaphoreCreateBinary();
+	etsExited = xSemaphoreCreateBinary();
+	if (filledBits == NULL || etsReady == NULL || etsFilled == NULL || etsExited == NULL) {
+		etsFree();
+		return false;
+	}
+
+	etsRunning = true;
+	if (xTaskCreatePinnedToCore(etsMergeTask, "etsMerge", ETS_STACK, NULL, PIPELINE_PRIORITY, &etsTask, ACQUIRE_CORE) != pdPASS) {
+		etsRunning = false;
+		etsTask = NULL;
+		etsFree();
+		return false;
+	}
+
+	xSemaphoreTake(etsReady, portMAX_DELAY);
+	if (!etsRunning) {
+		xSemaphoreTake(etsExited, portMAX_DELAY);
+		etsTask = NULL;
+		etsFree();
+		return false;
+	}
+
+	if (effectiveFreq != NULL) {
+		*effectiveFreq = realFreq * ets.steps;
+	}
+
+	return true;
+}
+
+bool etsWait(uint32_t waitMS) {
+
+	if (etsFilled == NULL) {
+		return false;
+	}
+	if (xSemaphoreTake(etsFilled, pdMS_TO_TICKS(waitMS)) != pdTRUE) {
+		return false;
+	}
+
+	// keeps result for later waits
+	xSemaphoreGive(etsFilled);
+	return true;
+}
+
+bool etsStop(void) {
+
+	if (etsTask == NULL) {
+		return false;
+	}
+
+	// merge task polls for stop, it may already have exited once filled
+	etsRunning = false;
+	xSemaphoreTake(etsExited, portMAX_DELAY);
+
+	etsTask = NULL;
+	etsFree();
+
+	return true;
+}
+
+uint32_t etsProgress(uint32_t *filled, uint32_t *passes) {
+
+	if (filled != NULL) {
+		*filled = filledCount;
+	}
+	if (passes != NULL) {
+		*passes = passCount;
+	}
+
+	return outputLength;
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+	board_esp32_ets.h - equivalent time sampling for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_ETS_H
+#define BOARD_ESP32_ETS_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_trigger.h"
+
+/****************************
+ * Equivalent Time Types
+ *
+ * Repetitive signals are sampled over many
+ * triggered passes, each pass shifted by a
+ * fraction of the sample period, and the
+ * passes are merged into one waveform
+****************************/
+
+/**
+ * Takes one sample inside timer ISR
+ *
+ * @return raw sample, tagged with trigger channel
+ */
+typedef adc_sample_t (*ets_read_t)(void);
+
+struct etsConfig {
+	ets_read_t read; // ISR safe sample reader
+	trigger_t *trigger; // edge trigger, preCount >= 1 and history/frame storage set
+	freq_t freq; // real sample rate in Hz
+	uint16_t steps; // phase steps per sample period
+	adc_sample_t *output; // reconstructed waveform, postCount * steps samples
+	timer_priority_t priority; // priority of sampling ISR
+};
+
+/****************************
+ * Equivalent Time Functions
+****************************/
+
+/**
+ * Starts equivalent time capture
+ *
+ * @param config capture settings
+ * @param effectiveFreq pointer to store effective sample rate, can be NULL
+ *
+ * @note effective rate is real rate * steps
+ *
+ * @return if capture was started
+ */
+bool etsStart(const struct etsConfig *config, freq_t *effectiveFreq);
+
+/**
+ * Waits for every output sample to be filled
+ *
+ * @param waitMS max time to wait
+ *
+ * @note capture stops by itself once filled
+ *
+ * @return if output is filled
+ */
+bool etsWait(uint32_t waitMS);
+
+/**
+ * Stops equivalent time capture and frees its storage
+ *
+ * @note required before starting again, even once filled
+ *
+ * @return if capture was stopped
+ */
+bool etsStop(void);
+
+/**
+ * Gets reconstruction progress
+ *
+ * @param filled pointer to store output samples filled, can be NULL
+ * @param passes pointer to store triggered passes merged, can be NULL
+ *
+ * @return total output samples
+ */
+uint32_t etsProgress(uint32_t *filled, uint32_t *passes);
+
+#endif
+#endif
@@ -0,0 +1,172 @@
+/*
+	board_esp32_frame.c - binary serial frames for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "board_esp32_frame.h"
+
+#if defined(ESP32DEVC) || !defined(ESP_PLATFORM)
+
+#ifndef RUN_IN_RAM
+	#define RUN_IN_RAM(fn) // host builds have no IRAM
+#endif
+
+// decoder positions within frame
+enum FrameDecodeState {
+	DECODE_SYNC_0,
+	DECODE_SYNC_1,
+	DECODE_TYPE,
+	DECODE_SEQ,
+	DECODE_LENGTH_0,
+	DECODE_LENGTH_1,
+	DECODE_PAYLOAD,
+	DECODE_CRC_0,
+	DECODE_CRC_1,
+};
+
+// CRC16 CCITT remainders of each nibble
+static const uint16_t crcNibble[16] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+/**
+ * Adds one byte to CRC16
+ *
+ * @param crc running CRC
+ * @param byte byte to add
+ *
+ * @return updated CRC
+ */
+static inline uint16_t frameCRCByte(uint16_t crc, uint8_t byte) {
+	crc = (crc << 4) ^ crcNibble[(crc >> 12) ^ (byte >> 4)];
+	crc = (crc << 4) ^ crcNibble[(crc >> 12) ^ (byte & 0x0FU)];
+	return crc;
+}
+
+uint16_t RUN_IN_RAM(frameCRC16) frameCRC16(uint16_t crc, const void *data, uint16_t length) {
+
+	const uint8_t *bytes = data;
+
+	for (uint16_t i = 0U; i < length; i++) {
+		crc = frameCRCByte(crc, bytes[i]);
+	}
+
+	return crc;
+}
+
+uint16_t frameBuildHeader(uint8_t *header, uint8_t type, uint8_t seq, uint16_t length) {
+
+	header[0] = FRAME_SYNC_0;
+	header[1] = FRAME_SYNC_1;
+	header[2] = type;
+	header[3] = seq;
+	header[4] = (uint8_t)length;
+	header[5] = (uint8_t)(length >> 8);
+
+	return frameCRC16(FRAME_CRC_INIT, &header[2], FRAME_HEADER_SIZE - 2U);
+}
+
+bool frameDecoderInit(frame_decoder_t *decoder, uint8_t *payload, uint16_t capacity) {
+
+	if (decoder == NULL || payload == NULL || capacity == 0U) {
+		return false;
+	}
+
+	decoder -> payload = payload;
+	decoder -> capacity = capacity;
+	decoder -> state = DECODE_SYNC_0;
+	decoder -> nextSeq = 0U;
+	decoder -> frames = 0U;
+	decoder -> crcErrors = 0U;
+	decoder -> overflows = 0U;
+	decoder -> lost = 0U;
+
+	return true;
+}
+
+enum FrameDecodeResult frameDecodeByte(frame_decoder_t *decoder, uint8_t byte) {
+
+	switch (decoder -> state) {
+		case DECODE_SYNC_0:
+			if (byte == FRAME_SYNC_0) {
+				decoder -> state = DECODE_SYNC_1;
+			}
+			return FRAME_DECODE_BUSY;
+		case DECODE_SYNC_1:
+			if (byte == FRAME_SYNC_1) {
+				decoder -> crc = FRAME_CRC_INIT;
+				decoder -> state = DECODE_TYPE;
+			}
+			else if (byte != FRAME_SYNC_0) {
+				decoder -> state = DECODE_SYNC_0;
+			}
+			return FRAME_DECODE_BUSY;
+		case DECODE_TYPE:
+			decoder -> type = byte;
+			decoder -> crc = frameCRCByte(decoder -> crc, byte);
+			decoder -> state = DECODE_SEQ;
+			return FRAME_DECODE_BUSY;
+		case DECODE_SEQ:
+			decoder -> seq = byte;
+			decoder -> crc = frameCRCByte(decoder -> crc, byte);
+			decoder -> state = DECODE_LENGTH_0;
+			return FRAME_DECODE_BUSY;
+		case DECODE_LENGTH_0:
+			decoder -> length = byte;
+			decoder -> crc = frameCRCByte(decoder -> crc, byte);
+			decoder -> state = DECODE_LENGTH_1;
+			return FRAME_DECODE_BUSY;
+		case DECODE_LENGTH_1:
+			decoder -> length |= (uint16_t)byte << 8;
+			decoder -> crc = frameCRCByte(decoder -> crc, byte);
+			decoder -> received = 0U;
+			if (decoder -> length > decoder -> capacity) {
+				decoder -> overflows++;
+				decoder -> state = DECODE_SYNC_0;
+				return FRAME_DECODE_ERROR;
+			}
+			decoder -> state = (decoder -> length == 0U) ? DECODE_CRC_0 : DECODE_PAYLOAD;
+			return FRAME_DECODE_BUSY;
+		case DECODE_PAYLOAD:
+			decoder -> payload[decoder -> received++] = byte;
+			decoder -> crc = frameCRCByte(decoder -> crc, byte);
+			if (decoder -> received == decoder -> length) {
+				decoder -> state = DECODE_CRC_0;
+			}
+			return FRAME_DECODE_BUSY;
+		case DECODE_CRC_0:
+			decoder -> frameCRC = byte;
+			decoder -> state = DECODE_CRC_1;
+			return FRAME_DECODE_BUSY;
+		case DECODE_CRC_1:
+			decoder -> frameCRC |= (uint16_t)byte << 8;
+			decoder -> state = DECODE_SYNC_0;
+			if (decoder -> frameCRC != decoder -> crc) {
+				decoder -> crcErrors++;
+				return FRAME_DECODE_ERROR;
+			}
+			decoder -> lost += (uint8_t)(decoder -> seq - decoder -> nextSeq);
+			decoder -> nextSeq = decoder -> seq + 1U;
+			decoder -> frames++;
+			return FRAME_DECODE_READY;
+	}
+
+	decoder -> state = DECODE_SYNC_0;
+	return FRAME_DECODE_ERROR;
+}
+
+#endif
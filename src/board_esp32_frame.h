@@ -0,0 +1,227 @@
+/*
+	board_esp32_frame.h - binary serial frames for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_FRAME_H
+#define BOARD_ESP32_FRAME_H
+
+// host tools build frames without Core or IDF headers
+#ifdef ESP_PLATFORM
+	#include "../board.h"
+	#include "../../board_common.h"
+#endif
+
+#if defined(ESP32DEVC) || !defined(ESP_PLATFORM)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************
+ * Frame Format
+ *
+ * | 0xA5 | 0x5A | type | seq | length (LE16) | payload | CRC16 (LE16) |
+ *
+ * CRC16 is CCITT (0x1021, init 0xFFFF)
+ * over type, seq, length and payload
+****************************/
+
+#define FRAME_SYNC_0 0xA5U // first sync byte
+#define FRAME_SYNC_1 0x5AU // second sync byte
+#define FRAME_HEADER_SIZE 6U // bytes before payload
+#define FRAME_CRC_SIZE 2U // bytes after payload
+#define FRAME_CRC_INIT 0xFFFFU // CRC16 start value
+
+enum FrameType {
+	FRAME_SAMPLES = 1U, // raw ADC samples
+	FRAME_ENVELOPE = 2U, // decimated min/max points
+	FRAME_TRIGGER = 3U, // triggered frame
+	FRAME_STATS = 4U, // counters
+	FRAME_CONTROL = 5U, // link control
+};
+
+/**
+ * First payload byte of FRAME_CONTROL frames
+ *
+ * Baud negotiation:
+ * device: BAUD_PROPOSE baud (LE32) at current baud
+ * host: BAUD_ACCEPT baud (LE32), or baud 0 to refuse
+ * both switch, device: PATTERN bytes at new baud
+ * host: PATTERN_RESULT 1 if pattern matched, else 0
+ * either side returns to old baud after SERIAL_LINK_WAIT_MS of silence
+ */
+enum FrameControl {
+	FRAME_CONTROL_BAUD_PROPOSE = 1U, // device asks for baud
+	FRAME_CONTROL_BAUD_ACCEPT = 2U, // host agrees to baud
+	FRAME_CONTROL_PATTERN = 3U, // test pattern, checked by host
+	FRAME_CONTROL_PATTERN_RESULT = 4U, // host result of pattern check
+	FRAME_CONTROL_FILL = 5U, // filler for rate measurement, ignored by host
+};
+
+enum FrameDecodeResult {
+	FRAME_DECODE_BUSY, // byte used, frame not complete
+	FRAME_DECODE_READY, // frame complete, see decoder fields
+	FRAME_DECODE_ERROR, // frame dropped, bad CRC or too long
+};
+
+typedef struct frame_decoder_s {
+	uint8_t *payload; // payload storage
+	uint16_t capacity; // bytes of payload storage
+	uint16_t length; // payload bytes of current frame
+	uint16_t received; // payload and CRC bytes received
+	uint16_t crc; // running CRC
+	uint16_t frameCRC; // CRC sent with frame
+	uint8_t type; // type of current frame
+	uint8_t seq; // sequence of current frame
+	uint8_t state; // decoder position in frame
+	uint8_t nextSeq; // sequence expected next
+	uint32_t frames; // good frames decoded
+	uint32_t crcErrors; // frames dropped for CRC
+	uint32_t overflows; // frames dropped for length
+	uint32_t lost; // frames missing by sequence gap
+} frame_decoder_t;
+
+struct serialFrameStats {
+	uint32_t sent; // frames queued for TX
+	uint32_t dropped; // frames refused because TX buffer was full or another task was writing
+	uint32_t bytes; // bytes queued for TX
+};
+
+struct serialLinkStats {
+	uint32_t baud; // agreed baud
+	uint32_t bytesPerSec; // measured sustained rate
+	uint16_t attempts; // bauds tried
+	uint16_t fallbacks; // bauds that failed pattern check
+};
+
+/****************************
+ * Frame Functions
+ *
+ * Encoding and decoding do not touch hardware,
+ * so host tools can build them as well
+****************************/
+
+/**
+ * Updates CRC16 over bytes
+ *
+ * @param crc running CRC, FRAME_CRC_INIT to start
+ * @param data bytes to add
+ * @param length amount of bytes
+ *
+ * @return updated CRC
+ */
+uint16_t frameCRC16(uint16_t crc, const void *data, uint16_t length);
+
+/**
+ * Builds frame header
+ *
+ * @param header storage of FRAME_HEADER_SIZE bytes
+ * @param type frame type
+ * @param seq frame sequence
+ * @param length payload bytes
+ *
+ * @return CRC over header fields, continue it over payload
+ */
+uint16_t frameBuildHeader(uint8_t *header, uint8_t type, uint8_t seq, uint16_t length);
+
+/**
+ * Sets up decoder
+ *
+ * @param decoder decoder to set up
+ * @param payload storage for payload
+ * @param capacity bytes of payload storage
+ *
+ * @return if decoder was set up
+ */
+bool frameDecoderInit(frame_decoder_t *decoder, uint8_t *payload, uint16_t capacity);
+
+/**
+ * Feeds one received byte to decoder
+ *
+ * @param decoder decoder to feed
+ * @param byte received byte
+ *
+ * @note resyncs on sync bytes after errors
+ *
+ * @return decode state after byte
+ */
+enum FrameDecodeResult frameDecodeByte(frame_decoder_t *decoder, uint8_t byte);
+
+/**
+ * Installs UART driver for binary frames
+ *
+ * @param baud baud rate
+ *
+ * @note text printed afterwards shares the same link
+ *
+ * @return if driver was installed
+ */
+bool serialFrameBegin(uint32_t baud);
+
+/**
+ * Queues frame for TX without blocking
+ *
+ * @param type frame type
+ * @param payload payload bytes, copied into the frame
+ * @param length payload bytes (max FRAME_MAX_PAYLOAD)
+ *
+ * @note safe from any task, whole frame enters TX buffer in one write
+ * @note never waits, a frame sent while another task writes is dropped
+ *
+ * @return if frame was queued, false if TX buffer is full or busy
+ */
+bool serialFrameSend(uint8_t type, const void *payload, uint16_t length);
+
+/**
+ * Gets TX counters
+ *
+ * @param stats pointer to store counters
+ */
+void serialFrameGetStats(struct serialFrameStats *stats);
+
+/**
+ * Agrees highest working baud with host tool
+ *
+ * @param baud starting baud, kept if host does not reply
+ * @param maxBaud highest baud to try
+ *
+ * @note blocks for up to SERIAL_LINK_WAIT_MS per baud tried
+ * @note measures sustained rate at the agreed baud
+ *
+ * @return agreed baud
+ */
+uint32_t serialLinkNegotiate(uint32_t baud, uint32_t maxBaud);
+
+/**
+ * Gets sustained link rate
+ *
+ * @note measured by serialLinkNegotiate, else estimated from baud
+ * @note acquisition should keep sample bytes plus frame overhead below this
+ *
+ * @return bytes per second link can carry
+ */
+uint32_t serialLinkGetRate(void);
+
+/**
+ * Gets negotiation results
+ *
+ * @param stats pointer to store results
+ */
+void serialLinkGetStats(struct serialLinkStats *stats);
+
+#endif
+#endif
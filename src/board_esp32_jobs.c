@@ -0,0 +1,150 @@
+/*
+	board_esp32_jobs.c - shared timer jobs for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_jobs.h"
+#include "board_esp32_timer.h"
+
+#include <esp_attr.h>
+
+#if TIMER_JOB_MAX > 32
+	#error "TIMER_JOB_MAX must fit in 32 bit job mask"
+#endif
+
+typedef struct timer_job_entry_s {
+	hard_timer_function_ptr_t function; // job function
+	void *context; // user context of job
+	uint32_t divider; // alarms between runs
+	uint32_t countdown; // alarms left until next run
+} timer_job_entry_t;
+
+// kept in internal RAM so dispatch never waits on flash cache
+static DRAM_ATTR timer_job_entry_t jobs[TIMER_JOB_MAX];
+static DRAM_ATTR uint32_t jobMask = 0U; // bit set for each job in table
+static DRAM_ATTR uint32_t dispatchCount = 0U; // bumped on ISR entry and exit, odd while dispatching
+
+static hard_timer_t jobTimer = HARD_TIMER_INVALID;
+
+/**
+ * Runs every job that is due
+ *
+ * @param emptyParams unused
+ *
+ * @return if any job woke a higher priority task
+ */
+static hard_timer_return_t RUN_IN_RAM(timerJobsISR) timerJobsISR(hard_timer_param_t emptyParams) {
+
+	bool woken = false;
+
+	// marked inside before mask is read, so removes wait for this pass
+	__atomic_add_fetch(&dispatchCount, 1U, __ATOMIC_SEQ_CST);
+	uint32_t mask = __atomic_load_n(&jobMask, __ATOMIC_SEQ_CST);
+
+	while (mask != 0U) {
+		uint8_t i = __builtin_ctz(mask);
+		mask &= mask - 1U;
+
+		if (--jobs[i].countdown == 0U) {
+			jobs[i].countdown = jobs[i].divider;
+			woken |= jobs[i].function(jobs[i].context);
+		}
+	}
+
+	__atomic_add_fetch(&dispatchCount, 1U, __ATOMIC_RELEASE);
+
+	return woken;
+}
+
+bool timerJobsStart(hard_timer_t *timer, freq_t *freq, timer_priority_t priority) {
+
+	if (jobTimer != HARD_TIMER_INVALID || timer == NULL) {
+		return false;
+	}
+
+	if (!setHardTimerRaw(timer, freq, timerJobsISR, priority, NULL)) {
+		return false;
+	}
+
+	jobTimer = *timer;
+	return true;
+}
+
+bool timerJobsStop(void) {
+
+	if (jobTimer == HARD_TIMER_INVALID) {
+		return false;
+	}
+
+	cancelHardTimer(jobTimer);
+	jobTimer = HARD_TIMER_INVALID;
+
+	return true;
+}
+
+timer_job_t timerJobAdd(hard_timer_function_ptr_t function, void *context, uint32_t divider) {
+
+	if (function == NULL || divider == 0U) {
+		return TIMER_JOB_INVALID;
+	}
+
+	uint32_t mask = __atomic_load_n(&jobMask, __ATOMIC_ACQUIRE);
+
+	for (uint8_t i = 0U; i < TIMER_JOB_MAX; i++) {
+		if (mask & (1UL << i)) {
+			continue;
+		}
+
+		jobs[i].function = function;
+		jobs[i].context = context;
+		jobs[i].divider = divider;
+		jobs[i].countdown = divider;
+
+		// entry is complete before ISR can see it
+		__atomic_fetch_or(&jobMask, 1UL << i, __ATOMIC_RELEASE);
+		return i;
+	}
+
+	return TIMER_JOB_INVALID;
+}
+
+bool timerJobRemove(timer_job_t job) {
+
+	if (job >= TIMER_JOB_MAX) {
+		return false;
+	}
+
+	uint32_t previous = __atomic_fetch_and(&jobMask, ~(1UL << job), __ATOMIC_SEQ_CST);
+
+	// pass that read mask before the clear may still run job, later passes skip it
+	uint32_t count = __atomic_load_n(&dispatchCount, __ATOMIC_SEQ_CST);
+	if (count & 1U) {
+		while (__atomic_load_n(&dispatchCount, __ATOMIC_ACQUIRE) == count) {
+		}
+	}
+
+	return !!(previous & (1UL << job));
+}
+
+uint8_t timerJobCount(void) {
+	return __builtin_popcount(__atomic_load_n(&jobMask, __ATOMIC_ACQUIRE));
+}
+
+#endif
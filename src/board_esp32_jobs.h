@@ -0,0 +1,102 @@
+/*
+	board_esp32_jobs.h - shared timer jobs for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_JOBS_H
+#define BOARD_ESP32_JOBS_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "../../hard_timer.h"
+
+/****************************
+ * Timer Job Types
+ *
+ * Many sampling jobs share one hardware timer,
+ * each running every 'divider' alarms of it
+****************************/
+
+#define TIMER_JOB_INVALID UINT8_MAX // job ID when no job was added
+
+typedef uint8_t timer_job_t; // job ID
+
+/****************************
+ * Timer Job Functions
+****************************/
+
+/**
+ * Starts hardware timer that runs jobs
+ *
+ * @param timer pointer to timer ID
+ * @param freq pointer to base frequency in Hz
+ * @param priority priority of jobs
+ *
+ * @note freq value is changed to actual freq
+ * @note jobs added before starting run from first alarm
+ *
+ * @return if timer was started
+ */
+bool timerJobsStart(hard_timer_t *timer, freq_t *freq, timer_priority_t priority);
+
+/**
+ * Stops hardware timer that runs jobs
+ *
+ * @note jobs stay in table for next start
+ *
+ * @return if timer was stopped
+ */
+bool timerJobsStop(void);
+
+/**
+ * Adds job to shared timer
+ *
+ * @param function function to run, gets context as its parameter
+ * @param context user context passed to function
+ * @param divider alarms of base timer between runs
+ *
+ * @note job runs at base freq / divider
+ * @note add and remove jobs from one task only
+ *
+ * @return job ID, TIMER_JOB_INVALID if table is full
+ */
+timer_job_t timerJobAdd(hard_timer_function_ptr_t function, void *context, uint32_t divider);
+
+/**
+ * Removes job from shared timer
+ *
+ * @param job job to remove
+ *
+ * @note waits for an alarm already being handled to finish, job
+ * and context are never used once remove returns, so its slot
+ * can be reused right away
+ * @warning never call from a job, it would wait on itself
+ *
+ * @return if job was removed
+ */
+bool timerJobRemove(timer_job_t job);
+
+/**
+ * Gets amount of jobs in table
+ *
+ * @return jobs added
+ */
+uint8_t timerJobCount(void);
+
+#endif
+#endif
@@ -23,28 +23,360 @@
 #include "../../board_common.h"
 #include "../../nvm/generic_nvm.h"
 #include "../../comm/hard_serial/hard_serial.h"
+#include "board_esp32_nvm.h"
+#include "board_esp32_frame.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
 #include <esp_system.h>
 #include <nvs_flash.h>
 #include <nvs.h>
+#include <esp_timer.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define CHAR_KEY_SIZE NVM_MAX_SIZE_BYTES + 1U
 #define OSC_NAME_SPACE "Osc"
 
+#if NVM_MAX_SIZE_BYTES > 4
+	#error "NVM keys wider than 4 bytes don't fit printable key names"
+#endif
+
+/**
+ * Printable key names
+ *
+ * Keys are named by KEY_WIDTH upper case hex digits,
+ * so every key has a distinct name of the same length,
+ * longer than any name made by 'keyToChar'
+ *
+ * Names of keys below KEY_TABLE_SIZE are built at
+ * compile time, larger keys are built on use
+ */
+
+#define KEY_WIDTH (NVM_MAX_SIZE_BYTES * 2U) // hex digits of key name
+#define KEY_NAME_SIZE 9U // storage of key name, 8 digits and end of char
+#define KEY_TABLE_SIZE 256U // keys with constant names
+
+#define KEY_HEX(nibble) ((nibble) < 10U ? '0' + (nibble) : 'A' + (nibble) - 10U)
+#define KEY_CHAR(key, i) ((i) < KEY_WIDTH ? \
+	KEY_HEX(((uint32_t)(key) >> (4U * ((KEY_WIDTH - 1U - (i)) & 7U))) & 0x0FU) : END_OF_CHAR) // digit i of key name
+
+#define KEY_ROW(key) { \
+	KEY_CHAR(key, 0U), KEY_CHAR(key, 1U), KEY_CHAR(key, 2U), KEY_CHAR(key, 3U), \
+	KEY_CHAR(key, 4U), KEY_CHAR(key, 5U), KEY_CHAR(key, 6U), KEY_CHAR(key, 7U), END_OF_CHAR }
+#define KEY_ROWS_4(key) KEY_ROW(key), KEY_ROW((key) + 1U), KEY_ROW((key) + 2U), KEY_ROW((key) + 3U)
+#define KEY_ROWS_16(key) KEY_ROWS_4(key), KEY_ROWS_4((key) + 4U), KEY_ROWS_4((key) + 8U), KEY_ROWS_4((key) + 12U)
+#define KEY_ROWS_64(key) KEY_ROWS_16(key), KEY_ROWS_16((key) + 16U), KEY_ROWS_16((key) + 32U), KEY_ROWS_16((key) + 48U)
+#define KEY_ROWS_256(key) KEY_ROWS_64(key), KEY_ROWS_64((key) + 64U), KEY_ROWS_64((key) + 128U), KEY_ROWS_64((key) + 192U)
+
+static const char keyNames[KEY_TABLE_SIZE][KEY_NAME_SIZE] = { KEY_ROWS_256(0U) };
+
 bool nvmBegan = false;
-bool threadLock = false;
 nvs_handle_t handler;
 
+#define ENTRY_BYTES 32U // bytes of each NVS entry
+
+static struct nvmTelemetry telemetry; // counters since boot or reset
+static uint32_t entriesWritten = 0U; // NVS entries written over life of flash
+static portMUX_TYPE telemetrySpin = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * Records one NVS operation
+ * 
+ * @param op stats of operation type
+ * @param startUS time operation started
+ * @param err NVS result of operation
+ * @param entries NVS entries written by operation
+ */
+static void nvmRecord(struct nvmOpStats *op, int64_t startUS, esp_err_t err, uint32_t entries) {
+
+	uint32_t us = (uint32_t)(esp_timer_get_time() - startUS);
+	uint8_t bucket = (us == 0U) ? 0U : (32U - __builtin_clz(us));
+	if (bucket >= NVM_LATENCY_BUCKETS) {
+		bucket = NVM_LATENCY_BUCKETS - 1U;
+	}
+
+	taskENTER_CRITICAL(&telemetrySpin);
+	op -> count++;
+	if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+		op -> failures++;
+	}
+	if (us > op -> maxUS) {
+		op -> maxUS = us;
+	}
+	op -> totalUS += us;
+	op -> buckets[bucket]++;
+	if (err == ESP_OK) {
+		entriesWritten += entries;
+	}
+	taskEXIT_CRITICAL(&telemetrySpin);
+}
+
+/**
+ * Counts event without timing
+ * 
+ * @param counter counter to increase
+ */
+static inline void nvmCount(uint32_t *counter) {
+	taskENTER_CRITICAL(&telemetrySpin);
+	(*counter)++;
+	taskEXIT_CRITICAL(&telemetrySpin);
+}
+
+/**
+ * Gets NVS entries a string or blob takes
+ * 
+ * @param length bytes of data
+ * 
+ * @return entries, one header plus data entries
+ */
+static inline uint32_t nvmDataEntries(size_t length) {
+	return 1U + (length + ENTRY_BYTES - 1U) / ENTRY_BYTES;
+}
+
+/**
+ * Commits pending NVS writes
+ * 
+ * @return NVS result of commit
+ */
+static esp_err_t nvmCommit(void) {
+
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_commit(handler);
+	nvmRecord(&telemetry.commits, start, err, 0U);
+
+	return err;
+}
+
+/**
+ * Reader/writer lock
+ *
+ * Writers hold a recursive mutex and wait for readers inside
+ * to leave, readers pass through the mutex to enter, so a
+ * waiting writer holds off new readers
+ */
+
+static portMUX_TYPE lockCreateSpin = portMUX_INITIALIZER_UNLOCKED;
+static StaticSemaphore_t writeMutexBuffer;
+static StaticSemaphore_t readersDoneBuffer;
+static SemaphoreHandle_t writeMutex = NULL; // held by writer, passed through by readers
+static SemaphoreHandle_t readersDone = NULL; // given when last reader leaves
+static uint32_t readers = 0U; // readers inside lock
+static __thread bool lockBusy = false; // last lock of task timed out
+
+/**
+ * Creates lock on first use
+ */
+static void nvmLockCreate(void) {
+
+	if (__atomic_load_n(&writeMutex, __ATOMIC_ACQUIRE) != NULL) {
+		return;
+	}
+
+	taskENTER_CRITICAL(&lockCreateSpin);
+	if (writeMutex == NULL) {
+		readersDone = xSemaphoreCreateBinaryStatic(&readersDoneBuffer);
+		__atomic_store_n(&writeMutex, xSemaphoreCreateRecursiveMutexStatic(&writeMutexBuffer), __ATOMIC_RELEASE);
+	}
+	taskEXIT_CRITICAL(&lockCreateSpin);
+}
+
+/**
+ * Takes lock for writing
+ * 
+ * @param waitMS max time to wait for other holders
+ * 
+ * @note recursive for the holding task
+ * 
+ * @return if lock was taken, sets 'lockBusy' when not
+ */
+static bool nvmLockWrite(uint32_t waitMS) {
+
+	nvmLockCreate();
+
+	TickType_t start = xTaskGetTickCount();
+	TickType_t wait = pdMS_TO_TICKS(waitMS);
+
+	if (xSemaphoreTakeRecursive(writeMutex, wait) != pdTRUE) {
+		lockBusy = true;
+		nvmCount(&telemetry.busy);
+		return false;
+	}
+
+	// readers already inside finish, new ones wait on mutex
+	while (__atomic_load_n(&readers, __ATOMIC_ACQUIRE) != 0U) {
+		TickType_t waited = xTaskGetTickCount() - start;
+		if (waited >= wait) {
+			xSemaphoreGiveRecursive(writeMutex);
+			lockBusy = true;
+			nvmCount(&telemetry.busy);
+			return false;
+		}
+		xSemaphoreTake(readersDone, wait - waited);
+	}
+
+	lockBusy = false;
+	return true;
+}
+
+/**
+ * Releases lock taken for writing
+ */
+static void nvmUnlockWrite(void) {
+	xSemaphoreGiveRecursive(writeMutex);
+}
+
+/**
+ * Takes lock for reading, shared with other readers
+ * 
+ * @param waitMS max time to wait for writer
+ * 
+ * @return if lock was taken, sets 'lockBusy' when not
+ */
+static bool nvmLockRead(uint32_t waitMS) {
+
+	nvmLockCreate();
+
+	if (xSemaphoreTakeRecursive(writeMutex, pdMS_TO_TICKS(waitMS)) != pdTRUE) {
+		lockBusy = true;
+		nvmCount(&telemetry.busy);
+		return false;
+	}
+	__atomic_add_fetch(&readers, 1U, __ATOMIC_ACQ_REL);
+	xSemaphoreGiveRecursive(writeMutex);
+
+	lockBusy = false;
+	return true;
+}
+
+/**
+ * Releases lock taken for reading
+ */
+static void nvmUnlockRead(void) {
+	if (__atomic_sub_fetch(&readers, 1U, __ATOMIC_ACQ_REL) == 0U) {
+		xSemaphoreGive(readersDone);
+	}
+}
+
 #define THREAD_LOCK() \
-	if (threadLock) { \
+	if (!nvmLockWrite(NVM_LOCK_WAIT_MS)) { \
 		return false; \
-	} \
-	threadLock = true;
+	}
+
+#define THREAD_UNLOCK() nvmUnlockWrite();
+
+#define READ_LOCK() \
+	if (!nvmLockRead(NVM_LOCK_WAIT_MS)) { \
+		return false; \
+	}
 
-#define THREAD_UNLOCK() threadLock = false;
+#define READ_UNLOCK() nvmUnlockRead();
+
+#if (NVM_CACHE_SIZE & (NVM_CACHE_SIZE - 1)) != 0
+	#error "NVM_CACHE_SIZE must be a power of 2"
+#endif
+
+#define CACHE_MASK (NVM_CACHE_SIZE - 1U) // slot of hash within cache
+#define CACHE_HASH 2654435761UL // Knuth multiplicative hash
+
+// NVS type of cached value
+enum NVMCacheType {
+	NVM_TYPE_U8,
+	NVM_TYPE_I8,
+	NVM_TYPE_U16,
+	NVM_TYPE_I16,
+	NVM_TYPE_U32,
+	NVM_TYPE_I32,
+	NVM_TYPE_U64,
+	NVM_TYPE_I64,
+	NVM_TYPE_NONE = UINT8_MAX, // value not known yet
+};
+
+typedef struct nvm_cache_entry_s {
+	nvm_size_t key; // NVM key
+	uint64_t value; // value, sign extended for signed types
+	uint8_t type; // NVS type of value
+	bool valid; // slot holds key
+	bool dirty; // value not yet written to flash
+	bool journaled; // value lives under its own key, newer than config record
+} nvm_cache_entry_t;
+
+static nvm_cache_entry_t cache[NVM_CACHE_SIZE];
+static uint16_t cacheDirty = 0U; // dirty entries in cache
+static uint16_t journalCount = 0U; // journaled entries in cache
+static bool journalListed = true; // journal in flash names every journaled entry with its type
+static uint32_t keysChanged = 0U; // values, strings and blobs changed since boot
+static esp_timer_handle_t commitTimer = NULL; // commits dirty entries after delay
+
+#define NVM_PAGE_ENTRIES 126U // 32 byte entries in each 4kB NVS page
+
+#define BATCH_OWNED() (batchOwner != NULL && batchOwner == xTaskGetCurrentTaskHandle())
+
+typedef struct nvm_batch_entry_s {
+	nvm_size_t key; // NVM key
+	uint64_t value; // value, sign extended for signed types
+	uint8_t type; // NVS type of value
+} nvm_batch_entry_t;
+
+static nvm_batch_entry_t batch[NVM_BATCH_SIZE];
+static uint16_t batchCount = 0U; // writes staged in batch
+static TaskHandle_t batchOwner = NULL; // task holding THREAD_LOCK for batch
+
+#define CONFIG_KEY "oscConfig" // NVS key of config record, longer than any integer key
+#define CONFIG_VERSION 2U // layout of config record
+#define CONFIG_V1_HEADER_SIZE 8U // bytes before entries in version 1
+#define JOURNAL_KEY "oscJournal" // NVS key listing values stored under their own keys
+
+/**
+ * Config record versions
+ *
+ * 0: every value under its own integer key, moved into
+ *    the record once read
+ * 1: values packed in one blob, read at nvmInit
+ * 2: adds lifetime NVS entries written, covered by CRC
+ *
+ * Commits write changed values under their own keys and list
+ * them in a journal, the record is rewritten with every value
+ * once the journal would pass NVM_JOURNAL_SIZE, then values
+ * under their own keys are erased
+ */
+
+typedef struct __attribute__((packed)) nvm_config_entry_s {
+	nvm_size_t key; // NVM key
+	uint64_t value; // value, sign extended for signed types
+	uint8_t type; // NVS type of value
+} nvm_config_entry_t;
+
+typedef struct __attribute__((packed)) nvm_config_record_s {
+	uint16_t version; // CONFIG_VERSION when written
+	uint16_t count; // entries in record
+	uint16_t entrySize; // bytes of each entry
+	uint16_t crc; // CRC16 over entries then entriesWritten
+	uint32_t entriesWritten; // NVS entries written over life of flash
+	nvm_config_entry_t entries[NVM_CACHE_SIZE]; // stored values
+} nvm_config_record_t;
+
+typedef struct __attribute__((packed)) nvm_journal_entry_s {
+	nvm_size_t key; // NVM key
+	uint8_t type; // NVS type of value
+} nvm_journal_entry_t;
+
+#define CONFIG_HEADER_SIZE offsetof(nvm_config_record_t, entries) // bytes before entries
+
+static nvm_config_record_t configRecord; // staging for config blob reads and writes
+static nvm_journal_entry_t journal[NVM_JOURNAL_SIZE]; // staging for journal reads and writes
+static bool configDamaged = false; // config record found but unreadable
+static bool configStale = false; // config record is rewritten with next commit
+
+static bool nvmCacheCommit(void);
+static bool nvmAsyncDrain(void);
+static void nvmCacheClear(void);
+static void nvmConfigLoad(void);
+static void nvmScheduleCommit(void);
 
 enum NVMStartCode nvmInit(nvm_size_t setNVMSize) {
 
@@ -69,6 +401,7 @@ enum NVMStartCode nvmInit(nvm_size_t setNVMSize) {
 	}
 
 	nvmBegan = true;
+	nvmConfigLoad();
 	THREAD_UNLOCK();
 
 	return NVM_OK;
@@ -99,6 +432,13 @@ bool nvmStop(void) {
 		return false;
 	}
 
+	// cached writes land before flash closes
+	nvmCacheCommit();
+	if (commitTimer != NULL) {
+		esp_timer_stop(commitTimer);
+	}
+	nvmCacheClear();
+
 	nvs_flash_deinit();
 	nvmBegan = false;
 
@@ -118,13 +458,21 @@ bool nvmClear(void) {
 	if (nvs_flash_erase() != ESP_OK) {
 		return false;
 	}
+	nvmCacheClear();
 
 	return true;
 }
 
-enum NVMDefaultCode nvmSetDefaults(void) {
+/**
+ * Erases NVM and writes every default
+ * 
+ * @return result of setting defaults
+ */
+static enum NVMDefaultCode nvmSetDefaultsFull(void) {
 
-	THREAD_LOCK();
+	if (!nvmLockWrite(NVM_LOCK_WAIT_MS)) {
+		return NVM_DEFAULT_BUSY;
+	}
 
 	// ensures NVM_SIZE isn't too big for microcontroller
 	nvm_size_t nvmMaxValue;
@@ -166,60 +514,1115 @@ enum NVMDefaultCode nvmSetDefaults(void) {
 		return code;
 	}
 
-	code = nvmSetEnvDefaults();
+	code = nvmSetEnvDefaults();
+
+	//writes platform values
+	return code;
+}
+
+enum NVMDefaultCode nvmSetDefaultsIncremental(struct nvmDefaultStats *stats) {
+
+	int64_t start = esp_timer_get_time();
+	struct nvmDefaultStats result = {0};
+
+	// ensures NVM_SIZE isn't too big for microcontroller
+	nvm_size_t nvmMaxValue;
+	if (!nvmMaxSize(&nvmMaxValue)) {
+		return NVM_DEFAULT_FAIL_MAX_SIZE;
+	}
+	if (NVM_SIZE > nvmMaxValue) {
+		return NVM_DEFAULT_SIZE_TOO_BIG;
+	}
+
+	// queued async writes land first, they need the lock
+	bool drained = nvmAsyncDrain();
+	if (!drained && nvmWasBusy()) {
+		return NVM_DEFAULT_BUSY;
+	}
+
+	// defaults hold NVM alone, so every change counted is theirs
+	if (!nvmLockWrite(NVM_LOCK_WAIT_MS)) {
+		return NVM_DEFAULT_BUSY;
+	}
+
+	// earlier writes land first so only defaults are counted
+	enum NVMDefaultCode code = NVM_DEFAULT_OK;
+	result.erased = !drained || configDamaged || !nvmCacheCommit();
+	uint32_t changedBefore = keysChanged;
+
+	if (!result.erased) {
+		// unchanged values are skipped by cache and compares
+		code = nvmSetCritDefaults(nvmMaxValue);
+		if (code == NVM_DEFAULT_OK) {
+			code = nvmSetEnvDefaults();
+		}
+		result.erased = code != NVM_DEFAULT_OK || !nvmCacheCommit();
+	}
+
+	if (result.erased) {
+		// erased flash takes every default again
+		changedBefore = keysChanged;
+		code = nvmSetDefaultsFull();
+		if (code == NVM_DEFAULT_OK && !nvmCacheCommit()) {
+			code = NVM_DEFAULT_FAIL_INIT;
+		}
+	}
+
+	result.keys = (uint16_t)(keysChanged - changedBefore);
+	nvmUnlockWrite();
+
+	result.timeUS = (uint32_t)(esp_timer_get_time() - start);
+	if (stats != NULL) {
+		*stats = result;
+	}
+
+	return code;
+}
+
+enum NVMDefaultCode nvmSetDefaults(void) {
+#ifdef NVM_INCREMENTAL_DEFAULTS
+	return nvmSetDefaultsIncremental(NULL);
+#else
+	return nvmSetDefaultsFull();
+#endif
+}
+
+/**
+ * Converts integer key to char array key
+ * 
+ * @param key integer key
+ * @param keyStr char array to store key
+ * 
+ * @note legacy raw byte names, used only to find values
+ * stored before printable key names
+ */
+void keyToChar(nvm_size_t key, char* keyStr) {
+	for (uint8_t i = 0U; i < NVM_MAX_SIZE_BYTES; i++) {
+		uint8_t subKey = (key >> (8*i)) & (ONE_BYTE);
+		keyStr[i] = subKey;
+	}
+	keyStr[NVM_MAX_SIZE_BYTES] = END_OF_CHAR;
+}
+
+/**
+ * Gets legacy name of key, if it names that key alone
+ * 
+ * @param key integer key
+ * @param keyStr char array of CHAR_KEY_SIZE to store name
+ * 
+ * @note a zero byte cuts the name short, so the name decodes
+ * to another key, whose value it may hold
+ * 
+ * @return if name decodes back to key
+ */
+static bool nvmLegacyName(nvm_size_t key, char *keyStr) {
+
+	keyToChar(key, keyStr);
+
+	nvm_size_t decoded = 0U;
+	for (uint8_t i = 0U; keyStr[i] != END_OF_CHAR; i++) {
+		decoded |= (nvm_size_t)(uint8_t)keyStr[i] << (8U * i);
+	}
+
+	return keyStr[0] != END_OF_CHAR && decoded == key;
+}
+
+/**
+ * Gets printable name of key
+ * 
+ * @param key integer key
+ * @param keyStr storage of KEY_NAME_SIZE chars, used when key has no constant name
+ * 
+ * @return name of key
+ */
+static const char* nvmKeyName(nvm_size_t key, char *keyStr) {
+
+	if (key < KEY_TABLE_SIZE) {
+		return keyNames[key];
+	}
+
+	for (uint8_t i = 0U; i < KEY_WIDTH; i++) {
+		keyStr[i] = KEY_CHAR(key, i);
+	}
+	keyStr[KEY_WIDTH] = END_OF_CHAR;
+
+	return keyStr;
+}
+
+/**
+ * Writes value to NVS without commit
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value value to write
+ * 
+ * @return if write was successful
+ */
+static bool nvmSetRaw(nvm_size_t key, uint8_t type, uint64_t value) {
+
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *keyStr = nvmKeyName(key, keyBuffer);
+
+	int64_t start = esp_timer_get_time();
+	esp_err_t err;
+	switch (type) {
+		case NVM_TYPE_U8: err = nvs_set_u8(handler, keyStr, (uint8_t)value); break;
+		case NVM_TYPE_I8: err = nvs_set_i8(handler, keyStr, (int8_t)value); break;
+		case NVM_TYPE_U16: err = nvs_set_u16(handler, keyStr, (uint16_t)value); break;
+		case NVM_TYPE_I16: err = nvs_set_i16(handler, keyStr, (int16_t)value); break;
+		case NVM_TYPE_U32: err = nvs_set_u32(handler, keyStr, (uint32_t)value); break;
+		case NVM_TYPE_I32: err = nvs_set_i32(handler, keyStr, (int32_t)value); break;
+		case NVM_TYPE_U64: err = nvs_set_u64(handler, keyStr, value); break;
+		case NVM_TYPE_I64: err = nvs_set_i64(handler, keyStr, (int64_t)value); break;
+		default: return false;
+	}
+	nvmRecord(&telemetry.sets, start, err, 1U);
+
+	return err == ESP_OK;
+}
+
+/**
+ * Reads value from NVS by key name
+ * 
+ * @param keyStr name of key
+ * @param type NVS type of value
+ * @param value pointer to store value, sign extended for signed types
+ * 
+ * @return NVS result of read
+ */
+static esp_err_t nvmGetNamed(const char *keyStr, uint8_t type, uint64_t *value) {
+
+	int64_t start = esp_timer_get_time();
+	esp_err_t err;
+	switch (type) {
+		case NVM_TYPE_U8: { uint8_t v; err = nvs_get_u8(handler, keyStr, &v); *value = v; break; }
+		case NVM_TYPE_I8: { int8_t v; err = nvs_get_i8(handler, keyStr, &v); *value = (uint64_t)(int64_t)v; break; }
+		case NVM_TYPE_U16: { uint16_t v; err = nvs_get_u16(handler, keyStr, &v); *value = v; break; }
+		case NVM_TYPE_I16: { int16_t v; err = nvs_get_i16(handler, keyStr, &v); *value = (uint64_t)(int64_t)v; break; }
+		case NVM_TYPE_U32: { uint32_t v; err = nvs_get_u32(handler, keyStr, &v); *value = v; break; }
+		case NVM_TYPE_I32: { int32_t v; err = nvs_get_i32(handler, keyStr, &v); *value = (uint64_t)(int64_t)v; break; }
+		case NVM_TYPE_U64: err = nvs_get_u64(handler, keyStr, value); break;
+		case NVM_TYPE_I64: { int64_t v; err = nvs_get_i64(handler, keyStr, &v); *value = (uint64_t)v; break; }
+		default: return ESP_ERR_INVALID_ARG;
+	}
+	nvmRecord(&telemetry.gets, start, err, 0U);
+
+	return err;
+}
+
+/**
+ * Reads value from NVS
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value pointer to store value, sign extended for signed types
+ * 
+ * @note values under legacy names are read in place, the
+ * cache moves them into the config record, which erases them
+ * 
+ * @return if read was successful
+ */
+static bool nvmGetRaw(nvm_size_t key, uint8_t type, uint64_t *value) {
+
+	char keyBuffer[KEY_NAME_SIZE];
+	esp_err_t err = nvmGetNamed(nvmKeyName(key, keyBuffer), type, value);
+	if (err != ESP_ERR_NVS_NOT_FOUND) {
+		return err == ESP_OK;
+	}
+
+	// shared legacy names may hold another key's value
+	char legacyStr[CHAR_KEY_SIZE];
+	if (!nvmLegacyName(key, legacyStr)) {
+		return false;
+	}
+
+	return nvmGetNamed(legacyStr, type, value) == ESP_OK;
+}
+
+/**
+ * Tells if string or blob is stored under printable name already
+ * 
+ * @param keyStr printable name
+ * @param value bytes to compare
+ * @param length bytes of value, strings count their end of char
+ * @param isString if value is a string
+ * 
+ * @note caller holds THREAD_LOCK
+ * 
+ * @return if stored bytes match value
+ */
+static bool nvmDataStored(const char *keyStr, const void *value, size_t length, bool isString) {
+
+	size_t stored = 0U;
+	esp_err_t err = isString ? nvs_get_str(handler, keyStr, NULL, &stored) : nvs_get_blob(handler, keyStr, NULL, &stored);
+	if (err != ESP_OK || stored != length) {
+		return false;
+	}
+
+	void *bytes = malloc(length);
+	if (bytes == NULL) {
+		return false;
+	}
+
+	int64_t start = esp_timer_get_time();
+	err = isString ? nvs_get_str(handler, keyStr, bytes, &stored) : nvs_get_blob(handler, keyStr, bytes, &stored);
+	nvmRecord(&telemetry.gets, start, err, 0U);
+	bool same = err == ESP_OK && memcmp(bytes, value, length) == 0;
+	free(bytes);
+
+	return same;
+}
+
+/**
+ * Copies string or blob found under legacy name to printable name
+ * 
+ * @param key integer key
+ * @param value bytes read
+ * @param length bytes of value, strings count their end of char
+ * @param isString if value is a string
+ * 
+ * @note takes THREAD_LOCK, caller holds no lock
+ * @note legacy name is kept, erased once key is written
+ */
+static void nvmMigrateData(nvm_size_t key, const void *value, size_t length, bool isString) {
+
+	if (!nvmLockWrite(NVM_LOCK_WAIT_MS)) {
+		// stays under legacy name, copied by a later read
+		return;
+	}
+
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *keyStr = nvmKeyName(key, keyBuffer);
+
+	// values written since the read are newer
+	size_t stored = 0U;
+	esp_err_t err = isString ? nvs_get_str(handler, keyStr, NULL, &stored) : nvs_get_blob(handler, keyStr, NULL, &stored);
+	if (err == ESP_ERR_NVS_NOT_FOUND) {
+		int64_t start = esp_timer_get_time();
+		err = isString ? nvs_set_str(handler, keyStr, value) : nvs_set_blob(handler, keyStr, value, length);
+		nvmRecord(&telemetry.sets, start, err, nvmDataEntries(length));
+		if (err == ESP_OK) {
+			nvmCommit();
+		}
+	}
+
+	nvmUnlockWrite();
+}
+
+/**
+ * Finds cache slot of key
+ * 
+ * @param key integer key
+ * @param insert whether to claim an empty slot if key is missing
+ * 
+ * @return slot of key, NULL if missing and not inserted or cache is full
+ */
+static nvm_cache_entry_t* nvmCacheFind(nvm_size_t key, bool insert) {
+
+	uint32_t slot = ((uint32_t)key * CACHE_HASH) & CACHE_MASK;
+
+	for (uint32_t i = 0U; i < NVM_CACHE_SIZE; i++) {
+		nvm_cache_entry_t *entry = &cache[(slot + i) & CACHE_MASK];
+		if (!entry -> valid) {
+			if (!insert) {
+				return NULL;
+			}
+			entry -> key = key;
+			entry -> type = NVM_TYPE_NONE;
+			entry -> valid = true;
+			entry -> dirty = false;
+			return entry;
+		}
+		if (entry -> key == key) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Drops every cached value
+ * 
+ * @note dirty values are lost
+ */
+static void nvmCacheClear(void) {
+	memset(cache, 0, sizeof(cache));
+	cacheDirty = 0U;
+	journalCount = 0U;
+	journalListed = true;
+}
+
+/**
+ * Marks cached value as stored under its own key
+ * 
+ * @param entry cache entry of value
+ */
+static void nvmJournalMark(nvm_cache_entry_t *entry) {
+
+	if (!entry -> journaled) {
+		entry -> journaled = true;
+		journalCount++;
+		journalListed = false;
+	}
+	if (journalCount > NVM_JOURNAL_SIZE) {
+		configStale = true;
+	}
+}
+
+/**
+ * Changes cached value, committed later
+ * 
+ * @param entry cache entry of key
+ * @param type NVS type of value
+ * @param value value, sign extended for signed types
+ */
+static void nvmCacheSet(nvm_cache_entry_t *entry, uint8_t type, uint64_t value) {
+
+	if (entry -> journaled && entry -> type != type) {
+		// journal names key with its type
+		journalListed = false;
+	}
+
+	entry -> type = type;
+	entry -> value = value;
+	keysChanged++;
+	if (!entry -> dirty) {
+		entry -> dirty = true;
+		cacheDirty++;
+	}
+}
+
+/**
+ * Reads values committed under their own keys since config record
+ * 
+ * @note caller holds THREAD_LOCK
+ * @note damaged journals are dropped with the next commit,
+ * their values stay as recorded
+ */
+static void nvmJournalLoad(void) {
+
+	size_t length = sizeof(journal);
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_get_blob(handler, JOURNAL_KEY, journal, &length);
+	nvmRecord(&telemetry.gets, start, err, 0U);
+	if (err == ESP_ERR_NVS_NOT_FOUND) {
+		return;
+	}
+	if (err != ESP_OK || length % sizeof(nvm_journal_entry_t) != 0U) {
+		configStale = true;
+		return;
+	}
+
+	for (uint16_t i = 0U; i < length / sizeof(nvm_journal_entry_t); i++) {
+		uint64_t value;
+		if (!nvmGetRaw(journal[i].key, journal[i].type, &value)) {
+			continue;
+		}
+		nvm_cache_entry_t *entry = nvmCacheFind(journal[i].key, true);
+		if (entry == NULL) {
+			break;
+		}
+		entry -> type = journal[i].type;
+		entry -> value = value;
+		nvmJournalMark(entry);
+	}
+	journalListed = true;
+}
+
+/**
+ * Checks config record and loads its values into cache
+ * 
+ * @param record record read from flash
+ * @param length bytes read
+ * @param capacity bytes of record storage
+ * 
+ * @note caller holds THREAD_LOCK
+ * 
+ * @return if record was valid
+ */
+static bool nvmConfigParse(nvm_config_record_t *record, size_t length, size_t capacity) {
+
+	if (length < CONFIG_V1_HEADER_SIZE) {
+		return false;
+	}
+
+	if (record -> version == 1U) {
+		if (length + CONFIG_HEADER_SIZE - CONFIG_V1_HEADER_SIZE > capacity) {
+			return false;
+		}
+		// upgraded in RAM, written as current version with next commit
+		uint8_t *bytes = (uint8_t*)record;
+		memmove(record -> entries, &bytes[CONFIG_V1_HEADER_SIZE], length - CONFIG_V1_HEADER_SIZE);
+		length += CONFIG_HEADER_SIZE - CONFIG_V1_HEADER_SIZE;
+		record -> entriesWritten = 0U;
+	}
+	else if (record -> version != CONFIG_VERSION || length < CONFIG_HEADER_SIZE) {
+		return false;
+	}
+
+	if (record -> entrySize != sizeof(nvm_config_entry_t)) {
+		return false;
+	}
+
+	size_t entriesLength = record -> count * sizeof(nvm_config_entry_t);
+	if (length != CONFIG_HEADER_SIZE + entriesLength) {
+		return false;
+	}
+	uint16_t crc = frameCRC16(FRAME_CRC_INIT, record -> entries, entriesLength);
+	if (record -> version == CONFIG_VERSION) {
+		crc = frameCRC16(crc, &record -> entriesWritten, sizeof(record -> entriesWritten));
+	}
+	if (crc != record -> crc) {
+		return false;
+	}
+
+	entriesWritten = record -> entriesWritten;
+	if (record -> version != CONFIG_VERSION) {
+		configStale = true;
+	}
+
+	for (uint16_t i = 0U; i < record -> count; i++) {
+		nvm_config_entry_t *stored = &record -> entries[i];
+		nvm_cache_entry_t *entry = nvmCacheFind(stored -> key, true);
+		if (entry != NULL) {
+			entry -> type = stored -> type;
+			entry -> value = stored -> value;
+			continue;
+		}
+
+		// cache full, value moves to its own key unless a newer one is there
+		uint64_t value;
+		if (!nvmGetRaw(stored -> key, stored -> type, &value)) {
+			nvmSetRaw(stored -> key, stored -> type, stored -> value);
+		}
+		configStale = true;
+	}
+
+	return true;
+}
+
+/**
+ * Loads config record into cache with one read
+ * 
+ * @note caller holds THREAD_LOCK
+ * @note missing or damaged records leave values
+ * to be read from their own keys
+ * @note records of a larger NVM_CACHE_SIZE are read from heap,
+ * values past the cache move to their own keys
+ */
+static void nvmConfigLoad(void) {
+
+	configDamaged = false;
+	configStale = false;
+
+	nvm_config_record_t *record = &configRecord;
+	size_t length = sizeof(configRecord);
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_get_blob(handler, CONFIG_KEY, record, &length);
+	if (err == ESP_ERR_NVS_INVALID_LENGTH && nvs_get_blob(handler, CONFIG_KEY, NULL, &length) == ESP_OK) {
+		// room for version 1 to grow into current header
+		record = malloc(length + CONFIG_HEADER_SIZE - CONFIG_V1_HEADER_SIZE);
+		err = (record == NULL) ? ESP_ERR_NO_MEM : nvs_get_blob(handler, CONFIG_KEY, record, &length);
+	}
+	nvmRecord(&telemetry.gets, start, err, 0U);
+
+	if (err == ESP_OK) {
+		size_t capacity = (record == &configRecord) ? sizeof(configRecord) : length + CONFIG_HEADER_SIZE - CONFIG_V1_HEADER_SIZE;
+		configDamaged = !nvmConfigParse(record, length, capacity);
+	}
+	else if (err != ESP_ERR_NVS_NOT_FOUND && err != ESP_ERR_NO_MEM) {
+		configDamaged = true;
+	}
+	if (record != &configRecord) {
+		free(record);
+	}
+
+	nvmJournalLoad();
+	if (configStale) {
+		nvmScheduleCommit();
+	}
+}
+
+/**
+ * Packs every known cached value into config record
+ * 
+ * @note caller holds THREAD_LOCK
+ * 
+ * @return if record was written, not yet committed
+ */
+static bool nvmConfigStore(void) {
+
+	uint16_t count = 0U;
+	for (uint32_t i = 0U; i < NVM_CACHE_SIZE; i++) {
+		nvm_cache_entry_t *entry = &cache[i];
+		if (!entry -> valid || entry -> type == NVM_TYPE_NONE) {
+			continue;
+		}
+		configRecord.entries[count].key = entry -> key;
+		configRecord.entries[count].value = entry -> value;
+		configRecord.entries[count].type = entry -> type;
+		count++;
+	}
+
+	size_t entriesLength = count * sizeof(nvm_config_entry_t);
+	size_t length = CONFIG_HEADER_SIZE + entriesLength;
+	configRecord.version = CONFIG_VERSION;
+	configRecord.count = count;
+	configRecord.entrySize = sizeof(nvm_config_entry_t);
+	configRecord.entriesWritten = entriesWritten + nvmDataEntries(length);
+	configRecord.crc = frameCRC16(FRAME_CRC_INIT, configRecord.entries, entriesLength);
+	configRecord.crc = frameCRC16(configRecord.crc, &configRecord.entriesWritten, sizeof(configRecord.entriesWritten));
+
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_set_blob(handler, CONFIG_KEY, &configRecord, length);
+	nvmRecord(&telemetry.sets, start, err, nvmDataEntries(length));
+	if (err != ESP_OK) {
+		return false;
+	}
+
+	// values under their own keys now live in the record
+	for (uint32_t i = 0U; i < NVM_CACHE_SIZE; i++) {
+		nvm_cache_entry_t *entry = &cache[i];
+		if (!entry -> valid || !entry -> journaled) {
+			continue;
+		}
+		char keyBuffer[KEY_NAME_SIZE];
+		nvs_erase_key(handler, nvmKeyName(entry -> key, keyBuffer));
+		char legacyStr[CHAR_KEY_SIZE];
+		if (nvmLegacyName(entry -> key, legacyStr)) {
+			nvs_erase_key(handler, legacyStr);
+		}
+		entry -> journaled = false;
+	}
+	journalCount = 0U;
+	journalListed = true;
+	nvs_erase_key(handler, JOURNAL_KEY);
+
+	configDamaged = false;
+	configStale = false;
+	return true;
+}
+
+/**
+ * Writes dirty values under their own keys and lists them in journal
+ * 
+ * @note caller holds THREAD_LOCK
+ * 
+ * @return if values and journal were written, not yet committed
+ */
+static bool nvmJournalStore(void) {
+
+	uint16_t count = 0U;
+	for (uint32_t i = 0U; i < NVM_CACHE_SIZE; i++) {
+		nvm_cache_entry_t *entry = &cache[i];
+		if (!entry -> valid) {
+			continue;
+		}
+		if (entry -> dirty) {
+			if (!nvmSetRaw(entry -> key, entry -> type, entry -> value)) {
+				return false;
+			}
+			nvmJournalMark(entry);
+		}
+		if (entry -> journaled && count < NVM_JOURNAL_SIZE) {
+			journal[count].key = entry -> key;
+			journal[count].type = entry -> type;
+			count++;
+		}
+	}
+
+	// rewrites of listed keys leave journal as is
+	if (journalListed) {
+		return true;
+	}
+
+	// listed after values land, so journal never names a value older than the record
+	size_t length = count * sizeof(nvm_journal_entry_t);
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_set_blob(handler, JOURNAL_KEY, journal, length);
+	nvmRecord(&telemetry.sets, start, err, nvmDataEntries(length));
+	if (err != ESP_OK) {
+		return false;
+	}
+
+	journalListed = true;
+	return true;
+}
+
+/**
+ * Commits dirty values under their own keys, or as config record once journal is full
+ * 
+ * @note caller holds THREAD_LOCK
+ * 
+ * @return if every dirty value was committed
+ */
+static bool nvmCacheCommit(void) {
+
+	if (cacheDirty == 0U && !configStale) {
+		return true;
+	}
+
+	uint16_t journaled = journalCount;
+	for (uint32_t i = 0U; i < NVM_CACHE_SIZE; i++) {
+		if (cache[i].valid && cache[i].dirty && !cache[i].journaled) {
+			journaled++;
+		}
+	}
+
+	bool stored;
+	if (configStale || journaled > NVM_JOURNAL_SIZE) {
+		stored = nvmConfigStore();
+	}
+	else {
+		stored = nvmJournalStore();
+	}
+	if (!stored || nvmCommit() != ESP_OK) {
+		return false;
+	}
+
+	for (uint32_t i = 0U; i < NVM_CACHE_SIZE; i++) {
+		cache[i].dirty = false;
+	}
+	cacheDirty = 0U;
+
+	return true;
+}
+
+/**
+ * Commits cached writes once delay passes
+ * 
+ * @param arg unused
+ */
+static void nvmCommitTimer(void *arg) {
+
+	// retries later while NVM is held, timer task never waits
+	if (!nvmLockWrite(0U)) {
+		esp_timer_start_once(commitTimer, NVM_COMMIT_DELAY_MS * 1000ULL);
+		return;
+	}
+
+	if (!nvmCacheCommit() && (cacheDirty != 0U || configStale)) {
+		esp_timer_start_once(commitTimer, NVM_COMMIT_DELAY_MS * 1000ULL);
+	}
+	nvmUnlockWrite();
+}
+
+/**
+ * Starts commit delay if not already running
+ */
+static void nvmScheduleCommit(void) {
+
+	if (commitTimer == NULL) {
+		esp_timer_create_args_t args = {
+			.callback = nvmCommitTimer,
+			.arg = NULL,
+			.dispatch_method = ESP_TIMER_TASK,
+			.name = "nvmCommit",
+			.skip_unhandled_events = true,
+		};
+		if (esp_timer_create(&args, &commitTimer) != ESP_OK) {
+			commitTimer = NULL;
+			return;
+		}
+	}
+
+	if (!esp_timer_is_active(commitTimer)) {
+		esp_timer_start_once(commitTimer, NVM_COMMIT_DELAY_MS * 1000ULL);
+	}
+}
+
+/**
+ * Reads value from cache, loading it from flash on miss
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value pointer to store value, sign extended for signed types
+ * 
+ * @note caller holds THREAD_LOCK
+ * 
+ * @return if read was successful
+ */
+static bool nvmCacheLoad(nvm_size_t key, uint8_t type, uint64_t *value) {
+
+	nvm_cache_entry_t *entry = nvmCacheFind(key, false);
+	if (entry != NULL && entry -> type == type) {
+		*value = entry -> value;
+		return true;
+	}
+	if (entry != NULL && entry -> dirty) {
+		// NVS rejects reads of another type
+		return false;
+	}
+
+	if (!nvmGetRaw(key, type, value)) {
+		return false;
+	}
+
+	if (entry == NULL) {
+		entry = nvmCacheFind(key, true);
+	}
+	if (entry != NULL) {
+		// version 0 value, moves into config record with its next rewrite
+		entry -> type = type;
+		entry -> value = *value;
+		nvmJournalMark(entry);
+		if (configStale) {
+			nvmScheduleCommit();
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Finds staged batch write of key
+ * 
+ * @param key integer key
+ * 
+ * @return staged write, NULL if key is not staged
+ */
+static nvm_batch_entry_t* nvmBatchFind(nvm_size_t key) {
+
+	for (uint16_t i = 0U; i < batchCount; i++) {
+		if (batch[i].key == key) {
+			return &batch[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Reads value, seeing staged writes of batch owner
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value pointer to store value, sign extended for signed types
+ * 
+ * @return if read was successful
+ */
+static bool nvmCacheRead(nvm_size_t key, uint8_t type, uint64_t *value) {
+
+	if (!nvmBegan) {
+		return false;
+	}
+
+	if (BATCH_OWNED()) {
+		// batch already holds THREAD_LOCK
+		nvm_batch_entry_t *staged = nvmBatchFind(key);
+		if (staged != NULL) {
+			if (staged -> type != type) {
+				return false;
+			}
+			*value = staged -> value;
+			return true;
+		}
+		return nvmCacheLoad(key, type, value);
+	}
+
+	READ_LOCK();
+	nvm_cache_entry_t *entry = nvmCacheFind(key, false);
+	if (entry != NULL && entry -> type == type) {
+		*value = entry -> value;
+		READ_UNLOCK();
+		nvmCount(&telemetry.cacheHits);
+		return true;
+	}
+	READ_UNLOCK();
+
+	// misses fill cache, so need the lock alone
+	THREAD_LOCK();
+	bool read = nvmCacheLoad(key, type, value);
+	THREAD_UNLOCK();
+
+	return read;
+}
+
+/**
+ * Stages value in batch, replacing earlier write of key
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value value, sign extended for signed types
+ * 
+ * @return if value was staged, false if batch is full
+ */
+static bool nvmBatchStage(nvm_size_t key, uint8_t type, uint64_t value) {
+
+	nvm_batch_entry_t *staged = nvmBatchFind(key);
+	if (staged == NULL) {
+		if (batchCount >= NVM_BATCH_SIZE) {
+			return false;
+		}
+		staged = &batch[batchCount++];
+		staged -> key = key;
+	}
+
+	staged -> type = type;
+	staged -> value = value;
+
+	return true;
+}
+
+/**
+ * Writes value into cache, committed later
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value value, sign extended for signed types
+ * 
+ * @note writes straight to flash when cache is full
+ * 
+ * @return if write was successful
+ */
+static bool nvmCacheWrite(nvm_size_t key, uint8_t type, uint64_t value) {
+
+	if (!nvmBegan) {
+		return false;
+	}
+
+	if (BATCH_OWNED()) {
+		// batch already holds THREAD_LOCK
+		return nvmBatchStage(key, type, value);
+	}
+
+	THREAD_LOCK();
+
+	nvm_cache_entry_t *entry = nvmCacheFind(key, true);
+	if (entry == NULL) {
+		bool written = nvmSetRaw(key, type, value) && nvmCommit() == ESP_OK;
+		keysChanged++;
+		THREAD_UNLOCK();
+		return written;
+	}
+
+	if (entry -> type == NVM_TYPE_NONE) {
+		// first write of key compares against flash
+		uint64_t stored;
+		if (nvmGetRaw(key, type, &stored)) {
+			entry -> type = type;
+			entry -> value = stored;
+		}
+	}
+
+	// unchanged values cost no flash write
+	if (entry -> type == type && entry -> value == value) {
+		THREAD_UNLOCK();
+		return true;
+	}
+
+	nvmCacheSet(entry, type, value);
+	nvmScheduleCommit();
+	THREAD_UNLOCK();
+
+	return true;
+}
+
+bool nvmFlush(void) {
+
+	if (!nvmBegan) {
+		return false;
+	}
+
+	// queued async writes land first
+	if (!nvmAsyncDrain()) {
+		return false;
+	}
+
+	THREAD_LOCK();
+	bool committed = nvmCacheCommit();
+	THREAD_UNLOCK();
+
+	return committed;
+}
+
+bool nvmWasBusy(void) {
+	return lockBusy;
+}
+
+bool nvmBeginBatch(void) {
+
+	if (!nvmBegan || BATCH_OWNED()) {
+		return false;
+	}
+
+	THREAD_LOCK();
+	batchCount = 0U;
+	batchOwner = xTaskGetCurrentTaskHandle();
+
+	return true;
+}
+
+bool nvmCommitBatch(struct nvmBatchStats *stats) {
+
+	if (!BATCH_OWNED()) {
+		return false;
+	}
+
+	nvs_stats_t before;
+	bool counted = nvs_get_stats(NULL, &before) == ESP_OK;
+
+	bool written = true;
+	uint16_t writes = 0U;
+	for (uint16_t i = 0U; i < batchCount; i++) {
+		nvm_batch_entry_t *staged = &batch[i];
+		nvm_cache_entry_t *entry = nvmCacheFind(staged -> key, true);
+
+		if (entry == NULL) {
+			// cache full, value lands with the commit below
+			if (!nvmSetRaw(staged -> key, staged -> type, staged -> value)) {
+				written = false;
+				continue;
+			}
+			keysChanged++;
+			writes++;
+			continue;
+		}
+
+		// unchanged values cost no flash write
+		if (entry -> type == staged -> type && entry -> value == staged -> value) {
+			continue;
+		}
+
+		nvmCacheSet(entry, staged -> type, staged -> value);
+		writes++;
+	}
+
+	// one commit covers staged values and earlier cached writes
+	bool committed;
+	if (cacheDirty != 0U) {
+		committed = nvmCacheCommit();
+	}
+	else {
+		committed = nvmCommit() == ESP_OK;
+	}
+
+	if (stats != NULL) {
+		nvs_stats_t after;
+		stats -> writes = writes;
+		stats -> entries = writes;
+		stats -> pages = 0U;
+		if (counted && nvs_get_stats(NULL, &after) == ESP_OK && after.free_entries <= before.free_entries) {
+			// free entries can grow instead when NVS reclaims a page mid commit
+			stats -> entries = before.free_entries - after.free_entries;
+		}
+		if (stats -> entries != 0U) {
+			uint32_t offset = counted ? (before.total_entries - before.free_entries) % NVM_PAGE_ENTRIES : 0U;
+			stats -> pages = (offset + stats -> entries + NVM_PAGE_ENTRIES - 1U) / NVM_PAGE_ENTRIES;
+		}
+	}
+
+	batchCount = 0U;
+	batchOwner = NULL;
+	THREAD_UNLOCK();
+
+	return written && committed;
+}
+
+bool nvmAbortBatch(void) {
+
+	if (!BATCH_OWNED()) {
+		return false;
+	}
+
+	batchCount = 0U;
+	batchOwner = NULL;
+	THREAD_UNLOCK();
+
+	return true;
+}
+
+bool nvmGetTelemetry(struct nvmTelemetry *stats) {
+
+	if (stats == NULL) {
+		return false;
+	}
+
+	taskENTER_CRITICAL(&telemetrySpin);
+	*stats = telemetry;
+	stats -> entriesWritten = entriesWritten;
+	taskEXIT_CRITICAL(&telemetrySpin);
+
+	nvs_stats_t nvsStats;
+	if (!nvmBegan || nvs_get_stats(NULL, &nvsStats) != ESP_OK) {
+		return false;
+	}
+
+	stats -> usedEntries = nvsStats.used_entries;
+	stats -> freeEntries = nvsStats.free_entries;
+	stats -> totalEntries = nvsStats.total_entries;
 
-	//writes platform values
-	return code;
+	// NVS fills pages in turn, so each page is erased
+	// once per total entries written
+	if (nvsStats.total_entries != 0U) {
+		stats -> eraseCycles = stats -> entriesWritten / nvsStats.total_entries;
+	}
+
+	return true;
+}
+
+void nvmResetTelemetry(void) {
+
+	taskENTER_CRITICAL(&telemetrySpin);
+	memset(&telemetry, 0, sizeof(telemetry));
+	taskEXIT_CRITICAL(&telemetrySpin);
 }
 
 /**
- * Converts integer key to char array key
+ * Prints stats and histogram of one operation type
  * 
- * @param key integer key
- * @param keyStr char array to store key
+ * @param name name of operation
+ * @param op stats to print
  */
-void keyToChar(nvm_size_t key, char* keyStr) {
-	for (uint8_t i = 0U; i < NVM_MAX_SIZE_BYTES; i++) {
-		uint8_t subKey = (key >> (8*i)) & (ONE_BYTE);
-		keyStr[i] = subKey;
+static void nvmDumpOp(const char *name, const struct nvmOpStats *op) {
+
+	printf("%s: %lu, %lu failed, avg %lu us, max %lu us\n", name,
+		(unsigned long)op -> count, (unsigned long)op -> failures,
+		(unsigned long)(op -> count ? op -> totalUS / op -> count : 0U), (unsigned long)op -> maxUS);
+
+	for (uint8_t i = 0U; i < NVM_LATENCY_BUCKETS; i++) {
+		if (op -> buckets[i] == 0U) {
+			continue;
+		}
+		uint32_t low = (i == 0U) ? 0U : (1UL << (i - 1U));
+		printf("  >= %lu us: %lu\n", (unsigned long)low, (unsigned long)op -> buckets[i]);
 	}
-	keyStr[NVM_MAX_SIZE_BYTES] = END_OF_CHAR;
 }
 
-#define SET_NVS(key, setter, value) \
-	if (!nvmBegan) { \
-		return false; \
-	} \
-	THREAD_LOCK(); \
-	char keyStr[CHAR_KEY_SIZE]; \
-	keyToChar(key, keyStr); \
-	if (setter(handler, keyStr, value) != ESP_OK) { \
-		THREAD_UNLOCK(); \
-		return false; \
-	} \
-	if (nvs_commit(handler) != ESP_OK) { \
-		THREAD_UNLOCK(); \
-		return false; \
-	} \
-	THREAD_UNLOCK(); \
+bool nvmDumpTelemetry(void) {
+
+	struct nvmTelemetry stats = {0};
+	bool counted = nvmGetTelemetry(&stats);
+
+	nvmDumpOp("gets", &stats.gets);
+	nvmDumpOp("sets", &stats.sets);
+	nvmDumpOp("commits", &stats.commits);
+	printf("cache hits: %lu, busy: %lu\n", (unsigned long)stats.cacheHits, (unsigned long)stats.busy);
+
+	if (!counted) {
+		return false;
+	}
+
+	printf("entries: %lu used, %lu free, %lu total, %lu written, ~%lu erase cycles\n",
+		(unsigned long)stats.usedEntries, (unsigned long)stats.freeEntries, (unsigned long)stats.totalEntries,
+		(unsigned long)stats.entriesWritten, (unsigned long)stats.eraseCycles);
+
 	return true;
+}
 
-#define GET_NVS(key, getter, value, canDefault, defaultValue) \
-	if (!nvmBegan) { \
-		return false; \
-	} \
-	THREAD_LOCK(); \
-	char keyStr[CHAR_KEY_SIZE]; \
-	keyToChar(key, keyStr); \
-	if (getter(handler, keyStr, value) != ESP_OK) { \
-		THREAD_UNLOCK(); \
+#define SET_NVS(key, type, value) \
+	return nvmCacheWrite(key, type, (uint64_t)(value));
+
+#define GET_NVS(key, type, valueType, value, canDefault, defaultValue) \
+	uint64_t rawValue; \
+	if (!nvmCacheRead(key, type, &rawValue)) { \
 		return false; \
 	} \
+	*value = (valueType)rawValue; \
 	if (!canDefault && *value == defaultValue) { \
-		THREAD_UNLOCK(); \
 		return false; \
 	} \
-	THREAD_UNLOCK(); \
 	return true;
 
 bool nvmWriteCharArray(nvm_size_t key, char* value, uint8_t maxLength) {
@@ -240,14 +1643,30 @@ bool nvmWriteCharArray(nvm_size_t key, char* value, uint8_t maxLength) {
 
 	THREAD_LOCK();
 
-	char keyStr[CHAR_KEY_SIZE];
-	keyToChar(key, keyStr);
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *keyStr = nvmKeyName(key, keyBuffer);
+
+	// unchanged strings cost no flash write
+	if (nvmDataStored(keyStr, value, valueLen + 1U, true)) {
+		THREAD_UNLOCK();
+		return true;
+	}
 	
-	if (nvs_set_str(handler, keyStr, value) != ESP_OK) {
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_set_str(handler, keyStr, value);
+	nvmRecord(&telemetry.sets, start, err, nvmDataEntries(valueLen + 1U));
+	if (err != ESP_OK) {
 		THREAD_UNLOCK();
 		return false;
 	}
-	if (nvs_commit(handler) != ESP_OK) {
+	keysChanged++;
+
+	// value under legacy name is outdated now
+	char legacyStr[CHAR_KEY_SIZE];
+	if (nvmLegacyName(key, legacyStr)) {
+		nvs_erase_key(handler, legacyStr);
+	}
+	if (nvmCommit() != ESP_OK) {
 		THREAD_UNLOCK();
 		return false;
 	}
@@ -268,21 +1687,79 @@ bool nvmGetCharArray(nvm_size_t key, char* value, uint8_t maxLength) {
 		return false;
 	}
 
-	THREAD_LOCK();
+	READ_LOCK();
 	
-	char keyStr[CHAR_KEY_SIZE];
-	keyToChar(key, keyStr);
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *keyStr = nvmKeyName(key, keyBuffer);
+	char legacyStr[CHAR_KEY_SIZE];
+	const char *readStr = keyStr;
 
 	size_t strSize = 0;
-	if (nvs_get_str(handler, keyStr, NULL, &strSize) != ESP_OK) {
-		THREAD_UNLOCK();
+	esp_err_t err = nvs_get_str(handler, readStr, NULL, &strSize);
+	if (err == ESP_ERR_NVS_NOT_FOUND && nvmLegacyName(key, legacyStr)) {
+		// stored before printable key names
+		readStr = legacyStr;
+		err = nvs_get_str(handler, readStr, NULL, &strSize);
+	}
+	if (err != ESP_OK) {
+		READ_UNLOCK();
 		return false;
 	}
 	if (strSize > maxLength) {
+		READ_UNLOCK();
+		return false;
+	}
+	int64_t start = esp_timer_get_time();
+	err = nvs_get_str(handler, readStr, value, &strSize);
+	nvmRecord(&telemetry.gets, start, err, 0U);
+	if (err != ESP_OK) {
+		READ_UNLOCK();
+		return false;
+	}
+
+	READ_UNLOCK();
+
+	if (readStr != keyStr) {
+		nvmMigrateData(key, value, strSize, true);
+	}
+
+	return true;
+}
+
+bool nvmWriteBlob(nvm_size_t key, const void* value, size_t length) {
+	if (!nvmBegan) {
+		return false;
+	}
+	if (value == NULL || length == 0U) {
+		return false;
+	}
+
+	THREAD_LOCK();
+
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *keyStr = nvmKeyName(key, keyBuffer);
+
+	// unchanged blobs cost no flash write
+	if (nvmDataStored(keyStr, value, length, false)) {
+		THREAD_UNLOCK();
+		return true;
+	}
+
+	int64_t start = esp_timer_get_time();
+	esp_err_t err = nvs_set_blob(handler, keyStr, value, length);
+	nvmRecord(&telemetry.sets, start, err, nvmDataEntries(length));
+	if (err != ESP_OK) {
 		THREAD_UNLOCK();
 		return false;
 	}
-	if (nvs_get_str(handler, keyStr, value, &strSize) != ESP_OK) {
+	keysChanged++;
+
+	// value under legacy name is outdated now
+	char legacyStr[CHAR_KEY_SIZE];
+	if (nvmLegacyName(key, legacyStr)) {
+		nvs_erase_key(handler, legacyStr);
+	}
+	if (nvmCommit() != ESP_OK) {
 		THREAD_UNLOCK();
 		return false;
 	}
@@ -292,40 +1769,88 @@ bool nvmGetCharArray(nvm_size_t key, char* value, uint8_t maxLength) {
 	return true;
 }
 
+bool nvmGetBlob(nvm_size_t key, void* value, size_t *length) {
+	if (!nvmBegan) {
+		return false;
+	}
+	if (value == NULL || length == NULL) {
+		return false;
+	}
+
+	READ_LOCK();
+
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *keyStr = nvmKeyName(key, keyBuffer);
+	char legacyStr[CHAR_KEY_SIZE];
+	const char *readStr = keyStr;
+
+	size_t blobSize = 0;
+	esp_err_t err = nvs_get_blob(handler, readStr, NULL, &blobSize);
+	if (err == ESP_ERR_NVS_NOT_FOUND && nvmLegacyName(key, legacyStr)) {
+		// stored before printable key names
+		readStr = legacyStr;
+		err = nvs_get_blob(handler, readStr, NULL, &blobSize);
+	}
+	if (err != ESP_OK) {
+		READ_UNLOCK();
+		return false;
+	}
+	if (blobSize > *length) {
+		READ_UNLOCK();
+		return false;
+	}
+	int64_t start = esp_timer_get_time();
+	err = nvs_get_blob(handler, readStr, value, &blobSize);
+	nvmRecord(&telemetry.gets, start, err, 0U);
+	if (err != ESP_OK) {
+		READ_UNLOCK();
+		return false;
+	}
+	*length = blobSize;
+
+	READ_UNLOCK();
+
+	if (readStr != keyStr) {
+		nvmMigrateData(key, value, blobSize, false);
+	}
+
+	return true;
+}
+
 bool nvmWriteBool(nvm_size_t key, bool value) {
-	SET_NVS(key, nvs_set_u8, value);
+	SET_NVS(key, NVM_TYPE_U8, value);
 }
 
 bool nvmWriteI8(nvm_size_t key, int8_t value) {
-	SET_NVS(key, nvs_set_i8, value);
+	SET_NVS(key, NVM_TYPE_I8, value);
 }
 
 bool nvmWriteUI8(nvm_size_t key, uint8_t value) {
-	SET_NVS(key, nvs_set_u8, value);
+	SET_NVS(key, NVM_TYPE_U8, value);
 }
 
 bool nvmWriteI16(nvm_size_t key, int16_t value) {
-	SET_NVS(key, nvs_set_i16, value);
+	SET_NVS(key, NVM_TYPE_I16, value);
 }
 
 bool nvmWriteUI16(nvm_size_t key, uint16_t value) {
-	SET_NVS(key, nvs_set_u16, value);
+	SET_NVS(key, NVM_TYPE_U16, value);
 }
 
 bool nvmWriteI32(nvm_size_t key, int32_t value) {
-	SET_NVS(key, nvs_set_i32, value);
+	SET_NVS(key, NVM_TYPE_I32, value);
 }
 
 bool nvmWriteUI32(nvm_size_t key, uint32_t value) {
-	SET_NVS(key, nvs_set_u32, value);
+	SET_NVS(key, NVM_TYPE_U32, value);
 }
 
 bool nvmWriteI64(nvm_size_t key, int64_t value) {
-	SET_NVS(key, nvs_set_i64, value);
+	SET_NVS(key, NVM_TYPE_I64, value);
 }
 
 bool nvmWriteUI64(nvm_size_t key, uint64_t value) {
-	SET_NVS(key, nvs_set_u64, value);
+	SET_NVS(key, NVM_TYPE_U64, value);
 }
 
 bool nvmWriteFloat(nvm_size_t key, float value) {
@@ -417,39 +1942,39 @@ bool nvmWriteDouble(nvm_size_t key, double value) {
 }
 
 bool nvmGetBool(nvm_size_t key, bool *value, bool canDefault) {
-	GET_NVS(key, nvs_get_u8, (uint8_t*)value, canDefault, DEFAULT_BOOL);
+	GET_NVS(key, NVM_TYPE_U8, uint8_t, (uint8_t*)value, canDefault, DEFAULT_BOOL);
 }
 
 bool nvmGetI8(nvm_size_t key, int8_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_i8, value, canDefault, (int8_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_I8, int8_t, value, canDefault, (int8_t)DEFAULT_INT);
 }
 
 bool nvmGetUI8(nvm_size_t key, uint8_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_u8, value, canDefault, (uint8_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_U8, uint8_t, value, canDefault, (uint8_t)DEFAULT_INT);
 }
 
 bool nvmGetI16(nvm_size_t key, int16_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_i16, value, canDefault, (int16_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_I16, int16_t, value, canDefault, (int16_t)DEFAULT_INT);
 }
 
 bool nvmGetUI16(nvm_size_t key, uint16_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_u16, value, canDefault, (uint16_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_U16, uint16_t, value, canDefault, (uint16_t)DEFAULT_INT);
 }
 
 bool nvmGetI32(nvm_size_t key, int32_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_i32, value, canDefault, (int32_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_I32, int32_t, value, canDefault, (int32_t)DEFAULT_INT);
 }
 
 bool nvmGetUI32(nvm_size_t key, uint32_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_u32, value, canDefault, (uint32_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_U32, uint32_t, value, canDefault, (uint32_t)DEFAULT_INT);
 }
 
 bool nvmGetI64(nvm_size_t key, int64_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_i64, value, canDefault, (int64_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_I64, int64_t, value, canDefault, (int64_t)DEFAULT_INT);
 }
 
 bool nvmGetUI64(nvm_size_t key, uint64_t *value, bool canDefault) {
-	GET_NVS(key, nvs_get_u64, value, canDefault, (uint64_t)DEFAULT_INT);
+	GET_NVS(key, NVM_TYPE_U64, uint64_t, value, canDefault, (uint64_t)DEFAULT_INT);
 }
 
 bool nvmGetFloat(nvm_size_t key, float *value, bool canDefault) {
@@ -580,4 +2105,383 @@ bool nvmGetDouble(nvm_size_t key, double *value, bool canDefault) {
 	return false;
 }
 
-#endif
\ No newline at end of file
+/****************************
+ * Async Writer
+****************************/
+
+#define ASYNC_STACK 4096U // stack size of writer task
+#define ASYNC_FLUSH (NVM_TYPE_NONE - 1U) // item asks for everything before it to land
+#define ASYNC_STOP (NVM_TYPE_NONE - 2U) // item ends writer task
+
+#if NVM_ASYNC_QUEUE_SIZE > NVM_BATCH_SIZE
+	#error "NVM_ASYNC_QUEUE_SIZE must fit in NVM_BATCH_SIZE"
+#endif
+
+typedef struct nvm_async_item_s {
+	nvm_size_t key; // NVM key
+	uint64_t value; // value, sign extended for signed types, or flush sequence
+	uint8_t type; // NVS type of value, ASYNC_FLUSH or ASYNC_STOP
+	nvm_async_t *handle; // completion of caller, can be NULL
+} nvm_async_item_t;
+
+static QueueHandle_t asyncQueue = NULL; // writes waiting for writer task
+static TaskHandle_t asyncTask = NULL;
+static SemaphoreHandle_t asyncExited = NULL; // given when writer task exits
+static uint32_t flushRequested = 0U; // sequence of last flush asked for
+static uint32_t flushDone = 0U; // sequence of last flush landed
+static uint32_t landsFailed = 0U; // lands that dropped writes
+
+// owned by writer task
+static nvm_async_item_t asyncPending[NVM_ASYNC_QUEUE_SIZE]; // writes of drained items, one per key
+static nvm_async_item_t asyncWaiting[NVM_ASYNC_QUEUE_SIZE]; // handles of drained items and their key
+static uint16_t pendingCount = 0U;
+static uint16_t waitingCount = 0U;
+
+/**
+ * Adds drained write, replacing earlier write of key
+ * 
+ * @param item write to add
+ */
+static void nvmAsyncCoalesce(const nvm_async_item_t *item) {
+
+	uint16_t i = 0U;
+	while (i < pendingCount && asyncPending[i].key != item -> key) {
+		i++;
+	}
+	if (i == pendingCount) {
+		pendingCount++;
+	}
+	asyncPending[i] = *item;
+
+	if (item -> handle != NULL) {
+		asyncWaiting[waitingCount++] = *item;
+	}
+}
+
+/**
+ * Writes drained values with one commit and completes their handles
+ * 
+ * @return if every drained value was committed
+ */
+static bool nvmAsyncLand(void) {
+
+	bool written = pendingCount == 0U;
+	while (pendingCount != 0U) {
+		if (nvmBeginBatch()) {
+			written = true;
+			for (uint16_t i = 0U; i < pendingCount; i++) {
+				written &= nvmCacheWrite(asyncPending[i].key, asyncPending[i].type, asyncPending[i].value);
+			}
+			written &= nvmCommitBatch(NULL);
+			break;
+		}
+		if (!nvmWasBusy()) {
+			break;
+		}
+		// NVM held elsewhere, writes stay queued
+		vTaskDelay(pdMS_TO_TICKS(NVM_LOCK_WAIT_MS));
+	}
+
+	for (uint16_t i = 0U; i < waitingCount; i++) {
+		nvm_async_t *handle = asyncWaiting[i].handle;
+		nvm_async_callback_t callback = handle -> callback;
+		void *context = handle -> context;
+
+		// handle may be reused by caller once state is set
+		__atomic_store_n(&handle -> state, written ? NVM_ASYNC_WRITTEN : NVM_ASYNC_FAILED, __ATOMIC_RELEASE);
+		if (callback != NULL) {
+			callback(asyncWaiting[i].key, written, context);
+		}
+	}
+
+	pendingCount = 0U;
+	waitingCount = 0U;
+
+	return written;
+}
+
+/**
+ * Drains queue, coalesces writes and commits them
+ * 
+ * @param params unused
+ */
+static void nvmAsyncWriter(void *params) {
+
+	bool running = true;
+	nvm_async_item_t item;
+
+	while (running) {
+		if (xQueueReceive(asyncQueue, &item, portMAX_DELAY) != pdTRUE) {
+			continue;
+		}
+
+		uint32_t flushed = 0U;
+		uint16_t drained = 0U;
+		do {
+			if (item.type == ASYNC_STOP) {
+				running = false;
+			}
+			else if (item.type == ASYNC_FLUSH) {
+				// callers can queue flushes out of sequence order
+				if (flushed == 0U || (int32_t)((uint32_t)item.value - flushed) > 0) {
+					flushed = (uint32_t)item.value;
+				}
+			}
+			else {
+				nvmAsyncCoalesce(&item);
+			}
+			drained++;
+		} while (running && drained < NVM_ASYNC_QUEUE_SIZE && xQueueReceive(asyncQueue, &item, 0U) == pdTRUE);
+
+		// counted before flushDone moves, so waiting flushes see it
+		if (!nvmAsyncLand()) {
+			__atomic_add_fetch(&landsFailed, 1U, __ATOMIC_ACQ_REL);
+		}
+
+		if (flushed != 0U && (int32_t)(flushed - flushDone) > 0) {
+			__atomic_store_n(&flushDone, flushed, __ATOMIC_RELEASE);
+		}
+	}
+
+	xSemaphoreGive(asyncExited);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Waits for writes queued so far to land
+ * 
+ * @note does nothing without writer task or from writer task itself
+ * @note writes dropped by any land while waiting fail the drain,
+ * they may have been queued before it
+ * 
+ * @return if queued writes landed within NVM_ASYNC_FLUSH_MS,
+ * sets 'lockBusy' if they did not land in time
+ */
+static bool nvmAsyncDrain(void) {
+
+	if (asyncTask == NULL || xTaskGetCurrentTaskHandle() == asyncTask) {
+		return true;
+	}
+
+	TickType_t start = xTaskGetTickCount();
+	TickType_t wait = pdMS_TO_TICKS(NVM_ASYNC_FLUSH_MS);
+	uint32_t failedBefore = __atomic_load_n(&landsFailed, __ATOMIC_ACQUIRE);
+
+	uint32_t sequence = __atomic_add_fetch(&flushRequested, 1U, __ATOMIC_ACQ_REL);
+	if (sequence == 0U) {
+		// 0 means no flush to writer
+		sequence = __atomic_add_fetch(&flushRequested, 1U, __ATOMIC_ACQ_REL);
+	}
+
+	nvm_async_item_t item = {
+		.key = 0U,
+		.value = sequence,
+		.type = ASYNC_FLUSH,
+		.handle = NULL,
+	};
+	if (xQueueSend(asyncQueue, &item, wait) != pdTRUE) {
+		lockBusy = true;
+		nvmCount(&telemetry.busy);
+		return false;
+	}
+
+	// later flushes may land first, sequences only grow
+	while ((int32_t)(__atomic_load_n(&flushDone, __ATOMIC_ACQUIRE) - sequence) < 0) {
+		if (xTaskGetTickCount() - start >= wait) {
+			lockBusy = true;
+			nvmCount(&telemetry.busy);
+			return false;
+		}
+		vTaskDelay(1U);
+	}
+
+	lockBusy = false;
+	return __atomic_load_n(&landsFailed, __ATOMIC_ACQUIRE) == failedBefore;
+}
+
+/**
+ * Queues write for writer task
+ * 
+ * @param key integer key
+ * @param type NVS type of value
+ * @param value value, sign extended for signed types
+ * @param handle completion of write, can be NULL
+ * 
+ * @return if write was queued, false and busy if queue is full
+ */
+static bool nvmAsyncQueue(nvm_size_t key, uint8_t type, uint64_t value, nvm_async_t *handle) {
+
+	if (asyncQueue == NULL) {
+		return false;
+	}
+
+	if (handle != NULL) {
+		handle -> state = NVM_ASYNC_PENDING;
+	}
+
+	nvm_async_item_t item = {
+		.key = key,
+		.value = value,
+		.type = type,
+		.handle = handle,
+	};
+	if (xQueueSend(asyncQueue, &item, 0U) != pdTRUE) {
+		lockBusy = true;
+		nvmCount(&telemetry.busy);
+		if (handle != NULL) {
+			handle -> state = NVM_ASYNC_FAILED;
+		}
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * Frees writer queue and semaphore
+ */
+static void nvmAsyncFree(void) {
+
+	if (asyncQueue != NULL) {
+		vQueueDelete(asyncQueue);
+		asyncQueue = NULL;
+	}
+	if (asyncExited != NULL) {
+		vSemaphoreDelete(asyncExited);
+		asyncExited = NULL;
+	}
+}
+
+bool nvmAsyncStart(void) {
+
+	if (asyncTask != NULL) {
+		return false;
+	}
+
+	asyncQueue = xQueueCreate(NVM_ASYNC_QUEUE_SIZE, sizeof(nvm_async_item_t));
+	asyncExited = xSemaphoreCreateBinary();
+	if (asyncQueue == NULL || asyncExited == NULL) {
+		nvmAsyncFree();
+		return false;
+	}
+
+	if (xTaskCreatePinnedToCore(nvmAsyncWriter, "nvmWriter", ASYNC_STACK, NULL, NVM_ASYNC_PRIORITY, &asyncTask, NVM_ASYNC_CORE) != pdPASS) {
+		asyncTask = NULL;
+		nvmAsyncFree();
+		return false;
+	}
+
+	return true;
+}
+
+bool nvmAsyncStop(void) {
+
+	if (asyncTask == NULL) {
+		return false;
+	}
+
+	// writes queued before stop still land
+	nvm_async_item_t item = {
+		.key = 0U,
+		.value = 0U,
+		.type = ASYNC_STOP,
+		.handle = NULL,
+	};
+	if (xQueueSend(asyncQueue, &item, pdMS_TO_TICKS(NVM_ASYNC_FLUSH_MS)) != pdTRUE) {
+		return false;
+	}
+	xSemaphoreTake(asyncExited, portMAX_DELAY);
+
+	asyncTask = NULL;
+	nvmAsyncFree();
+
+	return true;
+}
+
+enum NVMAsyncState nvmAsyncWait(nvm_async_t *handle, uint32_t waitMS) {
+
+	if (handle == NULL) {
+		return NVM_ASYNC_FAILED;
+	}
+
+	TickType_t start = xTaskGetTickCount();
+	uint8_t state;
+	while ((state = __atomic_load_n(&handle -> state, __ATOMIC_ACQUIRE)) == NVM_ASYNC_PENDING) {
+		if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(waitMS)) {
+			break;
+		}
+		vTaskDelay(1U);
+	}
+
+	return state;
+}
+
+bool nvmWriteBoolAsync(nvm_size_t key, bool value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_U8, (uint64_t)value, handle);
+}
+
+bool nvmWriteI8Async(nvm_size_t key, int8_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_I8, (uint64_t)value, handle);
+}
+
+bool nvmWriteUI8Async(nvm_size_t key, uint8_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_U8, (uint64_t)value, handle);
+}
+
+bool nvmWriteI16Async(nvm_size_t key, int16_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_I16, (uint64_t)value, handle);
+}
+
+bool nvmWriteUI16Async(nvm_size_t key, uint16_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_U16, (uint64_t)value, handle);
+}
+
+bool nvmWriteI32Async(nvm_size_t key, int32_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_I32, (uint64_t)value, handle);
+}
+
+bool nvmWriteUI32Async(nvm_size_t key, uint32_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_U32, (uint64_t)value, handle);
+}
+
+bool nvmWriteI64Async(nvm_size_t key, int64_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_I64, (uint64_t)value, handle);
+}
+
+bool nvmWriteUI64Async(nvm_size_t key, uint64_t value, nvm_async_t *handle) {
+	return nvmAsyncQueue(key, NVM_TYPE_U64, value, handle);
+}
+
+bool nvmWriteFloatAsync(nvm_size_t key, float value, nvm_async_t *handle) {
+
+	if (sizeof(float) == sizeof(uint32_t)) {
+		uint32_t newVal;
+		memcpy(&newVal, &value, sizeof(float));
+		return nvmWriteUI32Async(key, newVal, handle);
+	}
+	else if (sizeof(float) == sizeof(uint64_t)) {
+		uint64_t newVal;
+		memcpy(&newVal, &value, sizeof(float));
+		return nvmWriteUI64Async(key, newVal, handle);
+	}
+
+	return false;
+}
+
+bool nvmWriteDoubleAsync(nvm_size_t key, double value, nvm_async_t *handle) {
+
+	if (sizeof(double) == sizeof(uint32_t)) {
+		uint32_t newVal;
+		memcpy(&newVal, &value, sizeof(double));
+		return nvmWriteUI32Async(key, newVal, handle);
+	}
+	else if (sizeof(double) == sizeof(uint64_t)) {
+		uint64_t newVal;
+		memcpy(&newVal, &value, sizeof(double));
+		return nvmWriteUI64Async(key, newVal, handle);
+	}
+
+	return false;
+}
+
+#endif
@@ -0,0 +1,371 @@
+/*
+	board_esp32_nvm.h - nvm extensions for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_NVM_H
+#define BOARD_ESP32_NVM_H
+
+#include "../board.h"
+
+#if defined(ESP32DEVC) && defined(NVM_INTERNAL)
+
+#include "../../nvm/generic_nvm.h"
+
+// 'nvmSetDefaults' result when NVM stayed busy, past Core's codes
+#define NVM_DEFAULT_BUSY ((enum NVMDefaultCode)(NVM_DEFAULT_FAIL_INIT + 1))
+
+enum NVMAsyncState {
+	NVM_ASYNC_PENDING, // queued, not yet committed
+	NVM_ASYNC_WRITTEN, // committed to flash
+	NVM_ASYNC_FAILED, // not queued or not committed
+};
+
+/**
+ * Runs on writer task once async write is done
+ *
+ * @param key key written
+ * @param written if write was committed
+ * @param context user context of handle
+ */
+typedef void (*nvm_async_callback_t)(nvm_size_t key, bool written, void *context);
+
+typedef struct nvm_async_s {
+	nvm_async_callback_t callback; // run once done, can be NULL
+	void *context; // passed to callback
+	volatile uint8_t state; // NVMAsyncState, set by writer task
+} nvm_async_t;
+
+#define NVM_LATENCY_BUCKETS 20U // log2 latency buckets
+
+struct nvmOpStats {
+	uint32_t count; // operations
+	uint32_t failures; // operations NVS refused, missing keys not counted
+	uint32_t maxUS; // slowest operation
+	uint64_t totalUS; // time of every operation, for average
+	uint32_t buckets[NVM_LATENCY_BUCKETS]; // bucket n counts [2^(n-1), 2^n) us, bucket 0 counts 0 us, last bucket open ended
+};
+
+struct nvmTelemetry {
+	struct nvmOpStats gets; // NVS reads, cache hits not counted
+	struct nvmOpStats sets; // NVS writes of values, config record, strings and blobs
+	struct nvmOpStats commits; // NVS commits
+	uint32_t cacheHits; // reads served from RAM cache
+	uint32_t busy; // calls that gave up waiting for lock
+	uint32_t usedEntries; // NVS entries holding data
+	uint32_t freeEntries; // NVS entries left to write
+	uint32_t totalEntries; // NVS entries in partition
+	uint32_t entriesWritten; // NVS entries written over life of flash, estimated
+	uint32_t eraseCycles; // erase cycles each page has taken, estimated
+};
+
+struct nvmDefaultStats {
+	uint16_t keys; // number values, strings and blobs rewritten
+	uint32_t timeUS; // time taken
+	bool erased; // fell back to erasing NVM
+};
+
+struct nvmBatchStats {
+	uint16_t writes; // staged values that changed
+	uint16_t entries; // NVS entries consumed, 32 bytes each
+	uint16_t pages; // flash pages written into
+};
+
+/****************************
+ * Blob Functions
+****************************/
+
+/**
+ * Writes raw bytes to NVM
+ *
+ * @param key key to write
+ * @param value bytes to write
+ * @param length amount of bytes
+ *
+ * @return if write was successful
+ */
+bool nvmWriteBlob(nvm_size_t key, const void* value, size_t length);
+
+/**
+ * Gets raw bytes from NVM
+ *
+ * @param key key to read
+ * @param value storage for bytes
+ * @param length pointer to storage size, changed to amount of bytes read
+ *
+ * @return if read was successful
+ */
+bool nvmGetBlob(nvm_size_t key, void* value, size_t *length);
+
+/****************************
+ * Telemetry Functions
+ *
+ * Counters and latencies are kept since
+ * boot or reset, entries written is kept
+ * in the config record over life of flash
+****************************/
+
+/**
+ * Gets NVM counters, latencies and flash usage
+ *
+ * @param stats pointer to store telemetry
+ *
+ * @note ESP32 flash is rated for about 100000 erase cycles
+ *
+ * @return if flash usage was read, counters are stored regardless
+ */
+bool nvmGetTelemetry(struct nvmTelemetry *stats);
+
+/**
+ * Clears counters and latencies
+ *
+ * @note entries written over life of flash is kept
+ */
+void nvmResetTelemetry(void);
+
+/**
+ * Prints NVM telemetry and latency histograms
+ *
+ * @return if flash usage was printed
+ */
+bool nvmDumpTelemetry(void);
+
+/****************************
+ * Default Functions
+****************************/
+
+/**
+ * Sets defaults like 'nvmSetDefaults', rewriting only values that differ
+ *
+ * @param stats pointer to store keys rewritten and time taken, can be NULL
+ *
+ * @note every default, strings and blobs too, is compared against the
+ * stored value, differences land with one commit
+ * @note erases NVM like 'nvmSetDefaults' only when the config record
+ * is damaged or writing defaults fails
+ * @note holds NVM alone throughout, other tasks wait or turn busy
+ * @note 'nvmSetDefaults' uses this when NVM_INCREMENTAL_DEFAULTS is defined
+ *
+ * @return result of setting defaults, NVM_DEFAULT_BUSY if NVM
+ * stayed busy and nothing was changed
+ */
+enum NVMDefaultCode nvmSetDefaultsIncremental(struct nvmDefaultStats *stats);
+
+/****************************
+ * Lock Functions
+ *
+ * Reads share NVM, writes hold it alone,
+ * calls wait up to NVM_LOCK_WAIT_MS
+ * for other holders
+****************************/
+
+/**
+ * Tells why last failed NVM call of this task failed
+ *
+ * @note set by every call that takes the lock
+ *
+ * @return true if call gave up waiting for lock and can be retried,
+ * false if NVM itself failed
+ */
+bool nvmWasBusy(void);
+
+/****************************
+ * Cache Functions
+ *
+ * Number values are kept in a RAM cache,
+ * writes are committed together after
+ * NVM_COMMIT_DELAY_MS or on flush
+ *
+ * Cached values are stored as one versioned,
+ * CRC checked record, read once at nvmInit,
+ * changed values are committed under their
+ * own keys until NVM_JOURNAL_SIZE of them
+ * build up, then folded into the record
+ *
+ * Values under older per key storage move
+ * into the record with its next rewrite
+****************************/
+
+/**
+ * Commits cached writes to flash now
+ *
+ * @note call before power loss or reset to keep recent writes
+ * @note waits up to NVM_ASYNC_FLUSH_MS for queued async writes first
+ *
+ * @return if every cached and queued write was committed,
+ * 'nvmWasBusy' if queued writes did not land in time
+ */
+bool nvmFlush(void);
+
+/****************************
+ * Batch Functions
+ *
+ * Number writes between begin and commit
+ * are staged in RAM and land together
+ * with a single commit
+****************************/
+
+/**
+ * Starts batch of number writes
+ *
+ * @note calling task holds NVM until commit or abort,
+ * its number writes and reads skip the per call lock
+ * @note other tasks' NVM calls wait, then fail busy while batch is open
+ * @note string and blob writes inside a batch commit on their own
+ *
+ * @return if batch was started
+ */
+bool nvmBeginBatch(void);
+
+/**
+ * Writes staged values and commits them once
+ *
+ * @param stats pointer to store flash usage of batch, can be NULL
+ *
+ * @note also commits writes cached before the batch
+ * @note pages are estimated from NVS free entries
+ *
+ * @return if every staged value was committed
+ */
+bool nvmCommitBatch(struct nvmBatchStats *stats);
+
+/**
+ * Drops staged values and ends batch
+ *
+ * @return if batch was ended
+ */
+bool nvmAbortBatch(void);
+
+/****************************
+ * Async Functions
+ *
+ * Writes are queued without blocking, a writer
+ * task on NVM_ASYNC_CORE drains the queue,
+ * keeps the last write of each key and
+ * commits them together
+****************************/
+
+/**
+ * Starts async writer task
+ *
+ * @return if writer was started
+ */
+bool nvmAsyncStart(void);
+
+/**
+ * Lands queued writes and stops async writer task
+ *
+ * @return if writer was stopped
+ */
+bool nvmAsyncStop(void);
+
+/**
+ * Waits for async write to be done
+ *
+ * @param handle handle passed with write
+ * @param waitMS max time to wait
+ *
+ * @return state of write, NVM_ASYNC_PENDING if wait ran out
+ */
+enum NVMAsyncState nvmAsyncWait(nvm_async_t *handle, uint32_t waitMS);
+
+/**
+ * Queues value to write like 'nvmWriteBool'
+ *
+ * @param key key to write
+ * @param value value to write
+ * @param handle completion of write, can be NULL
+ *
+ * @note never blocks, handle must stay valid until done
+ * @note a later write of the same key may replace value,
+ * handle then completes with the later write
+ *
+ * @return if write was queued, false and 'nvmWasBusy' if queue is full
+ */
+bool nvmWriteBoolAsync(nvm_size_t key, bool value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteI8'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteI8Async(nvm_size_t key, int8_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteUI8'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteUI8Async(nvm_size_t key, uint8_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteI16'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteI16Async(nvm_size_t key, int16_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteUI16'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteUI16Async(nvm_size_t key, uint16_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteI32'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteI32Async(nvm_size_t key, int32_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteUI32'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteUI32Async(nvm_size_t key, uint32_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteI64'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteI64Async(nvm_size_t key, int64_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteUI64'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteUI64Async(nvm_size_t key, uint64_t value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteFloat'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteFloatAsync(nvm_size_t key, float value, nvm_async_t *handle);
+
+/**
+ * Queues value to write like 'nvmWriteDouble'
+ *
+ * @note see 'nvmWriteBoolAsync'
+ */
+bool nvmWriteDoubleAsync(nvm_size_t key, double value, nvm_async_t *handle);
+
+#endif
+#endif
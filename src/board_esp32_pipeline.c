@@ -0,0 +1,263 @@
+/*
+	board_esp32_pipeline.c - dual core sample pipeline for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_pipeline.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_timer.h>
+
+#define PIPELINE_STACK 4096U // stack size of each pipeline task
+#define PIPELINE_TASKS 3U // acquire, process and transport
+
+static sample_ring_t acquireRing; // acquire -> process
+static sample_ring_t transportRing; // process -> transport
+static struct pipelineConfig pipeline;
+
+static TaskHandle_t acquireTask = NULL;
+static TaskHandle_t processTask = NULL;
+static TaskHandle_t transportTask = NULL;
+static SemaphoreHandle_t stagesStopped = NULL; // given once by each exiting task
+
+static volatile bool pipelineRunning = false;
+static volatile uint32_t processedCount = 0U;
+static volatile uint32_t transportedCount = 0U;
+static int64_t pipelineStartUS = 0;
+
+/**
+ * Runs acquisition hooks on ACQUIRE_CORE
+ *
+ * @param params unused
+ */
+static void pipelineAcquireTask(void *params) {
+
+	if (pipeline.start != NULL) {
+		pipeline.start(&acquireRing, pipeline.context);
+	}
+
+	TickType_t blocked = xTaskGetTickCount();
+
+	while (pipelineRunning) {
+		if (pipeline.poll != NULL && pipeline.poll(&acquireRing, pipeline.context)) {
+			xTaskNotifyGive(processTask);
+
+			// yield does not reach IDLE, so block a tick now and then
+			if (xTaskGetTickCount() - blocked < pdMS_TO_TICKS(PIPELINE_POLL_MS)) {
+				continue;
+			}
+			ulTaskNotifyTake(pdTRUE, 1U);
+		}
+		else {
+			// ISRs fill ring, only wakes to stop
+			ulTaskNotifyTake(pdTRUE, (pipeline.poll == NULL) ? portMAX_DELAY : pdMS_TO_TICKS(PIPELINE_IDLE_MS));
+		}
+		blocked = xTaskGetTickCount();
+	}
+
+	if (pipeline.stop != NULL) {
+		pipeline.stop(&acquireRing, pipeline.context);
+	}
+
+	xSemaphoreGive(stagesStopped);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Drains acquisition ring through process stage on PROCESS_CORE
+ *
+ * @param params unused
+ */
+static void pipelineProcessTask(void *params) {
+
+	while (pipelineRunning) {
+		ring_item_t *span;
+		uint32_t count = sampleRingPeek(&acquireRing, &span);
+		uint32_t used = 0U;
+
+		if (count > 0U) {
+			used = pipeline.process(span, count, &transportRing, pipeline.context);
+			sampleRingConsume(&acquireRing, used);
+			processedCount += used;
+
+			if (sampleRingCount(&transportRing) > 0U) {
+				xTaskNotifyGive(transportTask);
+			}
+		}
+		if (used == 0U) {
+			// no data or transport is full
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PIPELINE_IDLE_MS));
+		}
+	}
+
+	xSemaphoreGive(stagesStopped);
+	vTaskDelete(NULL);
+}
+
+/**
+ * Drains transport ring through transport stage on PROCESS_CORE
+ *
+ * @param params unused
+ */
+static void pipelineTransportTask(void *params) {
+
+	while (pipelineRunning) {
+		ring_item_t *span;
+		uint32_t count = sampleRingPeek(&transportRing, &span);
+		uint32_t sent = 0U;
+
+		if (count > 0U) {
+			sent = pipeline.transport(span, count, pipeline.context);
+			sampleRingConsume(&transportRing, sent);
+			transportedCount += sent;
+
+			// process may be waiting for room in transport ring
+			if (sent > 0U) {
+				xTaskNotifyGive(processTask);
+			}
+		}
+		if (sent == 0U) {
+			ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PIPELINE_IDLE_MS));
+		}
+	}
+
+	xSemaphoreGive(stagesStopped);
+	vTaskDelete(NULL);
+}
+
+bool pipelineStart(const struct pipelineConfig *config) {
+
+	if (config == NULL || pipelineRunning) {
+		return false;
+	}
+	if (config -> process == NULL || config -> transport == NULL) {
+		return false;
+	}
+	if (!sampleRingInit(&acquireRing, config -> acquireStorage, config -> acquireSize)) {
+		return false;
+	}
+	if (!sampleRingInit(&transportRing, config -> transportStorage, config -> transportSize)) {
+		return false;
+	}
+
+	if (stagesStopped == NULL) {
+		stagesStopped = xSemaphoreCreateCounting(PIPELINE_TASKS, 0U);
+		if (stagesStopped == NULL) {
+			return false;
+		}
+	}
+
+	pipeline = *config;
+	processedCount = 0U;
+	transportedCount = 0U;
+	pipelineStartUS = esp_timer_get_time();
+	pipelineRunning = true;
+
+	// consumers first so acquisition always has someone to wake
+	uint8_t started = 0U;
+	if (xTaskCreatePinnedToCore(pipelineTransportTask, "pipeTransport", PIPELINE_STACK, NULL, PIPELINE_PRIORITY, &transportTask, PROCESS_CORE) == pdPASS) {
+		started++;
+		if (xTaskCreatePinnedToCore(pipelineProcessTask, "pipeProcess", PIPELINE_STACK, NULL, PIPELINE_PRIORITY, &processTask, PROCESS_CORE) == pdPASS) {
+			started++;
+			if (xTaskCreatePinnedToCore(pipelineAcquireTask, "pipeAcquire", PIPELINE_STACK, NULL, PIPELINE_PRIORITY, &acquireTask, ACQUIRE_CORE) == pdPASS) {
+				started++;
+			}
+		}
+	}
+
+	if (started != PIPELINE_TASKS) {
+		pipelineRunning = false;
+		if (started >= 2U) {
+			xTaskNotifyGive(processTask);
+		}
+		if (started >= 1U) {
+			xTaskNotifyGive(transportTask);
+		}
+		for (uint8_t i = 0U; i < started; i++) {
+			xSemaphoreTake(stagesStopped, portMAX_DELAY);
+		}
+		return false;
+	}
+
+	return true;
+}
+
+bool pipelineStop(void) {
+
+	if (!pipelineRunning) {
+		return false;
+	}
+
+	pipelineRunning = false;
+	xTaskNotifyGive(acquireTask);
+	xTaskNotifyGive(processTask);
+	xTaskNotifyGive(transportTask);
+
+	for (uint8_t i = 0U; i < PIPELINE_TASKS; i++) {
+		xSemaphoreTake(stagesStopped, portMAX_DELAY);
+	}
+
+	acquireTask = NULL;
+	processTask = NULL;
+	transportTask = NULL;
+
+	return true;
+}
+
+sample_ring_t* pipelineAcquireRing(void) {
+
+	if (!pipelineRunning) {
+		return NULL;
+	}
+	return &acquireRing;
+}
+
+void RUN_IN_RAM(pipelineWakeFromISR) pipelineWakeFromISR(void) {
+
+	if (processTask == NULL) {
+		return;
+	}
+
+	BaseType_t woken = pdFALSE;
+	vTaskNotifyGiveFromISR(processTask, &woken);
+	if (woken == pdTRUE) {
+		portYIELD_FROM_ISR();
+	}
+}
+
+void pipelineGetStats(struct pipelineStats *stats) {
+
+	if (stats == NULL) {
+		return;
+	}
+
+	stats -> acquired = acquireRing.head;
+	stats -> processed = processedCount;
+	stats -> transported = transportedCount;
+	stats -> acquireDropped = sampleRingDropped(&acquireRing);
+	stats -> processDropped = sampleRingDropped(&transportRing);
+	stats -> acquireHighWater = sampleRingHighWater(&acquireRing);
+	stats -> transportHighWater = sampleRingHighWater(&transportRing);
+	stats -> elapsedUS = (pipelineStartUS == 0) ? 0U : (uint64_t)(esp_timer_get_time() - pipelineStartUS);
+}
+
+#endif
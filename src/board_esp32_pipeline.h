@@ -0,0 +1,135 @@
+/*
+	board_esp32_pipeline.h - dual core sample pipeline for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_PIPELINE_H
+#define BOARD_ESP32_PIPELINE_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_ring.h"
+
+/****************************
+ * Pipeline Types
+ *
+ * acquire (ACQUIRE_CORE) -> ring -> process (PROCESS_CORE) -> ring -> transport (PROCESS_CORE)
+****************************/
+
+/**
+ * Runs once on ACQUIRE_CORE when pipeline starts or stops
+ *
+ * @note timers set here get their ISR allocated on ACQUIRE_CORE
+ */
+typedef void (*pipeline_hook_t)(sample_ring_t *out, void *context);
+
+/**
+ * Runs repeatedly on ACQUIRE_CORE, pushes samples into out
+ *
+ * @note acquisition blocks a tick every PIPELINE_POLL_MS even while
+ * data keeps coming, so IDLE on ACQUIRE_CORE feeds the task watchdog
+ *
+ * @return if more data may follow right away
+ */
+typedef bool (*pipeline_poll_t)(sample_ring_t *out, void *context);
+
+/**
+ * Processes contiguous span of acquired samples
+ *
+ * @return amount of input items consumed
+ */
+typedef uint32_t (*pipeline_process_t)(const ring_item_t *items, uint32_t count, sample_ring_t *out, void *context);
+
+/**
+ * Sends contiguous span of processed items
+ *
+ * @return amount of items sent
+ */
+typedef uint32_t (*pipeline_transport_t)(const ring_item_t *items, uint32_t count, void *context);
+
+struct pipelineConfig {
+	pipeline_hook_t start; // acquisition start, can be NULL
+	pipeline_poll_t poll; // acquisition loop, can be NULL when ISRs push samples
+	pipeline_hook_t stop; // acquisition stop, can be NULL
+	pipeline_process_t process; // processing stage
+	pipeline_transport_t transport; // transport stage
+	void *context; // user data given to every stage
+	ring_item_t *acquireStorage; // storage between acquire and process
+	uint32_t acquireSize; // power of two item count
+	ring_item_t *transportStorage; // storage between process and transport
+	uint32_t transportSize; // power of two item count
+};
+
+struct pipelineStats {
+	uint32_t acquired; // items pushed by acquisition
+	uint32_t processed; // items consumed by processing
+	uint32_t transported; // items sent by transport
+	uint32_t acquireDropped; // items lost while processing was behind
+	uint32_t processDropped; // items lost while transport was behind
+	uint32_t acquireHighWater; // most items waiting for processing
+	uint32_t transportHighWater; // most items waiting for transport
+	uint64_t elapsedUS; // time since pipeline start
+};
+
+/****************************
+ * Pipeline Functions
+****************************/
+
+/**
+ * Starts pipeline tasks on their cores
+ *
+ * @param config pipeline stages and storage
+ *
+ * @return if pipeline was started
+ */
+bool pipelineStart(const struct pipelineConfig *config);
+
+/**
+ * Stops pipeline, running stop hook on ACQUIRE_CORE
+ *
+ * @return if pipeline was stopped
+ */
+bool pipelineStop(void);
+
+/**
+ * Gets ring acquisition pushes samples into
+ *
+ * @note push only from ACQUIRE_CORE (ISR or poll)
+ *
+ * @return acquisition ring, NULL if not started
+ */
+sample_ring_t* pipelineAcquireRing(void);
+
+/**
+ * Wakes processing task after pushing a batch
+ *
+ * @note safe inside timer ISR
+ */
+void pipelineWakeFromISR(void);
+
+/**
+ * Gets per stage counters
+ *
+ * @param stats pointer to store counters
+ *
+ * @note items / elapsedUS gives each stage throughput
+ */
+void pipelineGetStats(struct pipelineStats *stats);
+
+#endif
+#endif
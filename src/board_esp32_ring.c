@@ -0,0 +1,151 @@
+/*
+	board_esp32_ring.c - lock-free sample ring for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_ring.h"
+
+/**
+ * Loads counter written by the other side of the ring
+ *
+ * @param counter counter to load
+ *
+ * @note acquire pairs with 'RING_STORE' so items are visible before counter
+ */
+#define RING_LOAD(counter) __atomic_load_n(&(counter), __ATOMIC_ACQUIRE)
+
+/**
+ * Stores counter read by the other side of the ring
+ *
+ * @param counter counter to store
+ * @param value new counter value
+ */
+#define RING_STORE(counter, value) __atomic_store_n(&(counter), (value), __ATOMIC_RELEASE)
+
+bool sampleRingInit(sample_ring_t *ring, ring_item_t *items, uint32_t size) {
+
+	if (ring == NULL || items == NULL) {
+		return false;
+	}
+	if (size == 0U || (size & (size - 1U)) != 0U) {
+		return false;
+	}
+
+	ring -> items = items;
+	ring -> mask = size - 1U;
+	ring -> head = 0U;
+	ring -> tail = 0U;
+	ring -> highWater = 0U;
+	ring -> dropped = 0U;
+
+	return true;
+}
+
+bool RUN_IN_RAM(sampleRingPush) sampleRingPush(sample_ring_t *ring, ring_item_t item) {
+
+	uint32_t head = ring -> head;
+	uint32_t count = head - RING_LOAD(ring -> tail);
+
+	if (count > ring -> mask) {
+		ring -> dropped++;
+		return false;
+	}
+
+	ring -> items[head & ring -> mask] = item;
+	RING_STORE(ring -> head, head + 1U);
+
+	if (count + 1U > ring -> highWater) {
+		ring -> highWater = count + 1U;
+	}
+
+	return true;
+}
+
+uint32_t RUN_IN_RAM(sampleRingPop) sampleRingPop(sample_ring_t *ring, ring_item_t *dest, uint32_t maxItems) {
+
+	if (dest == NULL) {
+		return 0U;
+	}
+
+	uint32_t popped = 0U;
+
+	// at most two spans when items wrap around storage
+	while (popped < maxItems) {
+		ring_item_t *span;
+		uint32_t spanCount = sampleRingPeek(ring, &span);
+		if (spanCount == 0U) {
+			break;
+		}
+		if (spanCount > maxItems - popped) {
+			spanCount = maxItems - popped;
+		}
+
+		for (uint32_t i = 0U; i < spanCount; i++) {
+			dest[popped + i] = span[i];
+		}
+		popped += sampleRingConsume(ring, spanCount);
+	}
+
+	return popped;
+}
+
+uint32_t RUN_IN_RAM(sampleRingPeek) sampleRingPeek(sample_ring_t *ring, ring_item_t **span) {
+
+	if (span == NULL) {
+		return 0U;
+	}
+
+	uint32_t tail = ring -> tail;
+	uint32_t count = RING_LOAD(ring -> head) - tail;
+	uint32_t start = tail & ring -> mask;
+	uint32_t untilWrap = ring -> mask + 1U - start;
+
+	*span = &ring -> items[start];
+
+	return (count < untilWrap) ? count : untilWrap;
+}
+
+uint32_t RUN_IN_RAM(sampleRingConsume) sampleRingConsume(sample_ring_t *ring, uint32_t count) {
+
+	uint32_t tail = ring -> tail;
+	uint32_t stored = RING_LOAD(ring -> head) - tail;
+
+	if (count > stored) {
+		count = stored;
+	}
+
+	RING_STORE(ring -> tail, tail + count);
+
+	return count;
+}
+
+uint32_t sampleRingCount(sample_ring_t *ring) {
+	return RING_LOAD(ring -> head) - RING_LOAD(ring -> tail);
+}
+
+uint32_t sampleRingHighWater(sample_ring_t *ring) {
+	return ring -> highWater;
+}
+
+uint32_t sampleRingDropped(sample_ring_t *ring) {
+	return ring -> dropped;
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+	board_esp32_ring.h - lock-free sample ring for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_RING_H
+#define BOARD_ESP32_RING_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "../../board_common.h"
+
+/****************************
+ * Ring Types
+ *
+ * Single producer (timer ISR) and single
+ * consumer (task), no locks are taken
+****************************/
+
+typedef uint16_t ring_item_t; // item type stored in ring
+
+typedef struct sample_ring_s {
+	// producer line
+	volatile uint32_t head __attribute__((aligned(CACHE_LINE_SIZE))); // items pushed since init
+	uint32_t highWater; // most items ever stored at once
+	uint32_t dropped; // pushes refused while full
+
+	// consumer line
+	volatile uint32_t tail __attribute__((aligned(CACHE_LINE_SIZE))); // items popped since init
+
+	// shared read only line
+	ring_item_t *items __attribute__((aligned(CACHE_LINE_SIZE))); // item storage
+	uint32_t mask; // size - 1
+} sample_ring_t;
+
+/****************************
+ * Ring Functions
+****************************/
+
+/**
+ * Sets up ring over user storage
+ *
+ * @param ring ring to set up
+ * @param items storage for items
+ * @param size amount of items in storage
+ *
+ * @warning size must be a power of two
+ *
+ * @return if ring was set up
+ */
+bool sampleRingInit(sample_ring_t *ring, ring_item_t *items, uint32_t size);
+
+/**
+ * Pushes item into ring
+ *
+ * @param ring ring to push to
+ * @param item item to push
+ *
+ * @note producer only, safe inside timer ISR
+ *
+ * @return if item was stored, false if ring full
+ */
+bool sampleRingPush(sample_ring_t *ring, ring_item_t item);
+
+/**
+ * Pops up to maxItems items out of ring
+ *
+ * @param ring ring to pop from
+ * @param dest storage for popped items
+ * @param maxItems max amount of items to pop
+ *
+ * @note consumer only
+ *
+ * @return amount of items popped
+ */
+uint32_t sampleRingPop(sample_ring_t *ring, ring_item_t *dest, uint32_t maxItems);
+
+/**
+ * Gets oldest contiguous span of items without copying
+ *
+ * @param ring ring to peek
+ * @param span pointer to store start of span
+ *
+ * @note consumer only, span stays valid until 'sampleRingConsume'
+ * @note call again after consuming to get wrapped items
+ *
+ * @return amount of items in span
+ */
+uint32_t sampleRingPeek(sample_ring_t *ring, ring_item_t **span);
+
+/**
+ * Frees items read through 'sampleRingPeek'
+ *
+ * @param ring ring to consume from
+ * @param count amount of items to free
+ *
+ * @note consumer only
+ *
+ * @return amount of items freed
+ */
+uint32_t sampleRingConsume(sample_ring_t *ring, uint32_t count);
+
+/**
+ * Gets amount of items stored in ring
+ *
+ * @param ring ring to check
+ *
+ * @return amount of items stored
+ */
+uint32_t sampleRingCount(sample_ring_t *ring);
+
+/**
+ * Gets most items ever stored in ring at once
+ *
+ * @param ring ring to check
+ *
+ * @return high water mark
+ */
+uint32_t sampleRingHighWater(sample_ring_t *ring);
+
+/**
+ * Gets amount of pushes refused while ring was full
+ *
+ * @param ring ring to check
+ *
+ * @return dropped item count
+ */
+uint32_t sampleRingDropped(sample_ring_t *ring);
+
+#endif
+#endif
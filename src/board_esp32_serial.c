@@ -20,12 +20,352 @@
 
 #if defined(ESP32DEVC) && defined(SERIAL_PRINTF)
 
+#include "../../board_common.h"
 #include "../../comm/hard_serial/hard_serial.h"
+#include "board_esp32_frame.h"
 
+#include <string.h>
 #include <driver/uart.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+
+#define SERIAL_PORT UART_NUM_0 // UART wired to USB bridge
+#define SERIAL_BITS_PER_BYTE 10U // start, 8 data and stop bits
+#define SERIAL_SETTLE_MS 2U // time for both sides to switch baud
+#define SERIAL_CONTROL_SIZE 5U // op and LE32 value
+
+static uint8_t frameSeq = 0U; // sequence of next frame
+static SemaphoreHandle_t frameLock = NULL; // held while a frame is built and written
+static uint8_t frameBuffer[FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE]; // frame being written
+static struct serialFrameStats frameStats;
+static struct serialLinkStats linkStats;
+
+// bauds tried from fastest, all divide APB_CLK cleanly enough for host bridges
+static const uint32_t linkBauds[] = {
+	5000000U, 4000000U, 3000000U, 2000000U, 1500000U, 1000000U, 921600U, 460800U,
+};
 
 void hardPrintBegin(uint32_t baud) {
-	uart_set_baudrate(UART_NUM_0, BAUD_RATE);
+	#ifdef SERIAL_NEGOTIATE
+		serialLinkNegotiate(baud, SERIAL_BAUD_MAX);
+	#else
+		uart_set_baudrate(SERIAL_PORT, baud);
+		linkStats.baud = baud;
+	#endif
+}
+
+bool serialFrameBegin(uint32_t baud) {
+
+	if (frameLock == NULL) {
+		frameLock = xSemaphoreCreateMutex();
+		if (frameLock == NULL) {
+			return false;
+		}
+	}
+	if (!uart_is_driver_installed(SERIAL_PORT)) {
+		if (uart_driver_install(SERIAL_PORT, SERIAL_RX_BUFFER_SIZE, SERIAL_TX_BUFFER_SIZE, 0, NULL, 0) != ESP_OK) {
+			return false;
+		}
+	}
+	if (uart_set_baudrate(SERIAL_PORT, baud) != ESP_OK) {
+		return false;
+	}
+
+	frameSeq = 0U;
+	linkStats.baud = baud;
+	linkStats.bytesPerSec = 0U;
+	frameStats.sent = 0U;
+	frameStats.dropped = 0U;
+	frameStats.bytes = 0U;
+
+	return true;
+}
+
+/**
+ * Builds frame in one buffer
+ *
+ * @param buffer storage of frame, header plus payload plus CRC
+ * @param type frame type
+ * @param seq frame sequence
+ * @param payload payload bytes
+ * @param length payload bytes
+ */
+static void serialFrameBuild(uint8_t *buffer, uint8_t type, uint8_t seq, const void *payload, uint16_t length) {
+
+	uint16_t crc = frameBuildHeader(buffer, type, seq, length);
+	if (length > 0U) {
+		memcpy(&buffer[FRAME_HEADER_SIZE], payload, length);
+		crc = frameCRC16(crc, payload, length);
+	}
+	buffer[FRAME_HEADER_SIZE + length] = crc & ONE_BYTE;
+	buffer[FRAME_HEADER_SIZE + length + 1U] = crc >> 8;
+}
+
+/**
+ * Builds frame in one buffer and writes it to TX buffer
+ *
+ * @param type frame type
+ * @param payload payload bytes
+ * @param length payload bytes
+ * @param wait whether to wait for TX space, else frame is dropped when full or locked
+ *
+ * @note one UART write per frame, so text or other tasks can not split it
+ * @note waiting frames are built apart and written without the lock,
+ * only negotiation sends them, from one task
+ *
+ * @return if frame was written
+ */
+static bool serialFrameWrite(uint8_t type, const void *payload, uint16_t length, bool wait) {
+
+	if (frameLock == NULL) {
+		return false;
+	}
+
+	size_t frameSize = FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE;
+
+	if (wait) {
+		static uint8_t waitBuffer[FRAME_HEADER_SIZE + FRAME_MAX_PAYLOAD + FRAME_CRC_SIZE];
+
+		xSemaphoreTake(frameLock, portMAX_DELAY);
+		uint8_t seq = __atomic_fetch_add(&frameSeq, 1U, __ATOMIC_RELAXED);
+		frameStats.sent++;
+		frameStats.bytes += frameSize;
+		xSemaphoreGive(frameLock);
+
+		serialFrameBuild(waitBuffer, type, seq, payload, length);
+		uart_write_bytes(SERIAL_PORT, waitBuffer, frameSize);
+		return true;
+	}
+
+	// another task writing drops the frame rather than waiting
+	if (xSemaphoreTake(frameLock, 0) != pdTRUE) {
+		__atomic_add_fetch(&frameStats.dropped, 1U, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&frameSeq, 1U, __ATOMIC_RELAXED);
+		return false;
+	}
+
+	// ring buffer space is checked under lock so the write never waits on the FIFO
+	size_t freeSize = 0U;
+	if (uart_get_tx_buffer_free_size(SERIAL_PORT, &freeSize) != ESP_OK || freeSize < frameSize) {
+		__atomic_add_fetch(&frameStats.dropped, 1U, __ATOMIC_RELAXED);
+		__atomic_add_fetch(&frameSeq, 1U, __ATOMIC_RELAXED);
+		xSemaphoreGive(frameLock);
+		return false;
+	}
+
+	serialFrameBuild(frameBuffer, type, __atomic_fetch_add(&frameSeq, 1U, __ATOMIC_RELAXED), payload, length);
+	uart_write_bytes(SERIAL_PORT, frameBuffer, frameSize);
+
+	frameStats.sent++;
+	frameStats.bytes += frameSize;
+
+	xSemaphoreGive(frameLock);
+	return true;
+}
+
+bool serialFrameSend(uint8_t type, const void *payload, uint16_t length) {
+
+	if (length > FRAME_MAX_PAYLOAD || (payload == NULL && length > 0U)) {
+		return false;
+	}
+
+	return serialFrameWrite(type, payload, length, false);
+}
+
+void serialFrameGetStats(struct serialFrameStats *stats) {
+
+	if (stats == NULL) {
+		return;
+	}
+
+	*stats = frameStats;
+}
+
+/**
+ * Sends control frame with value
+ *
+ * @param op control op from FrameControl
+ * @param value value sent after op
+ */
+static void serialLinkSend(uint8_t op, uint32_t value) {
+
+	uint8_t payload[SERIAL_CONTROL_SIZE] = {
+		op, value & ONE_BYTE, (value >> 8) & ONE_BYTE, (value >> 16) & ONE_BYTE, value >> 24,
+	};
+
+	serialFrameWrite(FRAME_CONTROL, payload, SERIAL_CONTROL_SIZE, true);
+}
+
+/**
+ * Waits for control frame from host
+ *
+ * @param op control op to wait for
+ * @param value pointer to store value after op
+ *
+ * @note other frames received meanwhile are dropped
+ *
+ * @return if frame arrived within SERIAL_LINK_WAIT_MS
+ */
+static bool serialLinkReceive(uint8_t op, uint32_t *value) {
+
+	uint8_t payload[SERIAL_CONTROL_SIZE];
+	frame_decoder_t decoder;
+	frameDecoderInit(&decoder, payload, SERIAL_CONTROL_SIZE);
+
+	int64_t deadline = esp_timer_get_time() + (int64_t)SERIAL_LINK_WAIT_MS * 1000;
+	uint8_t byte;
+
+	while (esp_timer_get_time() < deadline) {
+		if (uart_read_bytes(SERIAL_PORT, &byte, 1U, pdMS_TO_TICKS(SERIAL_SETTLE_MS)) != 1) {
+			continue;
+		}
+		if (frameDecodeByte(&decoder, byte) != FRAME_DECODE_READY) {
+			continue;
+		}
+		if (decoder.type != FRAME_CONTROL || decoder.length < 1U || payload[0] != op) {
+			continue;
+		}
+
+		*value = 0U;
+		for (uint16_t i = decoder.length - 1U; i > 0U; i--) {
+			*value = (*value << 8) | payload[i];
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Switches both ends to baud once TX is drained
+ *
+ * @param baud baud to switch to
+ */
+static void serialLinkSwitch(uint32_t baud) {
+
+	uart_wait_tx_done(SERIAL_PORT, pdMS_TO_TICKS(SERIAL_LINK_WAIT_MS));
+	uart_set_baudrate(SERIAL_PORT, baud);
+	vTaskDelay(pdMS_TO_TICKS(SERIAL_SETTLE_MS));
+	uart_flush_input(SERIAL_PORT);
+}
+
+/**
+ * Checks test pattern at current baud
+ *
+ * @return if host received pattern intact
+ */
+static bool serialLinkCheckPattern(void) {
+
+	static uint8_t pattern[SERIAL_PATTERN_SIZE];
+
+	// alternating and walking bits catch both timing and framing errors
+	pattern[0] = FRAME_CONTROL_PATTERN;
+	for (uint16_t i = 1U; i < SERIAL_PATTERN_SIZE; i++) {
+		pattern[i] = (i & 1U) ? 0x55U : (uint8_t)(1U << ((i >> 1) & 7U));
+	}
+	serialFrameWrite(FRAME_CONTROL, pattern, SERIAL_PATTERN_SIZE, true);
+
+	uint32_t result;
+	return serialLinkReceive(FRAME_CONTROL_PATTERN_RESULT, &result) && result == 1U;
+}
+
+/**
+ * Measures sustained bytes per second at current baud
+ *
+ * @return measured rate
+ */
+static uint32_t serialLinkMeasure(void) {
+
+	static uint8_t fill[FRAME_MAX_PAYLOAD];
+	fill[0] = FRAME_CONTROL_FILL;
+
+	uart_wait_tx_done(SERIAL_PORT, pdMS_TO_TICKS(SERIAL_LINK_WAIT_MS));
+	uint32_t start = frameStats.bytes;
+	int64_t startUS = esp_timer_get_time();
+
+	while (frameStats.bytes - start < SERIAL_MEASURE_SIZE) {
+		serialFrameWrite(FRAME_CONTROL, fill, FRAME_MAX_PAYLOAD, true);
+	}
+	uart_wait_tx_done(SERIAL_PORT, portMAX_DELAY);
+
+	int64_t elapsedUS = esp_timer_get_time() - startUS;
+	if (elapsedUS <= 0) {
+		return 0U;
+	}
+
+	return (uint64_t)(frameStats.bytes - start) * 1000000U / (uint64_t)elapsedUS;
+}
+
+uint32_t serialLinkNegotiate(uint32_t baud, uint32_t maxBaud) {
+
+	if (!serialFrameBegin(baud)) {
+		// no frames without the driver, link still runs at baud
+		uart_set_baudrate(SERIAL_PORT, baud);
+		linkStats.baud = baud;
+		return baud;
+	}
+
+	bool hostSeen = false;
+	linkStats.attempts = 0U;
+	linkStats.fallbacks = 0U;
+
+	for (uint8_t i = 0U; i < sizeof(linkBauds) / sizeof(linkBauds[0]); i++) {
+		uint32_t candidate = linkBauds[i];
+		if (candidate > maxBaud || candidate <= baud) {
+			continue;
+		}
+
+		linkStats.attempts++;
+		uint32_t accepted;
+		serialLinkSend(FRAME_CONTROL_BAUD_PROPOSE, candidate);
+		if (!serialLinkReceive(FRAME_CONTROL_BAUD_ACCEPT, &accepted)) {
+			// no host tool listening
+			break;
+		}
+		hostSeen = true;
+		if (accepted != candidate) {
+			continue;
+		}
+
+		serialLinkSwitch(candidate);
+		if (serialLinkCheckPattern()) {
+			linkStats.baud = candidate;
+			break;
+		}
+
+		// host returns to old baud after its own timeout
+		linkStats.fallbacks++;
+		serialLinkSwitch(baud);
+		vTaskDelay(pdMS_TO_TICKS(SERIAL_LINK_WAIT_MS));
+		uart_flush_input(SERIAL_PORT);
+	}
+
+	// filler would only slow boot when nobody reads it
+	if (hostSeen) {
+		linkStats.bytesPerSec = serialLinkMeasure();
+	}
+
+	return linkStats.baud;
+}
+
+uint32_t serialLinkGetRate(void) {
+
+	if (linkStats.bytesPerSec != 0U) {
+		return linkStats.bytesPerSec;
+	}
+
+	return linkStats.baud / SERIAL_BITS_PER_BYTE;
+}
+
+void serialLinkGetStats(struct serialLinkStats *stats) {
+
+	if (stats == NULL) {
+		return;
+	}
+
+	*stats = linkStats;
 }
 
 #endif
\ No newline at end of file
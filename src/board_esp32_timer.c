@@ -21,6 +21,7 @@
 #ifdef ESP32DEVC
 
 #include "../../hard_timer.h"
+#include "board_esp32_timer.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -28,12 +29,25 @@
 #include <freertos/timers.h>
 #include <driver/timer.h>
 #include <esp_intr_alloc.h>
+#include <esp_ipc.h>
+#include <soc/soc.h>
+#include <soc/timer_group_reg.h>
+#include <rom/ets_sys.h>
+#include <xtensa/hal.h>
+
+#ifdef HARD_TIMER_LATENCY
+	#include <stdio.h>
+	#include <string.h>
+#endif
 
 #define TIMER_COUNT_ZERO 0U // value for setting timer tick count to 0
-#define SCALAR_MAX UINT16_MAX // max value for timer scalar
+#define TIMER_BIT(timer) (1UL << (timer)) // bit of timer in allocation bitmaps
 
-typedef uint16_t prescalar_t; // pre scalar type
-typedef uint64_t timertick_t; // timer tick type
+#ifdef HARD_TIMER_RAW_ISR
+	#define TIMER_RAW_DEFAULT true // ISR mode of setters not choosing one
+#else
+	#define TIMER_RAW_DEFAULT false // ISR mode of setters not choosing one
+#endif
 
 typedef struct hw_timer_s {
 	uint8_t group; // timer group
@@ -48,7 +62,46 @@ static hard_timer_group_t timerGroups[4] = {
 	{.group=1, .num=1}, // timer3
 };
 
-uint8_t claimed = 0U; // stores whether timers were claimed or not
+// interrupt sources of each timer, same order as timerGroups
+static const int timerSources[4] = {
+	ETS_TG0_T0_LEVEL_INTR_SOURCE, // timer0
+	ETS_TG1_T0_LEVEL_INTR_SOURCE, // timer1
+	ETS_TG0_T1_LEVEL_INTR_SOURCE, // timer2
+	ETS_TG1_T1_LEVEL_INTR_SOURCE, // timer3
+};
+
+typedef struct timer_state_s {
+	hard_timer_function_ptr_t function; // user function
+	void *context; // user context passed to function
+	uint32_t configReg; // address of timer config register
+	uint32_t clearReg; // address of group interrupt clear register
+	uint32_t mask; // interrupt bit of timer in group
+	intr_handle_t handle; // interrupt allocated to timer, NULL when not raw
+	uint8_t group; // timer group
+	uint8_t num; // timer number
+	timertick_t period; // timer ticks per alarm
+	timertick_t reload; // counter value auto reload restores at alarm
+	uint32_t shiftTicks; // delay to add to next period, taken by ISR
+	bool shifted; // alarm value holds a delayed period to undo
+	#ifdef HARD_TIMER_LATENCY
+		uint32_t tickNS2; // 2x ns per timer tick
+		uint32_t periodCycles; // CPU cycles between alarms
+		uint32_t lastCycles; // CPU cycle count at last ISR entry
+		struct hardTimerLatency latency; // latency stats
+	#endif
+} timer_state_t;
+
+// ISR state of each timer, resolved before ISR runs
+static timer_state_t timerStates[4];
+
+// allocation bitmaps, bit n is timer n, only changed atomically
+uint32_t claimed = 0U; // stores whether timers were claimed or not
+static uint32_t taken = 0U; // stores whether timers are claimed or started
+
+// core each timer ISR is allocated on
+static uint8_t timerCores[4] = {
+	HARD_TIMER_ANY_CORE, HARD_TIMER_ANY_CORE, HARD_TIMER_ANY_CORE, HARD_TIMER_ANY_CORE,
+};
 
 // hardware timer pointers
 hard_timer_group_t *timers[] = {
@@ -97,17 +150,93 @@ hard_timer_group_t** getTimer(hard_timer_t timer) {
 /**
  * Gets next unstarted and unclaimed timer
  * 
+ * @note timer is not reserved, use 'timerSelect' before starting it
+ * 
  * @return available timer
  */
 hard_timer_t getNextTimer(void) {
+
+	uint32_t busy = __atomic_load_n(&taken, __ATOMIC_ACQUIRE);
+
 	for (uint8_t i = 0; i < NUM_TIMERS; i++) {
-		if (!hardTimerStarted(i) && !hardTimerClaimed(i)) {
+		if (!(busy & TIMER_BIT(i))) {
 			return (hard_timer_t)i;
 		}
 	}
 	return HARD_TIMER_INVALID;
 }
 
+/**
+ * Reserves timer if no one else holds it
+ * 
+ * @param timer timer to reserve
+ * 
+ * @return if timer was reserved
+ */
+static bool timerTake(hard_timer_t timer) {
+
+	uint32_t expected = __atomic_load_n(&taken, __ATOMIC_RELAXED);
+
+	do {
+		if (expected & TIMER_BIT(timer)) {
+			return false;
+		}
+	} while (!__atomic_compare_exchange_n(&taken, &expected, expected | TIMER_BIT(timer), true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+	return true;
+}
+
+/**
+ * Reserves first free timer
+ * 
+ * @return reserved timer, HARD_TIMER_INVALID if none are free
+ */
+static hard_timer_t timerTakeNext(void) {
+
+	for (uint8_t i = 0; i < NUM_TIMERS; i++) {
+		if (timerTake(i)) {
+			return (hard_timer_t)i;
+		}
+	}
+	return HARD_TIMER_INVALID;
+}
+
+/**
+ * Frees timer reservation unless timer is claimed
+ * 
+ * @param timer timer to free
+ */
+static void timerRelease(hard_timer_t timer) {
+
+	if (!hardTimerClaimed(timer)) {
+		__atomic_fetch_and(&taken, ~TIMER_BIT(timer), __ATOMIC_RELEASE);
+	}
+}
+
+/**
+ * Picks and reserves timer to start
+ * 
+ * @param timer pointer to timer ID, replaced if not usable
+ * 
+ * @note claimed timers are already reserved, unclaimed ones are taken here
+ * 
+ * @return if a timer was reserved
+ */
+static bool timerSelect(hard_timer_t *timer) {
+
+	if (*timer != HARD_TIMER_INVALID && *timer < NUM_TIMERS) {
+		if (hardTimerClaimed(*timer)) {
+			return !hardTimerStarted(*timer);
+		}
+		if (timerTake(*timer)) {
+			return true;
+		}
+	}
+
+	*timer = timerTakeNext();
+	return *timer != HARD_TIMER_INVALID;
+}
+
 /**
  * Sets timer claimed state
  * 
@@ -120,16 +249,26 @@ void setTimerClaimed(hard_timer_t timer, bool state) {
 		return;
 	}
 	if (state) {
-		claimed |= (1 << (timer));
+		__atomic_fetch_or(&claimed, TIMER_BIT(timer), __ATOMIC_ACQ_REL);
 	}
 	else {
-		claimed &= (~(1 << (timer)));
+		__atomic_fetch_and(&claimed, ~TIMER_BIT(timer), __ATOMIC_ACQ_REL);
 	}
 }
 
 hard_timer_t claimTimer(struct hardTimerPriority *priority) {
-	hard_timer_t timer = getNextTimer();
+	return claimTimerCore(priority, HARD_TIMER_ANY_CORE);
+}
+
+hard_timer_t claimTimerCore(struct hardTimerPriority *priority, uint8_t core) {
+
+	if (core != HARD_TIMER_ANY_CORE && core >= CORE_COUNT) {
+		return HARD_TIMER_INVALID;
+	}
+
+	hard_timer_t timer = timerTakeNext();
 	if (timer != HARD_TIMER_INVALID) {
+		timerCores[timer] = core;
 		setTimerClaimed(timer, true);
 	}
 	return timer;
@@ -137,61 +276,101 @@ hard_timer_t claimTimer(struct hardTimerPriority *priority) {
 
 bool unclaimTimer(hard_timer_t timer) {
 
-	if (hardTimerClaimed(timer)) {
-		setTimerClaimed(timer, false);
-		return true;
+	if (timer == HARD_TIMER_INVALID) {
+		return false;
 	}
-	return false;
+
+	uint32_t previous = __atomic_fetch_and(&claimed, ~TIMER_BIT(timer), __ATOMIC_ACQ_REL);
+	if (!(previous & TIMER_BIT(timer))) {
+		return false;
+	}
+
+	timerCores[timer] = HARD_TIMER_ANY_CORE;
+	if (!hardTimerStarted(timer)) {
+		timerRelease(timer);
+	}
+	return true;
 }
 
 bool hardTimerClaimed(hard_timer_t timer) {
 	if (timer == HARD_TIMER_INVALID) {
 		return false;
 	}
-	return !!(claimed & (1 << (timerGroups[timer].group + timerGroups[timer].num * 2)));
+	return !!(__atomic_load_n(&claimed, __ATOMIC_ACQUIRE) & TIMER_BIT(timer));
 }
 
 /**
- * Gets hard timer stats for target frequency
- * 
- * @param freq pointer to desired frequency in Hz
- * @param timer pointer to timer ID
- * @param scalar pointer to scalar value
- * @param timerTicks pointer to desired tick count
+ * Splits APB_CLK count into divider and ticks
  * 
- * @return result of getting timer stats
+ * @param count APB_CLK ticks per alarm
+ * @param divisor pointer to store divider and ticks
  * 
- * @note freq value is changed to actual freq if values are slightly off
+ * @return if count could be split
  */
-enum HardTimerStatusReturn getHardTimerStats(freq_t *freq, hard_timer_t *timer, prescalar_t *scalar, timertick_t *timerTicks) {
+static bool timerSplitCount(uint32_t count, struct hardTimerDivisor *divisor) {
 
-	enum HardTimerStatusReturn status = HARD_TIMER_OK;
+	if (count <= HARD_TIMER_MAX_SCALAR) {
+		divisor -> scalar = (prescalar_t)count;
+		divisor -> timerTicks = 1U;
+		return true;
+	}
+	if (count % 2U == 0U) {
+		divisor -> scalar = 2U;
+		divisor -> timerTicks = count / 2U;
+		return true;
+	}
 
-	// freq doesn't divide evenly into APB_CLK
-	if (APB_CLK_FREQ % *freq != 0) {
-		status = HARD_TIMER_SLIGHTLY_OFF;
+	// odd count needs an odd factor, only up to its square root
+	for (uint32_t factor = 3U; factor <= HARD_TIMER_MAX_SCALAR && factor * factor <= count; factor += 2U) {
+		if (count % factor == 0U) {
+			divisor -> scalar = (prescalar_t)factor;
+			divisor -> timerTicks = count / factor;
+			return true;
+		}
 	}
 
-	// scalar * timerTicks = APB_CLK / freq
-	freq_t target = APB_CLK_FREQ / *freq;
+	return false;
+}
+
+enum HardTimerStatusReturn hardTimerSolve(freq_t freq, struct hardTimerDivisor *divisor) {
 
-	if (target <= SCALAR_MAX) {
-		// scalar within max value
-		*scalar = (prescalar_t)target;
-		*timerTicks = 1;
+	if (divisor == NULL || freq == (freq_t)0 || freq > APB_CLK_FREQ / HARD_TIMER_MIN_SCALAR) {
+		return HARD_TIMER_FAIL;
 	}
-	else {
-		// scalar not within max value
-		*scalar = 1;
-		*timerTicks = (timertick_t)target;
 
-		while (*timerTicks % 2 == 0 && *scalar * 2 <= SCALAR_MAX) {
-			*timerTicks /= 2;
-			*scalar *= 2;
-		}
+	// closest APB_CLK count per alarm
+	uint32_t count = (APB_CLK_FREQ + freq / 2U) / freq;
+
+	if (!timerSplitCount(count, divisor)) {
+		// prime count, even neighbours always split so take the closer one
+		uint64_t belowError = (uint64_t)freq * (count + 1U) - APB_CLK_FREQ;
+		uint64_t aboveError = APB_CLK_FREQ - (uint64_t)freq * (count - 1U);
+		count = (belowError <= aboveError) ? count + 1U : count - 1U;
+		timerSplitCount(count, divisor);
 	}
 
-	*freq = APB_CLK_FREQ / (*scalar * *timerTicks);
+	int64_t reached = (int64_t)freq * count;
+	divisor -> freq = APB_CLK_FREQ / count;
+	divisor -> errorPPM = (int32_t)(((int64_t)APB_CLK_FREQ - reached) * 1000000 / reached);
+
+	if (reached != APB_CLK_FREQ) {
+		return HARD_TIMER_SLIGHTLY_OFF;
+	}
+	return HARD_TIMER_OK;
+}
+
+enum HardTimerStatusReturn getHardTimerStats(freq_t *freq, hard_timer_t *timer, prescalar_t *scalar, timertick_t *timerTicks) {
+
+	struct hardTimerDivisor divisor;
+	enum HardTimerStatusReturn status = hardTimerSolve(*freq, &divisor);
+
+	if (status == HARD_TIMER_FAIL) {
+		return HARD_TIMER_FAIL;
+	}
+
+	*scalar = divisor.scalar;
+	*timerTicks = divisor.timerTicks;
+	*freq = divisor.freq;
 
 	if ((!hardTimerClaimed(*timer) && hardTimerStarted(*timer)) || *timer == HARD_TIMER_INVALID) {
 		*timer = getNextTimer();
@@ -216,6 +395,20 @@ bool hardTimerStarted(hard_timer_t timer) {
 	return false;
 }
 
+/**
+ * Sets counter of timer
+ * 
+ * @param timer timer to set
+ * @param value new counter value
+ * 
+ * @note IDF sets counter through reload register, so value is also what auto reload restores
+ */
+static void timerSetCounter(hard_timer_t timer, timertick_t value) {
+
+	timer_set_counter_value(timerGroups[timer].group, timerGroups[timer].num, value);
+	timerStates[timer].reload = value;
+}
+
 bool cancelHardTimer(hard_timer_t timer) {
 	
 	if (hardTimerStarted(timer)) {
@@ -225,12 +418,20 @@ bool cancelHardTimer(hard_timer_t timer) {
 		// cancels timer
 		timer_set_alarm((*timerPtr) -> group, (*timerPtr) -> num, false);
 		timer_pause((*timerPtr) -> group, (*timerPtr) -> num);
-		timer_set_counter_value((*timerPtr) -> group, (*timerPtr) -> num, TIMER_COUNT_ZERO);
+		timerSetCounter(timer, TIMER_COUNT_ZERO);
 
 		// deconstructs timer
-		timer_isr_callback_remove((*timerPtr) -> group, (*timerPtr) -> num);
+		if (timerStates[timer].handle != NULL) {
+			timer_disable_intr((*timerPtr) -> group, (*timerPtr) -> num);
+			esp_intr_free(timerStates[timer].handle);
+			timerStates[timer].handle = NULL;
+		}
+		else {
+			timer_isr_callback_remove((*timerPtr) -> group, (*timerPtr) -> num);
+		}
 		timer_deinit((*timerPtr) -> group, (*timerPtr) -> num);
 		*timerPtr = NULL;
+		timerRelease(timer);
 
 		return true;
 	}
@@ -238,7 +439,372 @@ bool cancelHardTimer(hard_timer_t timer) {
 	return false;
 }
 
-bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority) {
+#ifdef HARD_TIMER_LATENCY
+
+/**
+ * Records latency of alarm at ISR entry
+ * 
+ * @param state ISR state of timer
+ * 
+ * @note auto reload restores reload value at alarm, so counter past it is ticks since alarm
+ */
+static inline void RUN_IN_RAM(timerLatencyRecord) timerLatencyRecord(timer_state_t *state) {
+
+	uint64_t counter = timer_group_get_counter_value_in_isr(state -> group, state -> num);
+	uint32_t cycles = xthal_get_ccount();
+
+	struct hardTimerLatency *latency = &state -> latency;
+	uint64_t ticks = (counter > state -> reload) ? counter - state -> reload : 0U;
+	uint32_t ns = (uint32_t)((ticks * state -> tickNS2) >> 1);
+
+	// alarms merge when an ISR is late by a whole period, delayed periods are longer
+	if (latency -> count != 0U && !state -> shifted && cycles - state -> lastCycles > state -> periodCycles + state -> periodCycles / 2U) {
+		latency -> overruns++;
+	}
+	state -> lastCycles = cycles;
+
+	if (ns < latency -> minNS) {
+		latency -> minNS = ns;
+	}
+	if (ns > latency -> maxNS) {
+		latency -> maxNS = ns;
+	}
+
+	uint8_t bucket = (ns == 0U) ? 0U : (32U - __builtin_clz(ns));
+	if (bucket >= HARD_TIMER_LATENCY_BUCKETS) {
+		bucket = HARD_TIMER_LATENCY_BUCKETS - 1U;
+	}
+	latency -> buckets[bucket]++;
+	latency -> count++;
+}
+
+/**
+ * Clears latency stats and resolves tick timing
+ * 
+ * @param timer timer to set up
+ * @param scalar timer clock divider
+ * @param timerTicks timer clock ticks per alarm
+ */
+static void timerLatencySetup(hard_timer_t timer, prescalar_t scalar, timertick_t timerTicks) {
+
+	timer_state_t *state = &timerStates[timer];
+	uint32_t cyclesPerTick = ets_get_cpu_frequency() * scalar / (APB_CLK_FREQ / 1000000U);
+
+	state -> tickNS2 = 2000U * scalar / (APB_CLK_FREQ / 1000000U);
+	state -> periodCycles = (uint32_t)(cyclesPerTick * timerTicks);
+	state -> lastCycles = 0U;
+
+	memset(&state -> latency, 0, sizeof(state -> latency));
+	state -> latency.minNS = UINT32_MAX;
+}
+
+bool hardTimerLatencyGet(hard_timer_t timer, struct hardTimerLatency *latency) {
+
+	if (!hardTimerStarted(timer) || latency == NULL) {
+		return false;
+	}
+
+	*latency = timerStates[timer].latency;
+	return true;
+}
+
+bool hardTimerLatencyReset(hard_timer_t timer) {
+
+	if (!hardTimerStarted(timer)) {
+		return false;
+	}
+
+	memset(&timerStates[timer].latency, 0, sizeof(timerStates[timer].latency));
+	timerStates[timer].latency.minNS = UINT32_MAX;
+	return true;
+}
+
+bool hardTimerLatencyDump(hard_timer_t timer) {
+
+	struct hardTimerLatency latency;
+	if (!hardTimerLatencyGet(timer, &latency)) {
+		return false;
+	}
+
+	printf("timer%u: %lu alarms, min %lu ns, max %lu ns, %lu overruns\n", timer,
+		(unsigned long)latency.count, (unsigned long)(latency.count ? latency.minNS : 0U),
+		(unsigned long)latency.maxNS, (unsigned long)latency.overruns);
+
+	for (uint8_t i = 0U; i < HARD_TIMER_LATENCY_BUCKETS; i++) {
+		if (latency.buckets[i] == 0U) {
+			continue;
+		}
+		uint32_t low = (i == 0U) ? 0U : (1UL << (i - 1U));
+		printf("  >= %lu ns: %lu\n", (unsigned long)low, (unsigned long)latency.buckets[i]);
+	}
+
+	return true;
+}
+
+#endif
+
+/**
+ * Moves alarm for pending phase shift or back to period after one
+ * 
+ * @param state ISR state of timer
+ * 
+ * @note runs right after alarm, counter restarted at 0 so alarm is ticks from now
+ */
+static inline void RUN_IN_RAM(timerPhaseApply) timerPhaseApply(timer_state_t *state) {
+
+	uint32_t shift = __atomic_exchange_n(&state -> shiftTicks, 0U, __ATOMIC_RELAXED);
+
+	if (shift != 0U || state -> shifted) {
+		timer_group_set_alarm_value_in_isr(state -> group, state -> num, state -> period + shift);
+		state -> shifted = shift != 0U;
+	}
+}
+
+/**
+ * Applies phase shifts then runs user function
+ * 
+ * @param arg ISR state of timer
+ * 
+ * @note runs from IDF dispatcher, which re-arms alarm after
+ * 
+ * @return if a higher priority task was woken
+ */
+static bool RUN_IN_RAM(timerDispatchISR) timerDispatchISR(void *arg) {
+
+	timer_state_t *state = arg;
+
+	#ifdef HARD_TIMER_LATENCY
+		timerLatencyRecord(state);
+	#endif
+	timerPhaseApply(state);
+
+	return state -> function(state -> context);
+}
+
+/**
+ * Acknowledges alarm, re-arms it and runs user function
+ * 
+ * @param arg raw state of timer
+ * 
+ * @note bypasses IDF timer dispatcher, only register writes before user function
+ */
+static void RUN_IN_RAM(timerRawISR) timerRawISR(void *arg) {
+
+	timer_state_t *raw = arg;
+
+	#ifdef HARD_TIMER_LATENCY
+		timerLatencyRecord(raw);
+	#endif
+
+	REG_WRITE(raw -> clearReg, raw -> mask);
+	timerPhaseApply(raw);
+	REG_SET_BIT(raw -> configReg, TIMG_T0_ALARM_EN);
+
+	if (raw -> function(raw -> context)) {
+		portYIELD_FROM_ISR();
+	}
+}
+
+/**
+ * Allocates interrupt of timer straight to raw ISR
+ * 
+ * @param timer timer to attach
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ * 
+ * @return if interrupt was allocated
+ */
+static bool attachRawISR(hard_timer_t timer, hard_timer_function_ptr_t function, timer_priority_t priority, void *context) {
+
+	hard_timer_group_t *group = &timerGroups[timer];
+	timer_state_t *raw = &timerStates[timer];
+
+	raw -> function = function;
+	raw -> context = context;
+	raw -> configReg = (group -> num == 0U) ? TIMG_T0CONFIG_REG(group -> group) : TIMG_T1CONFIG_REG(group -> group);
+	raw -> clearReg = TIMG_INT_CLR_TIMERS_REG(group -> group);
+	raw -> mask = BIT(group -> num);
+
+	timer_enable_intr(group -> group, group -> num);
+	if (esp_intr_alloc(timerSources[timer], setPriority(priority) | ESP_INTR_FLAG_IRAM, timerRawISR, raw, &raw -> handle) != ESP_OK) {
+		timer_disable_intr(group -> group, group -> num);
+		raw -> handle = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+struct timerAttach {
+	hard_timer_t timer; // timer to attach
+	hard_timer_function_ptr_t function; // function to run on alarm
+	timer_priority_t priority; // priority of function
+	void *context; // user context passed to function
+	bool raw; // whether to use raw ISR
+	bool attached; // set once interrupt is allocated
+};
+
+/**
+ * Allocates timer interrupt on core this runs on
+ * 
+ * @param arg timer attach request
+ */
+static void attachISROnCore(void *arg) {
+
+	struct timerAttach *attach = arg;
+	hard_timer_t timer = attach -> timer;
+
+	if (attach -> raw) {
+		attach -> attached = attachRawISR(timer, attach -> function, attach -> priority, attach -> context);
+		return;
+	}
+
+	timerStates[timer].function = attach -> function;
+	timerStates[timer].context = attach -> context;
+	attach -> attached = timer_isr_callback_add(timerGroups[timer].group, timerGroups[timer].num,
+		timerDispatchISR, &timerStates[timer], setPriority(attach -> priority)) == ESP_OK;
+}
+
+/**
+ * Sets up timer and its interrupt, leaving it paused with alarm off
+ * 
+ * @param timer timer to set up
+ * @param scalar timer clock divider
+ * @param timerTicks timer clock ticks per alarm
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ * @param raw whether to use raw ISR instead of IDF dispatcher
+ * 
+ * @return if timer was set up
+ */
+static bool prepareHardTimer(hard_timer_t timer, prescalar_t scalar, timertick_t timerTicks, hard_timer_function_ptr_t function, timer_priority_t priority, void *context, bool raw) {
+
+	if (hardTimerStarted(timer)) {
+		return false;
+	}
+
+	hard_timer_group_t** timerPtr = getTimer(timer);
+
+	// init timer
+	timer_config_t config = {
+		.divider = scalar,
+		.counter_dir = true,
+		.counter_en = TIMER_PAUSE,
+		.alarm_en = TIMER_ALARM_DIS,
+		.auto_reload = false,
+	};
+	*timerPtr = &timerGroups[timer];
+	
+	timer_init((*timerPtr) -> group, (*timerPtr) -> num, &config);
+	timerSetCounter(timer, TIMER_COUNT_ZERO);
+
+	timer_state_t *state = &timerStates[timer];
+	state -> group = (*timerPtr) -> group;
+	state -> num = (*timerPtr) -> num;
+	state -> period = timerTicks;
+	state -> shiftTicks = 0U;
+	state -> shifted = false;
+	#ifdef HARD_TIMER_LATENCY
+		timerLatencySetup(timer, scalar, timerTicks);
+	#endif
+
+	struct timerAttach attach = {
+		.timer = timer,
+		.function = function,
+		.priority = priority,
+		.context = context,
+		.raw = raw,
+		.attached = false,
+	};
+
+	// interrupts are allocated on the calling core
+	uint8_t core = timerCores[timer];
+	if (core != HARD_TIMER_ANY_CORE && core != xPortGetCoreID()) {
+		esp_ipc_call_blocking(core, attachISROnCore, &attach);
+	}
+	else {
+		attachISROnCore(&attach);
+	}
+
+	if (!attach.attached) {
+		timer_pause((*timerPtr) -> group, (*timerPtr) -> num);
+		timer_deinit((*timerPtr) -> group, (*timerPtr) -> num);
+		*timerPtr = NULL;
+		timerRelease(timer);
+		return false;
+	}
+
+	timer_set_alarm_value((*timerPtr) -> group, (*timerPtr) -> num, timerTicks);
+	timer_set_auto_reload((*timerPtr) -> group, (*timerPtr) -> num, true);
+	return true;
+}
+
+/**
+ * Starts timer with known scalar and tick count
+ * 
+ * @param timer timer to start
+ * @param scalar timer clock divider
+ * @param timerTicks timer clock ticks per alarm
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ * @param raw whether to use raw ISR instead of IDF dispatcher
+ * 
+ * @return if timer was started
+ */
+bool startHardTimer(hard_timer_t timer, prescalar_t scalar, timertick_t timerTicks, hard_timer_function_ptr_t function, timer_priority_t priority, void *context, bool raw) {
+
+	if (!prepareHardTimer(timer, scalar, timerTicks, function, priority, context, raw)) {
+		return false;
+	}
+
+	// run timer
+	timer_set_alarm(timerGroups[timer].group, timerGroups[timer].num, true);
+	timer_start(timerGroups[timer].group, timerGroups[timer].num);
+	return true;
+}
+
+/**
+ * Sets timer with known divider and ticks, common path of every setter
+ * 
+ * @param timer pointer to timer ID
+ * @param scalar timer clock divider
+ * @param timerTicks timer clock ticks per alarm
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ * @param raw whether to use raw ISR
+ * 
+ * @return if timer was set
+ */
+static bool setHardTimerSplit(hard_timer_t *timer, prescalar_t scalar, timertick_t timerTicks, hard_timer_function_ptr_t function, timer_priority_t priority, void *context, bool raw) {
+
+	if (function == NULL || timer == NULL || scalar < HARD_TIMER_MIN_SCALAR || timerTicks == 0U) {
+		return false;
+	}
+
+	if (!timerSelect(timer)) {
+		return false;
+	}
+
+	return startHardTimer(*timer, scalar, timerTicks, function, priority, context, raw);
+}
+
+/**
+ * Sets timer with IDF dispatcher or raw ISR
+ * 
+ * @param timer pointer to timer ID
+ * @param freq pointer to desired frequency in Hz
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ * @param raw whether to use raw ISR
+ * 
+ * @return if timer was set
+ */
+static bool setHardTimerMode(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, void *context, bool raw) {
 	
 	if (function == NULL || freq == NULL || timer == NULL) {
 		return false;
@@ -254,34 +820,187 @@ bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t f
 		return false;
 	}
 
-	if (!hardTimerStarted(*timer)) {
-
-		hard_timer_group_t** timerPtr = getTimer(*timer);
-
-		// init timer
-		timer_config_t config = {
-			.divider = scalar,
-			.counter_dir = true,
-			.counter_en = TIMER_PAUSE,
-			.alarm_en = TIMER_ALARM_DIS,
-			.auto_reload = false,
-		};
-		*timerPtr = &timerGroups[*timer];
-		
-		timer_init((*timerPtr) -> group, (*timerPtr) -> num, &config);
-		timer_set_counter_value((*timerPtr) -> group, (*timerPtr) -> num, TIMER_COUNT_ZERO);
-		timer_start((*timerPtr) -> group, (*timerPtr) -> num);
-		timer_isr_callback_add((*timerPtr) -> group, (*timerPtr) -> num, function, NULL, setPriority(priority));
-
-		// run timer
-		timer_set_alarm_value((*timerPtr) -> group, (*timerPtr) -> num, timerTicks);
-		timer_set_auto_reload((*timerPtr) -> group, (*timerPtr) -> num, true);
-		timer_set_alarm((*timerPtr) -> group, (*timerPtr) -> num, true);
-		timer_start((*timerPtr) -> group, (*timerPtr) -> num);
-		return true;
+	return setHardTimerSplit(timer, scalar, timerTicks, function, priority, context, raw);
+}
+
+bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority) {
+	return setHardTimerContext(timer, freq, function, priority, NULL);
+}
+
+bool setHardTimerContext(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, void *context) {
+	return setHardTimerMode(timer, freq, function, priority, context, TIMER_RAW_DEFAULT);
+}
+
+bool setHardTimerRaw(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, void *context) {
+	return setHardTimerMode(timer, freq, function, priority, context, true);
+}
+
+bool setHardTimerDivisor(hard_timer_t *timer, prescalar_t scalar, timertick_t timerTicks, hard_timer_function_ptr_t function, timer_priority_t priority, void *context) {
+	return setHardTimerSplit(timer, scalar, timerTicks, function, priority, context, TIMER_RAW_DEFAULT);
+}
+
+bool setHardTimerFine(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, timertick_t *timerTicks) {
+
+	if (function == NULL || freq == NULL || timer == NULL || timerTicks == NULL) {
+		return false;
+	}
+	if (*freq == (freq_t)0 || *freq > FREQ_MAX) {
+		return false;
 	}
 
-	return false;
+	// smallest divider gives finest tick
+	*timerTicks = APB_CLK_FREQ / (HARD_TIMER_MIN_SCALAR * (timertick_t)*freq);
+	if (*timerTicks == 0U) {
+		return false;
+	}
+	*freq = APB_CLK_FREQ / (HARD_TIMER_MIN_SCALAR * *timerTicks);
+
+	return setHardTimerSplit(timer, HARD_TIMER_MIN_SCALAR, *timerTicks, function, priority, NULL, TIMER_RAW_DEFAULT);
+}
+
+/**
+ * Enables counters of timers back to back
+ * 
+ * @param entries timers to enable
+ * @param count amount of timers
+ * @param cycles storage for CPU cycle count of each counter start, NULL to skip
+ * 
+ * @note runs in one critical section so start times only differ by register writes
+ * @note with cycles, counters are latched and stopped again right after
+ */
+static void timerGroupRelease(const struct hardTimerGroupEntry *entries, uint8_t count, uint32_t *cycles) {
+
+	static portMUX_TYPE groupLock = portMUX_INITIALIZER_UNLOCKED;
+	uint32_t configRegs[NUM_TIMERS];
+	uint32_t updateRegs[NUM_TIMERS];
+	uint32_t lowRegs[NUM_TIMERS];
+	uint32_t counts[NUM_TIMERS];
+
+	for (uint8_t i = 0U; i < count; i++) {
+		hard_timer_group_t *group = &timerGroups[entries[i].timer];
+		bool first = group -> num == 0U;
+		configRegs[i] = first ? TIMG_T0CONFIG_REG(group -> group) : TIMG_T1CONFIG_REG(group -> group);
+		updateRegs[i] = first ? TIMG_T0UPDATE_REG(group -> group) : TIMG_T1UPDATE_REG(group -> group);
+		lowRegs[i] = first ? TIMG_T0LO_REG(group -> group) : TIMG_T1LO_REG(group -> group);
+	}
+
+	taskENTER_CRITICAL(&groupLock);
+
+	for (uint8_t i = 0U; i < count; i++) {
+		REG_SET_BIT(configRegs[i], TIMG_T0_EN);
+	}
+
+	if (cycles != NULL) {
+		// each latch is paired with CPU cycles taken the same way, so latch order drops out
+		for (uint8_t i = 0U; i < count; i++) {
+			REG_WRITE(updateRegs[i], 1U);
+			counts[i] = REG_READ(lowRegs[i]);
+			cycles[i] = xthal_get_ccount();
+		}
+		for (uint8_t i = 0U; i < count; i++) {
+			REG_CLR_BIT(configRegs[i], TIMG_T0_EN);
+		}
+	}
+
+	taskEXIT_CRITICAL(&groupLock);
+
+	if (cycles != NULL) {
+		// counter ran count ticks before its latch
+		uint32_t cyclesPerTick = ets_get_cpu_frequency() * HARD_TIMER_MIN_SCALAR / (APB_CLK_FREQ / 1000000U);
+		for (uint8_t i = 0U; i < count; i++) {
+			cycles[i] -= counts[i] * cyclesPerTick;
+		}
+	}
+}
+
+bool setHardTimerGroup(struct hardTimerGroupEntry *entries, uint8_t count, uint32_t phaseSteps, freq_t *freq, timer_priority_t priority, uint32_t *skewNS) {
+
+	if (entries == NULL || count == 0U || count > NUM_TIMERS || phaseSteps == 0U || freq == NULL) {
+		return false;
+	}
+	if (*freq == (freq_t)0 || *freq > FREQ_MAX) {
+		return false;
+	}
+
+	// smallest divider gives finest phase steps
+	timertick_t timerTicks = APB_CLK_FREQ / (HARD_TIMER_MIN_SCALAR * (timertick_t)*freq);
+	if (timerTicks == 0U) {
+		return false;
+	}
+
+	uint8_t prepared = 0U;
+	for (; prepared < count; prepared++) {
+		struct hardTimerGroupEntry *entry = &entries[prepared];
+		if (entry -> function == NULL || !timerSelect(&entry -> timer)) {
+			break;
+		}
+		if (!prepareHardTimer(entry -> timer, HARD_TIMER_MIN_SCALAR, timerTicks, entry -> function, priority, entry -> context, TIMER_RAW_DEFAULT)) {
+			break;
+		}
+	}
+	if (prepared < count) {
+		for (uint8_t i = 0U; i < prepared; i++) {
+			cancelHardTimer(entries[i].timer);
+		}
+		return false;
+	}
+
+	// dry run with alarms off measures skew of release
+	uint32_t cycles[NUM_TIMERS];
+	timerGroupRelease(entries, count, cycles);
+
+	int32_t earliest = 0;
+	int32_t latest = 0;
+	for (uint8_t i = 1U; i < count; i++) {
+		int32_t offset = (int32_t)(cycles[i] - cycles[0]);
+		earliest = (offset < earliest) ? offset : earliest;
+		latest = (offset > latest) ? offset : latest;
+	}
+	if (skewNS != NULL) {
+		*skewNS = (uint32_t)(latest - earliest) * 1000U / ets_get_cpu_frequency();
+	}
+
+	// first alarm comes after phase delay, ISR then puts alarm back to one period
+	for (uint8_t i = 0U; i < count; i++) {
+		hard_timer_t timer = entries[i].timer;
+		hard_timer_group_t *group = &timerGroups[timer];
+		timertick_t delay = timerTicks * (entries[i].phase % phaseSteps) / phaseSteps;
+
+		timerSetCounter(timer, TIMER_COUNT_ZERO);
+		if (delay != 0U) {
+			timer_set_alarm_value(group -> group, group -> num, delay);
+			timerStates[timer].shifted = true;
+		}
+		timer_set_alarm(group -> group, group -> num, true);
+	}
+
+	timerGroupRelease(entries, count, NULL);
+
+	*freq = APB_CLK_FREQ / (HARD_TIMER_MIN_SCALAR * timerTicks);
+	return true;
+}
+
+bool hardTimerShiftPhase(hard_timer_t timer, timertick_t ticks) {
+
+	if (!hardTimerStarted(timer)) {
+		return false;
+	}
+
+	timer_state_t *state = &timerStates[timer];
+	if (state -> period > UINT32_MAX) {
+		return false;
+	}
+
+	// ISR moves alarm of the next period, so counter and reload stay untouched
+	uint32_t period = (uint32_t)state -> period;
+	uint32_t shift = (uint32_t)(ticks % period);
+	uint32_t expected = __atomic_load_n(&state -> shiftTicks, __ATOMIC_RELAXED);
+
+	while (!__atomic_compare_exchange_n(&state -> shiftTicks, &expected, (uint32_t)(((uint64_t)expected + shift) % period),
+		true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+	}
+
+	return true;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,307 @@
+/*
+	board_esp32_timer.h - timer extensions for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_TIMER_H
+#define BOARD_ESP32_TIMER_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "../../hard_timer.h"
+
+#include <soc/soc.h>
+
+/****************************
+ * Timer Types
+****************************/
+
+#define HARD_TIMER_ANY_CORE UINT8_MAX // timer ISR allocated on core that starts it
+#define HARD_TIMER_MIN_SCALAR 2U // smallest divider timer groups accept
+#define HARD_TIMER_MAX_SCALAR UINT16_MAX // largest divider timer groups accept
+
+typedef uint16_t prescalar_t; // pre scalar type
+typedef uint64_t timertick_t; // timer tick type
+
+struct hardTimerDivisor {
+	prescalar_t scalar; // timer clock divider
+	timertick_t timerTicks; // timer clock ticks per alarm
+	freq_t freq; // actual frequency in Hz
+	int32_t errorPPM; // actual minus desired frequency in ppm
+};
+
+struct hardTimerGroupEntry {
+	hard_timer_t timer; // timer to use, HARD_TIMER_INVALID to pick one, set to timer used
+	hard_timer_function_ptr_t function; // function to run on alarm
+	void *context; // user context passed to function
+	uint32_t phase; // alarm delay after group start in 1/phaseSteps of a period
+};
+
+#ifdef HARD_TIMER_LATENCY
+
+#define HARD_TIMER_LATENCY_BUCKETS 16U // log2 latency buckets
+
+struct hardTimerLatency {
+	uint32_t count; // alarms handled
+	uint32_t minNS; // lowest latency
+	uint32_t maxNS; // highest latency
+	uint32_t overruns; // alarms missed because ISR was a period late
+	uint32_t buckets[HARD_TIMER_LATENCY_BUCKETS]; // bucket n counts [2^(n-1), 2^n) ns, bucket 0 counts 0 ns, last bucket open ended
+};
+
+#endif
+
+/****************************
+ * Static Timer Config
+ *
+ * Resolves divider and ticks for a constant
+ * frequency entirely at compile time
+ *
+ * scalar * timerTicks = round(APB_CLK / freq) exactly,
+ * split like 'hardTimerSolve' splits it. Odd counts too large for
+ * scalar alone need an odd factor below 64, others are rejected
+ * at compile time and need 'setHardTimer'
+****************************/
+
+#define HARD_TIMER_STATIC_COUNT(freq) ((APB_CLK_FREQ + (freq) / 2U) / (freq)) // APB_CLK ticks per alarm
+#define HARD_TIMER_STATIC_PRIME(count, prime, next) ((count) % (prime) == 0U ? (prime) : (next)) // prime if it divides count, else next
+#define HARD_TIMER_STATIC_ODD_FACTOR(count) \
+	HARD_TIMER_STATIC_PRIME(count, 3U, HARD_TIMER_STATIC_PRIME(count, 5U, HARD_TIMER_STATIC_PRIME(count, 7U, \
+	HARD_TIMER_STATIC_PRIME(count, 11U, HARD_TIMER_STATIC_PRIME(count, 13U, HARD_TIMER_STATIC_PRIME(count, 17U, \
+	HARD_TIMER_STATIC_PRIME(count, 19U, HARD_TIMER_STATIC_PRIME(count, 23U, HARD_TIMER_STATIC_PRIME(count, 29U, \
+	HARD_TIMER_STATIC_PRIME(count, 31U, HARD_TIMER_STATIC_PRIME(count, 37U, HARD_TIMER_STATIC_PRIME(count, 41U, \
+	HARD_TIMER_STATIC_PRIME(count, 43U, HARD_TIMER_STATIC_PRIME(count, 47U, HARD_TIMER_STATIC_PRIME(count, 53U, \
+	HARD_TIMER_STATIC_PRIME(count, 59U, HARD_TIMER_STATIC_PRIME(count, 61U, 0U))))))))))))))))) // smallest odd factor below 64, 0 if none
+#define HARD_TIMER_STATIC_SCALAR(freq) (HARD_TIMER_STATIC_COUNT(freq) < HARD_TIMER_MIN_SCALAR ? 0U : \
+	HARD_TIMER_STATIC_COUNT(freq) <= HARD_TIMER_MAX_SCALAR ? HARD_TIMER_STATIC_COUNT(freq) : \
+	(HARD_TIMER_STATIC_COUNT(freq) & 1U) == 0U ? HARD_TIMER_MIN_SCALAR : \
+	HARD_TIMER_STATIC_ODD_FACTOR(HARD_TIMER_STATIC_COUNT(freq))) // divider for freq, 0 if count can't be split
+#define HARD_TIMER_STATIC_EXACT(freq) (HARD_TIMER_STATIC_SCALAR(freq) != 0U) // if count splits without rounding
+#define HARD_TIMER_STATIC_TICKS(freq) (HARD_TIMER_STATIC_EXACT(freq) ? \
+	HARD_TIMER_STATIC_COUNT(freq) / HARD_TIMER_STATIC_SCALAR(freq) : 0U) // ticks for freq, 0 if count can't be split
+#define HARD_TIMER_STATIC_FREQ(freq) (APB_CLK_FREQ / HARD_TIMER_STATIC_COUNT(freq)) // actual freq
+
+/**
+ * Sets timer to a constant frequency without runtime division
+ *
+ * @param timer pointer to timer ID
+ * @param freq constant frequency in Hz
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ *
+ * @note actual rate is HARD_TIMER_STATIC_FREQ(freq), ISR mode follows HARD_TIMER_RAW_ISR
+ * @note fails to compile when HARD_TIMER_STATIC_EXACT(freq) is false
+ *
+ * @return if timer was set
+ */
+#define SET_HARD_TIMER_STATIC_CONTEXT(timer, freq, function, priority, context) \
+	((void)sizeof(struct { _Static_assert(HARD_TIMER_STATIC_EXACT(freq), "freq can't be split exactly, use setHardTimer"); char unused; }), \
+	setHardTimerDivisor((timer), HARD_TIMER_STATIC_SCALAR(freq), HARD_TIMER_STATIC_TICKS(freq), (function), (priority), (context)))
+
+/**
+ * Sets timer to a constant frequency like 'SET_HARD_TIMER_STATIC_CONTEXT' without context
+ */
+#define SET_HARD_TIMER_STATIC(timer, freq, function, priority) \
+	SET_HARD_TIMER_STATIC_CONTEXT(timer, freq, function, priority, NULL)
+
+/****************************
+ * Timer Functions
+****************************/
+
+/**
+ * Gets hard timer stats for target frequency
+ *
+ * @param freq pointer to desired frequency in Hz
+ * @param timer pointer to timer ID
+ * @param scalar pointer to scalar value
+ * @param timerTicks pointer to desired tick count
+ *
+ * @return result of getting timer stats
+ *
+ * @note freq value is changed to actual freq if values are slightly off
+ */
+enum HardTimerStatusReturn getHardTimerStats(freq_t *freq, hard_timer_t *timer, prescalar_t *scalar, timertick_t *timerTicks);
+
+/**
+ * Claims timer like 'claimTimer' with ISR pinned to core
+ *
+ * @param priority priority of timer
+ * @param core core to allocate timer ISR on, HARD_TIMER_ANY_CORE for caller core
+ *
+ * @note ISR is allocated on core through IPC when started from the other one
+ *
+ * @return claimed timer, HARD_TIMER_INVALID if none are free
+ */
+hard_timer_t claimTimerCore(struct hardTimerPriority *priority, uint8_t core);
+
+/**
+ * Finds divider and ticks closest to target frequency
+ *
+ * @param freq desired frequency in Hz
+ * @param divisor pointer to store divider, ticks and error
+ *
+ * @note divider alone is used when it fits, else its smallest factor
+ *
+ * @return HARD_TIMER_OK if exact, HARD_TIMER_SLIGHTLY_OFF if not,
+ * HARD_TIMER_FAIL if freq can't be reached
+ */
+enum HardTimerStatusReturn hardTimerSolve(freq_t freq, struct hardTimerDivisor *divisor);
+
+/**
+ * Sets timer with known divider and ticks
+ *
+ * @param timer pointer to timer ID
+ * @param scalar timer clock divider
+ * @param timerTicks timer clock ticks per alarm
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context user context passed to function
+ *
+ * @note ISR mode follows HARD_TIMER_RAW_ISR like 'setHardTimerContext'
+ *
+ * @return if timer was set
+ */
+bool setHardTimerDivisor(hard_timer_t *timer, prescalar_t scalar, timertick_t timerTicks, hard_timer_function_ptr_t function, timer_priority_t priority, void *context);
+
+/**
+ * Sets timer like 'setHardTimer' with user context
+ *
+ * @param timer pointer to timer ID
+ * @param freq pointer to desired frequency in Hz
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context passed to function as its parameter
+ *
+ * @note freq value is changed to actual freq
+ *
+ * @return if timer was set
+ */
+bool setHardTimerContext(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, void *context);
+
+/**
+ * Sets timer like 'setHardTimerContext' with raw ISR
+ *
+ * @param timer pointer to timer ID
+ * @param freq pointer to desired frequency in Hz
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param context passed to function as its parameter
+ *
+ * @note interrupt is allocated straight to an IRAM handler which
+ * acknowledges and re-arms the alarm by register, skipping IDF dispatch
+ * @note 'setHardTimer' uses this when HARD_TIMER_RAW_ISR is defined
+ *
+ * @warning function and everything it calls must be in IRAM
+ *
+ * @return if timer was set
+ */
+bool setHardTimerRaw(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, void *context);
+
+/**
+ * Sets timer like 'setHardTimer' with finest tick resolution
+ *
+ * @param timer pointer to timer ID
+ * @param freq pointer to desired frequency in Hz
+ * @param function function to run on alarm
+ * @param priority priority of function
+ * @param timerTicks pointer to store ticks per alarm
+ *
+ * @note each tick is HARD_TIMER_MIN_SCALAR / APB_CLK (25ns)
+ * @note freq value is changed to actual freq
+ *
+ * @return if timer was set
+ */
+bool setHardTimerFine(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, timertick_t *timerTicks);
+
+/**
+ * Starts several timers together with fixed phase offsets
+ *
+ * @param entries timers, functions and phases of group
+ * @param count amount of timers in group
+ * @param phaseSteps phase steps per period, count for even interleave
+ * @param freq pointer to desired frequency in Hz, shared by group
+ * @param priority priority of functions
+ * @param skewNS pointer to store measured start skew, can be NULL
+ *
+ * @note timers are set up paused, then released back to back in one critical section
+ * @note alarms of each timer trail those of phase 0 by phase / phaseSteps of a period,
+ * set through first alarm value so counters still reload to 0
+ * @note skew is measured by a dry release with alarms off, each counter latched
+ * against the CPU cycle count
+ * @note freq value is changed to actual freq
+ *
+ * @return if every timer was started, none are left running otherwise
+ */
+bool setHardTimerGroup(struct hardTimerGroupEntry *entries, uint8_t count, uint32_t phaseSteps, freq_t *freq, timer_priority_t priority, uint32_t *skewNS);
+
+/**
+ * Delays running timer alarms once by ticks
+ *
+ * @param timer timer to shift
+ * @param ticks timer ticks to delay by, taken modulo the period
+ *
+ * @note timer ISR lengthens the period after its next alarm by ticks,
+ * later periods are unchanged and no alarm is dropped
+ * @note shifts made before ISR runs add up
+ *
+ * @return if timer was shifted
+ */
+bool hardTimerShiftPhase(hard_timer_t timer, timertick_t ticks);
+
+#ifdef HARD_TIMER_LATENCY
+
+/****************************
+ * Timer Latency Functions
+ *
+ * Only built when HARD_TIMER_LATENCY is defined,
+ * latency is counter ticks since alarm at ISR entry
+****************************/
+
+/**
+ * Gets ISR latency stats of timer
+ *
+ * @param timer timer to read
+ * @param latency pointer to store stats
+ *
+ * @return if timer is running
+ */
+bool hardTimerLatencyGet(hard_timer_t timer, struct hardTimerLatency *latency);
+
+/**
+ * Clears ISR latency stats of timer
+ *
+ * @param timer timer to clear
+ *
+ * @return if timer is running
+ */
+bool hardTimerLatencyReset(hard_timer_t timer);
+
+/**
+ * Prints ISR latency stats and histogram of timer
+ *
+ * @param timer timer to print
+ *
+ * @return if timer is running
+ */
+bool hardTimerLatencyDump(hard_timer_t timer);
+
+#endif
+
+#endif
+#endif
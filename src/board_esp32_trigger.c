@@ -0,0 +1,219 @@
+/*
+	board_esp32_trigger.c - acquisition trigger for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_trigger.h"
+
+/**
+ * Checks sample against trigger condition
+ *
+ * @param trigger trigger to check
+ * @param sample raw sample
+ *
+ * @note tracks hysteresis band even while history is filling
+ *
+ * @return if sample meets trigger condition
+ */
+static inline bool triggerCheck(trigger_t *trigger, adc_sample_t sample) {
+
+	if (ADC_SAMPLE_CHANNEL(sample) != trigger -> config.channel) {
+		return false;
+	}
+
+	int32_t value = ADC_SAMPLE_VALUE(sample);
+	int32_t level = trigger -> config.level;
+	int32_t hysteresis = trigger -> config.hysteresis;
+
+	switch (trigger -> config.mode) {
+		case TRIGGER_RISING:
+			if (value <= level - hysteresis) {
+				trigger -> edgeArmed = true;
+			}
+			else if (trigger -> edgeArmed && value >= level) {
+				trigger -> edgeArmed = false;
+				return true;
+			}
+			return false;
+		case TRIGGER_FALLING:
+			if (value >= level + hysteresis) {
+				trigger -> edgeArmed = true;
+			}
+			else if (trigger -> edgeArmed && value <= level) {
+				trigger -> edgeArmed = false;
+				return true;
+			}
+			return false;
+		case TRIGGER_LEVEL_HIGH:
+			return value >= level;
+		case TRIGGER_LEVEL_LOW:
+			return value <= level;
+	}
+
+	return false;
+}
+
+bool triggerInit(trigger_t *trigger, const struct triggerConfig *config, adc_sample_t *history, adc_sample_t *frame) {
+
+	if (trigger == NULL || config == NULL || frame == NULL) {
+		return false;
+	}
+	if (config -> preCount > 0U && history == NULL) {
+		return false;
+	}
+	if (config -> postCount == 0U) {
+		// trigger sample is part of post count
+		return false;
+	}
+	if ((uint32_t)config -> preCount + config -> postCount > UINT16_MAX) {
+		return false;
+	}
+
+	trigger -> config = *config;
+	trigger -> history = history;
+	trigger -> frame = frame;
+	trigger -> fired = 0U;
+	trigger -> state = TRIGGER_IDLE;
+
+	return true;
+}
+
+void triggerArm(trigger_t *trigger) {
+
+	if (trigger == NULL) {
+		return;
+	}
+
+	// feeds stop before history is reset
+	__atomic_store_n(&trigger -> state, TRIGGER_IDLE, __ATOMIC_RELEASE);
+
+	trigger -> historyHead = 0U;
+	trigger -> historyCount = 0U;
+	trigger -> frameLength = 0U;
+	trigger -> edgeArmed = false;
+
+	// feeds seeing the armed state see the reset above
+	enum TriggerState state = (trigger -> config.preCount == 0U) ? TRIGGER_ARMED : TRIGGER_FILLING;
+	__atomic_store_n(&trigger -> state, state, __ATOMIC_RELEASE);
+}
+
+bool RUN_IN_RAM(triggerPush) triggerPush(trigger_t *trigger, adc_sample_t sample) {
+
+	uint16_t preCount = trigger -> config.preCount;
+
+	// pairs with release in 'triggerArm', which may run on another task
+	enum TriggerState state = __atomic_load_n(&trigger -> state, __ATOMIC_ACQUIRE);
+
+	switch (state) {
+		case TRIGGER_FILLING:
+		case TRIGGER_ARMED: {
+			bool hit = triggerCheck(trigger, sample);
+
+			if (hit && state == TRIGGER_ARMED) {
+				// moves history into frame oldest first
+				uint16_t index = trigger -> historyHead;
+				for (uint16_t i = 0U; i < preCount; i++) {
+					trigger -> frame[i] = trigger -> history[index];
+					index = (index + 1U == preCount) ? 0U : index + 1U;
+				}
+				trigger -> frame[preCount] = sample;
+				trigger -> frameLength = preCount + 1U;
+				trigger -> state = TRIGGER_POST;
+				break;
+			}
+
+			if (preCount > 0U) {
+				trigger -> history[trigger -> historyHead] = sample;
+				trigger -> historyHead = (trigger -> historyHead + 1U == preCount) ? 0U : trigger -> historyHead + 1U;
+				if (trigger -> historyCount < preCount && ++trigger -> historyCount == preCount) {
+					trigger -> state = TRIGGER_ARMED;
+				}
+			}
+			return false;
+		}
+		case TRIGGER_POST:
+			trigger -> frame[trigger -> frameLength++] = sample;
+			break;
+		default:
+			return false;
+	}
+
+	if (trigger -> frameLength >= preCount + trigger -> config.postCount) {
+		trigger -> fired++;
+		trigger -> state = TRIGGER_DONE;
+		return true;
+	}
+
+	return false;
+}
+
+uint16_t RUN_IN_RAM(triggerFeed) triggerFeed(trigger_t *trigger, const adc_sample_t *samples, uint16_t count) {
+
+	if (trigger == NULL || samples == NULL) {
+		return 0U;
+	}
+	if (trigger -> state == TRIGGER_IDLE || trigger -> state == TRIGGER_DONE) {
+		return 0U;
+	}
+
+	for (uint16_t i = 0U; i < count; i++) {
+		if (triggerPush(trigger, samples[i])) {
+			return i + 1U;
+		}
+	}
+
+	return count;
+}
+
+uint16_t RUN_IN_RAM(triggerFeedBlock) triggerFeedBlock(trigger_t *trigger, const adc_block_t *block) {
+
+	if (trigger == NULL || block == NULL || block -> samples == NULL) {
+		return 0U;
+	}
+	if (trigger -> state == TRIGGER_IDLE || trigger -> state == TRIGGER_DONE) {
+		return 0U;
+	}
+
+	// samples are stored in swapped pairs
+	uint16_t length = block -> length & ~1U;
+
+	for (uint16_t i = 0U; i < length; i++) {
+		if (triggerPush(trigger, block -> samples[ADC_SAMPLE_INDEX(i)])) {
+			return i + 1U;
+		}
+	}
+
+	return length;
+}
+
+const adc_sample_t* triggerGetFrame(trigger_t *trigger, uint16_t *length) {
+
+	if (trigger == NULL || trigger -> state != TRIGGER_DONE) {
+		return NULL;
+	}
+
+	if (length != NULL) {
+		*length = trigger -> frameLength;
+	}
+
+	return trigger -> frame;
+}
+
+#endif
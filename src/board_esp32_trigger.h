@@ -0,0 +1,149 @@
+/*
+	board_esp32_trigger.h - acquisition trigger for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_TRIGGER_H
+#define BOARD_ESP32_TRIGGER_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_adc.h"
+
+/****************************
+ * Trigger Types
+****************************/
+
+enum TriggerMode {
+	TRIGGER_RISING, // fires when channel crosses up through level
+	TRIGGER_FALLING, // fires when channel crosses down through level
+	TRIGGER_LEVEL_HIGH, // fires on any sample at or above level
+	TRIGGER_LEVEL_LOW, // fires on any sample at or below level
+};
+
+enum TriggerState {
+	TRIGGER_IDLE, // not armed, samples ignored
+	TRIGGER_FILLING, // filling pre trigger history
+	TRIGGER_ARMED, // waiting for trigger condition
+	TRIGGER_POST, // collecting post trigger samples
+	TRIGGER_DONE, // frame ready, samples ignored until armed
+};
+
+struct triggerConfig {
+	enum TriggerMode mode; // condition to fire on
+	uint8_t channel; // ADC1 channel tag to watch, see 'adcPinChannel'
+	uint16_t level; // trigger level in ADC counts
+	uint16_t hysteresis; // counts signal must leave level by before an edge can fire again
+	uint16_t preCount; // samples kept from before trigger
+	uint16_t postCount; // samples collected after trigger, including trigger sample
+};
+
+typedef struct trigger_s {
+	struct triggerConfig config; // trigger settings
+	adc_sample_t *history; // circular pre trigger storage, preCount samples
+	adc_sample_t *frame; // frame storage, preCount + postCount samples
+	uint16_t historyHead; // next history write position
+	uint16_t historyCount; // valid samples in history
+	uint16_t frameLength; // samples stored in frame
+	bool edgeArmed; // signal passed hysteresis band since last edge
+	volatile enum TriggerState state; // current trigger state
+	uint32_t fired; // frames completed since init
+} trigger_t;
+
+/****************************
+ * Trigger Functions
+ *
+ * Samples are raw ADC samples with
+ * channel tags, see 'ADC_SAMPLE_VALUE'
+****************************/
+
+/**
+ * Sets up trigger over user storage
+ *
+ * @param trigger trigger to set up
+ * @param config trigger settings
+ * @param history storage of at least preCount samples, can be NULL if preCount is 0
+ * @param frame storage of at least preCount + postCount samples
+ *
+ * @note trigger starts idle, see 'triggerArm'
+ *
+ * @return if trigger was set up
+ */
+bool triggerInit(trigger_t *trigger, const struct triggerConfig *config, adc_sample_t *history, adc_sample_t *frame);
+
+/**
+ * Clears history and arms trigger for next frame
+ *
+ * @param trigger trigger to arm
+ *
+ * @note may run on a task other than the one feeding samples,
+ * feeds see the cleared history once they see the armed state
+ */
+void triggerArm(trigger_t *trigger);
+
+/**
+ * Feeds one sample into trigger
+ *
+ * @param trigger trigger to feed
+ * @param sample raw sample
+ *
+ * @note safe inside timer ISR
+ *
+ * @return if sample completed a frame
+ */
+bool triggerPush(trigger_t *trigger, adc_sample_t sample);
+
+/**
+ * Feeds samples in time order into trigger
+ *
+ * @param trigger trigger to feed
+ * @param samples samples in time order
+ * @param count amount of samples
+ *
+ * @note stops at end of frame, remaining samples are not used
+ *
+ * @return amount of samples used
+ */
+uint16_t triggerFeed(trigger_t *trigger, const adc_sample_t *samples, uint16_t count);
+
+/**
+ * Feeds DMA block into trigger
+ *
+ * @param trigger trigger to feed
+ * @param block block from capture
+ *
+ * @note stops at end of frame, remaining samples are not used
+ *
+ * @return amount of samples used
+ */
+uint16_t triggerFeedBlock(trigger_t *trigger, const adc_block_t *block);
+
+/**
+ * Gets completed frame
+ *
+ * @param trigger trigger to read
+ * @param length pointer to store amount of samples in frame
+ *
+ * @note trigger sample is at index preCount
+ *
+ * @return frame in time order, NULL if no frame ready
+ */
+const adc_sample_t* triggerGetFrame(trigger_t *trigger, uint16_t *length);
+
+#endif
+#endif
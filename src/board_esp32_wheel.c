@@ -0,0 +1,437 @@
+/*
+	board_esp32_wheel.c - virtual timers for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "board_esp32_wheel.h"
+#include "board_esp32_timer.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <esp_ipc.h>
+
+#define WHEEL_BITS 6U // bits of tick per level
+#define WHEEL_SLOTS (1UL << WHEEL_BITS) // slots per level
+#define WHEEL_MASK (WHEEL_SLOTS - 1U) // slot of tick within level
+#define WHEEL_LEVELS 4U // levels of wheel
+#define WHEEL_RANGE (1UL << (WHEEL_BITS * WHEEL_LEVELS)) // ticks reachable without re-placing
+#define WHEEL_WORD_BITS 32U // bits per occupied word
+#define WHEEL_STACK 4096U // stack size of wheel task
+
+static wheel_link_t slots[WHEEL_LEVELS][WHEEL_SLOTS];
+
+// bit per slot that may hold timers, split in 32-bit words so ISR reads are atomic
+static volatile uint32_t occupied[WHEEL_LEVELS][WHEEL_SLOTS / WHEEL_WORD_BITS];
+
+static uint32_t wheelNow = 0U; // last tick processed by task
+static uint32_t wheelPending = 0U; // timers linked into slots
+static volatile uint32_t wheelTicks = 0U; // last tick counted by ISR
+
+static SemaphoreHandle_t wheelMutex = NULL; // guards slots, held by task between callbacks
+static SemaphoreHandle_t wheelExited = NULL; // given when wheel task exits
+static TaskHandle_t wheelTask = NULL;
+static hard_timer_t wheelTimer = HARD_TIMER_INVALID;
+static volatile bool wheelRunning = false;
+
+/**
+ * Counts tick and wakes wheel task if a slot is due
+ *
+ * @param emptyParams unused
+ *
+ * @return if wheel task was woken
+ */
+static hard_timer_return_t RUN_IN_RAM(wheelISR) wheelISR(hard_timer_param_t emptyParams) {
+
+	uint32_t tick = wheelTicks + 1U;
+	wheelTicks = tick;
+
+	uint32_t index = tick & WHEEL_MASK;
+	bool due = !!(occupied[0][index / WHEEL_WORD_BITS] & (1UL << (index % WHEEL_WORD_BITS)));
+
+	if (index == 0U) {
+		// higher levels cascade down at level 0 wrap
+		for (uint8_t level = 1U; level < WHEEL_LEVELS && !due; level++) {
+			due = (occupied[level][0] | occupied[level][1]) != 0U;
+		}
+	}
+	if (!due) {
+		return false;
+	}
+
+	BaseType_t woken = pdFALSE;
+	vTaskNotifyGiveFromISR(wheelTask, &woken);
+	return woken == pdTRUE;
+}
+
+/**
+ * Converts us into wheel ticks, rounding up
+ *
+ * @param us time in us
+ *
+ * @return ticks
+ */
+static inline uint32_t wheelToTicks(uint32_t us) {
+	return (uint32_t)(((uint64_t)us + WHEEL_TICK_US - 1U) / WHEEL_TICK_US);
+}
+
+/**
+ * Links timer into slot by its expiry
+ *
+ * @param timer timer to place
+ *
+ * @note timers past WHEEL_RANGE go to the last reachable slot and are placed again there
+ */
+static void wheelPlace(wheel_timer_t *timer) {
+
+	uint32_t at = timer -> expires;
+	uint32_t diff = at - wheelNow;
+
+	if (diff >= WHEEL_RANGE) {
+		diff = WHEEL_RANGE - 1U;
+		at = wheelNow + diff;
+	}
+
+	uint8_t level = 0U;
+	while (level < WHEEL_LEVELS - 1U && diff >= (1UL << (WHEEL_BITS * (level + 1U)))) {
+		level++;
+	}
+
+	uint32_t index = (at >> (WHEEL_BITS * level)) & WHEEL_MASK;
+	wheel_link_t *head = &slots[level][index];
+
+	timer -> link.next = head;
+	timer -> link.prev = head -> prev;
+	head -> prev -> next = &timer -> link;
+	head -> prev = &timer -> link;
+
+	occupied[level][index / WHEEL_WORD_BITS] |= (1UL << (index % WHEEL_WORD_BITS));
+	wheelPending++;
+}
+
+/**
+ * Unlinks timer from its slot
+ *
+ * @param timer timer to unlink
+ *
+ * @note slot stays marked occupied until processed, costing one spare wake at most
+ */
+static void wheelUnlink(wheel_timer_t *timer) {
+
+	timer -> link.prev -> next = timer -> link.next;
+	timer -> link.next -> prev = timer -> link.prev;
+	timer -> link.next = NULL;
+	timer -> link.prev = NULL;
+	wheelPending--;
+}
+
+/**
+ * Moves every timer of slot into list
+ *
+ * @param level level of slot
+ * @param index index of slot
+ * @param list empty list head to move timers into
+ */
+static void wheelDetach(uint8_t level, uint32_t index, wheel_link_t *list) {
+
+	wheel_link_t *head = &slots[level][index];
+
+	occupied[level][index / WHEEL_WORD_BITS] &= ~(1UL << (index % WHEEL_WORD_BITS));
+
+	if (head -> next == head) {
+		list -> next = list;
+		list -> prev = list;
+		return;
+	}
+
+	list -> next = head -> next;
+	list -> prev = head -> prev;
+	list -> next -> prev = list;
+	list -> prev -> next = list;
+
+	head -> next = head;
+	head -> prev = head;
+}
+
+/**
+ * Advances wheel one tick and runs timers due
+ *
+ * @note called with wheelMutex held, released around callbacks
+ */
+static void wheelAdvance(void) {
+
+	wheel_link_t list;
+
+	wheelNow++;
+
+	// higher levels move down one level each time the level below wraps
+	uint32_t index = wheelNow & WHEEL_MASK;
+	for (uint8_t level = 1U; index == 0U && level < WHEEL_LEVELS; level++) {
+		index = (wheelNow >> (WHEEL_BITS * level)) & WHEEL_MASK;
+		wheelDetach(level, index, &list);
+		while (list.next != &list) {
+			wheel_timer_t *timer = (wheel_timer_t *)list.next;
+			wheelUnlink(timer);
+			wheelPlace(timer);
+		}
+	}
+
+	wheelDetach(0U, wheelNow & WHEEL_MASK, &list);
+	while (list.next != &list) {
+		wheel_timer_t *timer = (wheel_timer_t *)list.next;
+		wheelUnlink(timer);
+
+		if (timer -> expires != wheelNow) {
+			// long timer parked at end of range
+			wheelPlace(timer);
+			continue;
+		}
+
+		if (timer -> period != 0U) {
+			timer -> expires += timer -> period;
+			wheelPlace(timer);
+		}
+
+		// callback may start or cancel timers, including ones still in list
+		xSemaphoreGive(wheelMutex);
+		timer -> callback(timer -> context);
+		xSemaphoreTake(wheelMutex, portMAX_DELAY);
+	}
+}
+
+/**
+ * Gets ticks after wheelNow with no slot to process
+ *
+ * @note called with wheelMutex held
+ *
+ * @return ticks to skip, UINT32_MAX when no timers are pending
+ */
+static uint32_t wheelIdleTicks(void) {
+
+	if (wheelPending == 0U) {
+		return UINT32_MAX;
+	}
+
+	// occupied level 0 slots from the one after wheelNow, bit n is n + 1 ticks away
+	uint32_t start = (wheelNow + 1U) & WHEEL_MASK;
+	uint64_t level0 = ((uint64_t)occupied[0][1] << WHEEL_WORD_BITS) | occupied[0][0];
+	uint64_t ahead = (start == 0U) ? level0 : (level0 >> start) | (level0 << (WHEEL_SLOTS - start));
+	uint32_t idle = (ahead == 0U) ? UINT32_MAX : (uint32_t)__builtin_ctzll(ahead);
+
+	// higher levels cascade at next level 0 wrap
+	for (uint8_t level = 1U; level < WHEEL_LEVELS; level++) {
+		if ((occupied[level][0] | occupied[level][1]) != 0U) {
+			uint32_t wrap = WHEEL_SLOTS - (wheelNow & WHEEL_MASK) - 1U;
+			return (wrap < idle) ? wrap : idle;
+		}
+	}
+	return idle;
+}
+
+/**
+ * Catches wheel up to ISR ticks whenever woken
+ *
+ * @param params unused
+ */
+static void wheelLoop(void *params) {
+
+	while (true) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if (!wheelRunning) {
+			break;
+		}
+
+		xSemaphoreTake(wheelMutex, portMAX_DELAY);
+		while (wheelNow != wheelTicks) {
+
+			// jump over ticks with nothing due instead of stepping each one
+			uint32_t behind = wheelTicks - wheelNow;
+			uint32_t idle = wheelIdleTicks();
+			if (idle >= behind) {
+				wheelNow += behind;
+				break;
+			}
+			wheelNow += idle;
+			wheelAdvance();
+		}
+		xSemaphoreGive(wheelMutex);
+	}
+
+	xSemaphoreGive(wheelExited);
+	vTaskDelete(NULL);
+}
+
+struct wheelTickStart {
+	hard_timer_t *timer; // pointer to timer ID
+	timer_priority_t priority; // priority of tick ISR
+	bool started; // set once tick timer runs
+};
+
+/**
+ * Starts tick timer, allocating its ISR on core this runs on
+ *
+ * @param arg tick start request
+ */
+static void wheelTickStartOnCore(void *arg) {
+
+	struct wheelTickStart *start = arg;
+	freq_t freq = 1000000U / WHEEL_TICK_US;
+
+	start -> started = setHardTimerRaw(start -> timer, &freq, wheelISR, start -> priority, NULL);
+}
+
+bool wheelStart(hard_timer_t *timer, timer_priority_t priority) {
+
+	if (timer == NULL || wheelTask != NULL) {
+		return false;
+	}
+
+	if (wheelMutex == NULL) {
+		wheelMutex = xSemaphoreCreateMutex();
+		wheelExited = xSemaphoreCreateBinary();
+		if (wheelMutex == NULL || wheelExited == NULL) {
+			return false;
+		}
+		for (uint8_t level = 0U; level < WHEEL_LEVELS; level++) {
+			for (uint32_t i = 0U; i < WHEEL_SLOTS; i++) {
+				slots[level][i].next = &slots[level][i];
+				slots[level][i].prev = &slots[level][i];
+			}
+		}
+	}
+
+	wheelRunning = true;
+	if (xTaskCreatePinnedToCore(wheelLoop, "wheel", WHEEL_STACK, NULL, WHEEL_PRIORITY, &wheelTask, WHEEL_CORE) != pdPASS) {
+		wheelRunning = false;
+		wheelTask = NULL;
+		return false;
+	}
+
+	// tick ISR shares WHEEL_CORE with wheel task
+	struct wheelTickStart start = {
+		.timer = timer,
+		.priority = priority,
+		.started = false,
+	};
+	if (xPortGetCoreID() != WHEEL_CORE) {
+		esp_ipc_call_blocking(WHEEL_CORE, wheelTickStartOnCore, &start);
+	}
+	else {
+		wheelTickStartOnCore(&start);
+	}
+	if (!start.started) {
+		wheelStop();
+		return false;
+	}
+	wheelTimer = *timer;
+
+	return true;
+}
+
+bool wheelStop(void) {
+
+	if (wheelTask == NULL) {
+		return false;
+	}
+
+	if (wheelTimer != HARD_TIMER_INVALID) {
+		cancelHardTimer(wheelTimer);
+		wheelTimer = HARD_TIMER_INVALID;
+	}
+
+	wheelRunning = false;
+	xTaskNotifyGive(wheelTask);
+	xSemaphoreTake(wheelExited, portMAX_DELAY);
+	wheelTask = NULL;
+
+	return true;
+}
+
+void wheelTimerInit(wheel_timer_t *timer, wheel_callback_t callback, void *context) {
+
+	if (timer == NULL) {
+		return;
+	}
+
+	timer -> link.next = NULL;
+	timer -> link.prev = NULL;
+	timer -> expires = 0U;
+	timer -> period = 0U;
+	timer -> callback = callback;
+	timer -> context = context;
+}
+
+bool wheelTimerStart(wheel_timer_t *timer, uint32_t delayUS, uint32_t periodUS) {
+
+	if (timer == NULL || timer -> callback == NULL || wheelMutex == NULL) {
+		return false;
+	}
+
+	uint32_t delay = wheelToTicks(delayUS);
+	if (delay == 0U) {
+		delay = 1U;
+	}
+
+	xSemaphoreTake(wheelMutex, portMAX_DELAY);
+
+	if (timer -> link.next != NULL) {
+		wheelUnlink(timer);
+	}
+
+	// counted from ISR tick, wheel task may still be catching up
+	timer -> expires = wheelTicks + delay;
+	timer -> period = wheelToTicks(periodUS);
+	wheelPlace(timer);
+
+	bool missed = (int32_t)(timer -> expires - wheelTicks) <= 0;
+
+	xSemaphoreGive(wheelMutex);
+
+	// ISR may have passed slot before it was marked
+	if (missed && wheelTask != NULL) {
+		xTaskNotifyGive(wheelTask);
+	}
+
+	return true;
+}
+
+bool wheelTimerCancel(wheel_timer_t *timer) {
+
+	if (timer == NULL || wheelMutex == NULL) {
+		return false;
+	}
+
+	xSemaphoreTake(wheelMutex, portMAX_DELAY);
+
+	bool pending = timer -> link.next != NULL;
+	if (pending) {
+		wheelUnlink(timer);
+	}
+
+	xSemaphoreGive(wheelMutex);
+
+	return pending;
+}
+
+bool wheelTimerActive(const wheel_timer_t *timer) {
+	return timer != NULL && timer -> link.next != NULL;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+	board_esp32_wheel.h - virtual timers for Espressif ESP32
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOARD_ESP32_WHEEL_H
+#define BOARD_ESP32_WHEEL_H
+
+#include "../board.h"
+
+#ifdef ESP32DEVC
+
+#include "../../hard_timer.h"
+
+/****************************
+ * Virtual Timer Types
+ *
+ * Software timers on one hardware timer,
+ * kept in a hierarchical timing wheel so
+ * start and cancel are O(1) at any count
+****************************/
+
+/**
+ * Runs when virtual timer expires
+ *
+ * @param context user context of timer
+ *
+ * @note runs in wheel task on WHEEL_CORE, not in ISR
+ */
+typedef void (*wheel_callback_t)(void *context);
+
+typedef struct wheel_link_s {
+	struct wheel_link_s *next; // next timer in slot
+	struct wheel_link_s *prev; // previous timer in slot
+} wheel_link_t;
+
+typedef struct wheel_timer_s {
+	wheel_link_t link; // slot list links, first so slots hold timers directly
+	uint32_t expires; // wheel tick of expiry
+	uint32_t period; // ticks between runs, 0 for one shot
+	wheel_callback_t callback; // function to run
+	void *context; // user context passed to callback
+} wheel_timer_t;
+
+/****************************
+ * Virtual Timer Functions
+****************************/
+
+/**
+ * Starts wheel on hardware timer
+ *
+ * @param timer pointer to timer ID
+ * @param priority priority of tick ISR
+ *
+ * @note ticks every WHEEL_TICK_US, tick ISR is allocated on WHEEL_CORE
+ *
+ * @return if wheel was started
+ */
+bool wheelStart(hard_timer_t *timer, timer_priority_t priority);
+
+/**
+ * Stops wheel and its hardware timer
+ *
+ * @note timers stay in wheel and resume on next start
+ *
+ * @return if wheel was stopped
+ */
+bool wheelStop(void);
+
+/**
+ * Sets up virtual timer
+ *
+ * @param timer timer storage, owned by caller
+ * @param callback function to run
+ * @param context user context passed to callback
+ */
+void wheelTimerInit(wheel_timer_t *timer, wheel_callback_t callback, void *context);
+
+/**
+ * Starts or restarts virtual timer
+ *
+ * @param timer timer to start
+ * @param delayUS time until first run
+ * @param periodUS time between later runs, 0 for one shot
+ *
+ * @note times round up to WHEEL_TICK_US
+ *
+ * @return if timer was started
+ */
+bool wheelTimerStart(wheel_timer_t *timer, uint32_t delayUS, uint32_t periodUS);
+
+/**
+ * Cancels virtual timer
+ *
+ * @param timer timer to cancel
+ *
+ * @return if timer was pending
+ */
+bool wheelTimerCancel(wheel_timer_t *timer);
+
+/**
+ * Checks if virtual timer is pending
+ *
+ * @param timer timer to check
+ *
+ * @return if timer is pending
+ */
+bool wheelTimerActive(const wheel_timer_t *timer);
+
+#endif
+#endif
@@ -0,0 +1,221 @@
+/*
+	fake.h - controls of host fakes for IDF and FreeRTOS
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef FAKE_H
+#define FAKE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/****************************
+ * FreeRTOS
+****************************/
+
+/**
+ * Sets core reported to calling thread by 'xPortGetCoreID'
+ *
+ * @param core core number
+ */
+void fakeSetCore(int core);
+
+/****************************
+ * ESP System
+****************************/
+
+/**
+ * Gets interrupts allocated with 'esp_intr_alloc' and not freed
+ *
+ * @return amount of live interrupts
+ */
+uint32_t fakeIntrLive(void);
+
+/**
+ * Gets core last interrupt was allocated from
+ *
+ * @return core number, -1 if none allocated
+ */
+int fakeIntrLastCore(void);
+
+/**
+ * Runs handler allocated to an interrupt source, like hardware raising it
+ *
+ * @param source interrupt source
+ *
+ * @return if a handler was allocated to source
+ */
+bool fakeIntrFire(int source);
+
+/****************************
+ * I2S ADC DMA
+****************************/
+
+/**
+ * Completes one DMA buffer of the installed I2S driver
+ *
+ * @param samples raw samples as hardware stores them
+ * @param count amount of samples, at most the DMA buffer length
+ *
+ * @note drops oldest unread buffer and posts I2S_EVENT_RX_Q_OVF when every buffer is unread
+ *
+ * @return if driver is installed
+ */
+bool fakeI2sDmaFill(const uint16_t *samples, uint16_t count);
+
+/**
+ * Holds 'i2s_read' callers until released
+ *
+ * @param stall if reads are held
+ */
+void fakeI2sStall(bool stall);
+
+/**
+ * Gets whether I2S driver is installed
+ *
+ * @return if installed
+ */
+bool fakeI2sInstalled(void);
+
+/****************************
+ * UART
+****************************/
+
+/**
+ * Makes 'uart_driver_install' fail, like a driver out of memory
+ *
+ * @param fail if install fails
+ */
+void fakeUartFailInstall(bool fail);
+
+/**
+ * Sets free TX buffer bytes reported by 'uart_get_tx_buffer_free_size'
+ *
+ * @param size free bytes
+ */
+void fakeUartSetTxFree(size_t size);
+
+/**
+ * Gets bytes written since last take and starts capture over
+ *
+ * @param bytes pointer to store captured bytes, valid until next write
+ * @param writes pointer to store calls of 'uart_write_bytes', can be NULL
+ *
+ * @return amount of captured bytes
+ */
+size_t fakeUartTake(const uint8_t **bytes, uint32_t *writes);
+
+/****************************
+ * Timer Groups
+****************************/
+
+/**
+ * Timer state seen by tests
+ */
+struct fakeTimerState {
+	bool initialized;
+	bool running;
+	bool alarmEnabled;
+	bool autoReload;
+	uint32_t divider;
+	uint64_t counter;
+	uint64_t alarm;
+	uint64_t load; // value copied into counter at reload
+	uint32_t alarms; // alarms raised since init
+};
+
+/**
+ * Raises alarm of a timer now, like counter reaching alarm value
+ *
+ * @param group timer group
+ * @param num timer number
+ *
+ * @note counter reloads, then driver callback or raw handler runs on calling thread
+ *
+ * @return if timer was running with alarm enabled
+ */
+bool fakeTimerAlarm(int group, int num);
+
+/**
+ * Sets time each register write takes to land, like a slow peripheral bus
+ *
+ * @param ns busy wait after each write
+ */
+void fakeTimerSetRegDelay(uint32_t ns);
+
+/**
+ * Gets state of a timer
+ *
+ * @param group timer group
+ * @param num timer number
+ * @param state pointer to store state
+ */
+void fakeTimerGetState(int group, int num, struct fakeTimerState *state);
+
+/****************************
+ * NVS
+****************************/
+
+/**
+ * Flash operations seen by tests
+ */
+struct fakeNvsCounts {
+	uint32_t gets; // reads, missing keys counted
+	uint32_t sets; // writes of values, strings and blobs
+	uint32_t commits;
+	uint32_t erases; // keys erased
+	uint32_t flashErases; // whole partition erases
+	uint32_t entries; // 32 byte entries written
+	uint32_t overlaps; // calls that ran beside a write
+};
+
+/**
+ * Gets flash operations since last reset
+ *
+ * @param counts pointer to store counts
+ */
+void fakeNvsGetCounts(struct fakeNvsCounts *counts);
+
+/**
+ * Starts flash operation counts over
+ */
+void fakeNvsResetCounts(void);
+
+/**
+ * Gets whether a key is stored with any type
+ *
+ * @param key name of key
+ *
+ * @return if key is stored
+ */
+bool fakeNvsHas(const char *key);
+
+/**
+ * Sets time each NVS call takes, like flash access
+ *
+ * @param us sleep inside each call
+ */
+void fakeNvsSetDelay(uint32_t us);
+
+/**
+ * Makes writes, erases of keys and commits fail like worn out flash
+ *
+ * @param fail if they fail
+ */
+void fakeNvsFailWrites(bool fail);
+
+#endif
@@ -0,0 +1,309 @@
+/*
+	fake_esp.c - ESP system services for host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include "fake.h"
+
+#include <esp_timer.h>
+#include <esp_intr_alloc.h>
+#include <esp_ipc.h>
+#include <rom/ets_sys.h>
+#include <xtensa/hal.h>
+#include <freertos/FreeRTOS.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FAKE_CPU_MHZ 240U // CPU clock reported to board files
+
+struct esp_timer {
+	esp_timer_create_args_t args;
+	pthread_mutex_t mutex;
+	uint32_t generation; // bumped by start and stop, stale sleepers skip callback
+	bool active;
+};
+
+struct intr_handle_data_t {
+	int source;
+	intr_handler_t handler;
+	void *arg;
+	struct intr_handle_data_t *next;
+};
+
+typedef struct fake_shot_s {
+	esp_timer_handle_t timer;
+	uint32_t generation;
+	uint64_t us;
+} fake_shot_t;
+
+typedef struct fake_ipc_s {
+	esp_ipc_func_t function;
+	void *arg;
+	int core;
+} fake_ipc_t;
+
+static uint32_t intrLive = 0U;
+static int intrCore = -1;
+static intr_handle_t intrList = NULL; // live handles, newest first
+static pthread_mutex_t intrMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Gets time since an arbitrary point
+ *
+ * @return nanoseconds
+ */
+static uint64_t fakeNowNS(void) {
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/****************************
+ * Clocks
+****************************/
+
+int64_t esp_timer_get_time(void) {
+	return (int64_t)(fakeNowNS() / 1000ULL);
+}
+
+uint32_t xthal_get_ccount(void) {
+	return (uint32_t)(fakeNowNS() * FAKE_CPU_MHZ / 1000ULL);
+}
+
+uint32_t ets_get_cpu_frequency(void) {
+	return FAKE_CPU_MHZ;
+}
+
+/****************************
+ * ESP Timer
+****************************/
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out) {
+
+	if (args == NULL || out == NULL) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	esp_timer_handle_t timer = calloc(1U, sizeof(struct esp_timer));
+	if (timer == NULL) {
+		return ESP_ERR_NO_MEM;
+	}
+	timer -> args = *args;
+	pthread_mutex_init(&timer -> mutex, NULL);
+	*out = timer;
+
+	return ESP_OK;
+}
+
+/**
+ * Sleeps then runs timer callback unless timer was restarted or stopped
+ *
+ * @param params shot from 'esp_timer_start_once'
+ *
+ * @return unused
+ */
+static void *fakeTimerShot(void *params) {
+
+	fake_shot_t *shot = params;
+	esp_timer_handle_t timer = shot -> timer;
+
+	usleep((useconds_t)shot -> us);
+
+	pthread_mutex_lock(&timer -> mutex);
+	bool fire = timer -> active && timer -> generation == shot -> generation;
+	if (fire) {
+		timer -> active = false;
+	}
+	pthread_mutex_unlock(&timer -> mutex);
+
+	if (fire) {
+		timer -> args.callback(timer -> args.arg);
+	}
+	free(shot);
+
+	return NULL;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t us) {
+
+	fake_shot_t *shot = malloc(sizeof(fake_shot_t));
+	if (shot == NULL) {
+		return ESP_ERR_NO_MEM;
+	}
+
+	pthread_mutex_lock(&timer -> mutex);
+	if (timer -> active) {
+		pthread_mutex_unlock(&timer -> mutex);
+		free(shot);
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer -> active = true;
+	shot -> generation = ++timer -> generation;
+	pthread_mutex_unlock(&timer -> mutex);
+
+	shot -> timer = timer;
+	shot -> us = us;
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, fakeTimerShot, shot);
+	pthread_detach(thread);
+
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+
+	pthread_mutex_lock(&timer -> mutex);
+	bool active = timer -> active;
+	timer -> active = false;
+	timer -> generation++;
+	pthread_mutex_unlock(&timer -> mutex);
+
+	return active ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+
+	pthread_mutex_lock(&timer -> mutex);
+	bool active = timer -> active;
+	pthread_mutex_unlock(&timer -> mutex);
+
+	return active;
+}
+
+/****************************
+ * Interrupts
+****************************/
+
+esp_err_t esp_intr_alloc(int source, int flags, intr_handler_t handler, void *arg, intr_handle_t *ret_handle) {
+
+	intr_handle_t handle = calloc(1U, sizeof(struct intr_handle_data_t));
+	if (handle == NULL) {
+		return ESP_ERR_NO_MEM;
+	}
+	handle -> source = source;
+	handle -> handler = handler;
+	handle -> arg = arg;
+
+	pthread_mutex_lock(&intrMutex);
+	handle -> next = intrList;
+	intrList = handle;
+	pthread_mutex_unlock(&intrMutex);
+
+	__atomic_add_fetch(&intrLive, 1U, __ATOMIC_RELAXED);
+	__atomic_store_n(&intrCore, xPortGetCoreID(), __ATOMIC_RELAXED);
+
+	if (ret_handle != NULL) {
+		*ret_handle = handle;
+	}
+	return ESP_OK;
+}
+
+esp_err_t esp_intr_free(intr_handle_t handle) {
+
+	if (handle == NULL) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	pthread_mutex_lock(&intrMutex);
+	for (intr_handle_t *link = &intrList; *link != NULL; link = &(*link) -> next) {
+		if (*link == handle) {
+			*link = handle -> next;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&intrMutex);
+
+	free(handle);
+	__atomic_sub_fetch(&intrLive, 1U, __ATOMIC_RELAXED);
+
+	return ESP_OK;
+}
+
+uint32_t fakeIntrLive(void) {
+	return __atomic_load_n(&intrLive, __ATOMIC_RELAXED);
+}
+
+int fakeIntrLastCore(void) {
+	return __atomic_load_n(&intrCore, __ATOMIC_RELAXED);
+}
+
+bool fakeIntrFire(int source) {
+
+	intr_handler_t handler = NULL;
+	void *arg = NULL;
+
+	pthread_mutex_lock(&intrMutex);
+	for (intr_handle_t handle = intrList; handle != NULL; handle = handle -> next) {
+		if (handle -> source == source) {
+			handler = handle -> handler;
+			arg = handle -> arg;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&intrMutex);
+
+	if (handler == NULL) {
+		return false;
+	}
+	handler(arg);
+	return true;
+}
+
+/****************************
+ * Inter Processor Calls
+****************************/
+
+/**
+ * Runs IPC function as if on the other core
+ *
+ * @param params call from 'esp_ipc_call_blocking'
+ *
+ * @return unused
+ */
+static void *fakeIpcEntry(void *params) {
+
+	fake_ipc_t *call = params;
+
+	fakeSetCore(call -> core);
+	call -> function(call -> arg);
+
+	return NULL;
+}
+
+esp_err_t esp_ipc_call_blocking(uint32_t cpu_id, esp_ipc_func_t func, void *arg) {
+
+	fake_ipc_t call = {
+		.function = func,
+		.arg = arg,
+		.core = (int)cpu_id,
+	};
+
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, fakeIpcEntry, &call) != 0) {
+		return ESP_FAIL;
+	}
+	pthread_join(thread, NULL);
+
+	return ESP_OK;
+}
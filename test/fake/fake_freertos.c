@@ -0,0 +1,494 @@
+/*
+	fake_freertos.c - FreeRTOS on POSIX threads for host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include "fake.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+
+typedef struct fake_queue_s {
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	UBaseType_t length; // max items
+	UBaseType_t size; // bytes per item, 0 for semaphores
+	UBaseType_t head; // oldest item
+	UBaseType_t count; // items stored
+	uint8_t *items;
+	bool recursive; // recursive mutex
+	pthread_t owner; // holder of recursive mutex
+	UBaseType_t depth; // recursive takes by holder
+} fake_queue_t;
+
+typedef struct fake_task_s {
+	TaskFunction_t function;
+	void *params;
+	int core;
+	pthread_mutex_t mutex;
+	pthread_cond_t notified;
+	uint32_t notifications;
+} fake_task_t;
+
+// every core's spinlocks are one lock, nesting like the ISR masks do
+static pthread_mutex_t critical;
+static pthread_once_t criticalOnce = PTHREAD_ONCE_INIT;
+
+static __thread fake_task_t *currentTask = NULL;
+
+/**
+ * Makes critical section lock recursive
+ */
+static void criticalInit(void) {
+
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&critical, &attr);
+	pthread_mutexattr_destroy(&attr);
+}
+
+/**
+ * Makes condition usable with 'fakeDeadline'
+ *
+ * @param cond condition to set up
+ */
+static void fakeCondInit(pthread_cond_t *cond) {
+
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+/**
+ * Gets task running on this thread
+ *
+ * @return task, threads not made by 'xTaskCreatePinnedToCore' get one on first use
+ */
+static fake_task_t *fakeSelf(void) {
+
+	if (currentTask == NULL) {
+		currentTask = calloc(1U, sizeof(fake_task_t));
+		pthread_mutex_init(&currentTask -> mutex, NULL);
+		fakeCondInit(&currentTask -> notified);
+	}
+	return currentTask;
+}
+
+/**
+ * Converts ticks to deadline of a condition wait
+ *
+ * @param deadline pointer to store deadline
+ * @param wait ticks to wait
+ */
+static void fakeDeadline(struct timespec *deadline, TickType_t wait) {
+
+	clock_gettime(CLOCK_MONOTONIC, deadline);
+	deadline -> tv_sec += wait / 1000U;
+	deadline -> tv_nsec += (long)(wait % 1000U) * 1000000L;
+	if (deadline -> tv_nsec >= 1000000000L) {
+		deadline -> tv_sec++;
+		deadline -> tv_nsec -= 1000000000L;
+	}
+}
+
+/**
+ * Waits on condition until deadline
+ *
+ * @param cond condition to wait on
+ * @param mutex mutex held by caller
+ * @param wait ticks given to call, portMAX_DELAY waits forever
+ * @param deadline deadline from 'fakeDeadline'
+ *
+ * @return if deadline was not reached
+ */
+static bool fakeWait(pthread_cond_t *cond, pthread_mutex_t *mutex, TickType_t wait, const struct timespec *deadline) {
+
+	if (wait == 0U) {
+		return false;
+	}
+	if (wait == portMAX_DELAY) {
+		pthread_cond_wait(cond, mutex);
+		return true;
+	}
+	return pthread_cond_timedwait(cond, mutex, deadline) != ETIMEDOUT;
+}
+
+/****************************
+ * Critical Sections
+****************************/
+
+void taskENTER_CRITICAL(portMUX_TYPE *mux) {
+	pthread_once(&criticalOnce, criticalInit);
+	pthread_mutex_lock(&critical);
+}
+
+void taskEXIT_CRITICAL(portMUX_TYPE *mux) {
+	pthread_mutex_unlock(&critical);
+}
+
+void portENTER_CRITICAL_ISR(portMUX_TYPE *mux) {
+	taskENTER_CRITICAL(mux);
+}
+
+void portEXIT_CRITICAL_ISR(portMUX_TYPE *mux) {
+	taskEXIT_CRITICAL(mux);
+}
+
+void vPortCPUInitializeMutex(portMUX_TYPE *mux) {
+	mux -> owner = 0U;
+	mux -> count = 0U;
+}
+
+void portYIELD_FROM_ISR(void) {
+}
+
+int xPortGetCoreID(void) {
+	return fakeSelf() -> core;
+}
+
+void fakeSetCore(int core) {
+	fakeSelf() -> core = core;
+}
+
+/****************************
+ * Tasks
+****************************/
+
+TickType_t xTaskGetTickCount(void) {
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (TickType_t)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+/**
+ * Runs task function on its own thread
+ *
+ * @param params task being started
+ *
+ * @return unused
+ */
+static void *fakeTaskEntry(void *params) {
+
+	currentTask = params;
+	currentTask -> function(currentTask -> params);
+
+	return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stack, void *params, UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+
+	fake_task_t *task = calloc(1U, sizeof(fake_task_t));
+	if (task == NULL) {
+		return pdFALSE;
+	}
+	task -> function = function;
+	task -> params = params;
+	task -> core = (core == tskNO_AFFINITY) ? 0 : core;
+	pthread_mutex_init(&task -> mutex, NULL);
+	fakeCondInit(&task -> notified);
+
+	if (handle != NULL) {
+		*handle = task;
+	}
+
+	pthread_t thread;
+	if (pthread_create(&thread, NULL, fakeTaskEntry, task) != 0) {
+		free(task);
+		return pdFALSE;
+	}
+	pthread_detach(thread);
+
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+
+	// only self deletion is used by board files, task memory is left to exit
+	if (task == NULL || task == fakeSelf()) {
+		pthread_exit(NULL);
+	}
+}
+
+void vTaskDelay(TickType_t ticks) {
+	usleep((useconds_t)ticks * 1000U);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return fakeSelf();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait) {
+
+	fake_task_t *task = fakeSelf();
+	struct timespec deadline;
+	fakeDeadline(&deadline, wait);
+
+	pthread_mutex_lock(&task -> mutex);
+	while (task -> notifications == 0U) {
+		if (!fakeWait(&task -> notified, &task -> mutex, wait, &deadline)) {
+			break;
+		}
+	}
+	uint32_t value = task -> notifications;
+	if (value > 0U) {
+		task -> notifications = clear ? 0U : value - 1U;
+	}
+	pthread_mutex_unlock(&task -> mutex);
+
+	return value;
+}
+
+void xTaskNotifyGive(TaskHandle_t handle) {
+
+	fake_task_t *task = handle;
+
+	pthread_mutex_lock(&task -> mutex);
+	task -> notifications++;
+	pthread_cond_broadcast(&task -> notified);
+	pthread_mutex_unlock(&task -> mutex);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t handle, BaseType_t *woken) {
+
+	xTaskNotifyGive(handle);
+	if (woken != NULL) {
+		*woken = pdTRUE;
+	}
+}
+
+/****************************
+ * Queues
+****************************/
+
+/**
+ * Makes queue, semaphores are queues with empty items
+ *
+ * @param length max items
+ * @param size bytes per item
+ * @param count items already stored
+ *
+ * @return queue, NULL if out of memory
+ */
+static fake_queue_t *fakeQueueCreate(UBaseType_t length, UBaseType_t size, UBaseType_t count) {
+
+	fake_queue_t *queue = calloc(1U, sizeof(fake_queue_t));
+	if (queue == NULL) {
+		return NULL;
+	}
+	queue -> items = calloc(length, size > 0U ? size : 1U);
+	if (queue -> items == NULL) {
+		free(queue);
+		return NULL;
+	}
+	queue -> length = length;
+	queue -> size = size;
+	queue -> count = count;
+	pthread_mutex_init(&queue -> mutex, NULL);
+	fakeCondInit(&queue -> changed);
+
+	return queue;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t size) {
+	return fakeQueueCreate(length, size, 0U);
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void *item, TickType_t wait) {
+
+	fake_queue_t *queue = handle;
+	struct timespec deadline;
+	fakeDeadline(&deadline, wait);
+
+	pthread_mutex_lock(&queue -> mutex);
+	while (queue -> count == queue -> length) {
+		if (!fakeWait(&queue -> changed, &queue -> mutex, wait, &deadline)) {
+			pthread_mutex_unlock(&queue -> mutex);
+			return pdFALSE;
+		}
+	}
+	if (queue -> size > 0U) {
+		UBaseType_t tail = (queue -> head + queue -> count) % queue -> length;
+		memcpy(queue -> items + tail * queue -> size, item, queue -> size);
+	}
+	queue -> count++;
+	pthread_cond_broadcast(&queue -> changed);
+	pthread_mutex_unlock(&queue -> mutex);
+
+	return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t handle, const void *item, BaseType_t *woken) {
+
+	if (woken != NULL) {
+		*woken = pdFALSE;
+	}
+	return xQueueSend(handle, item, 0U);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void *item, TickType_t wait) {
+
+	fake_queue_t *queue = handle;
+	struct timespec deadline;
+	fakeDeadline(&deadline, wait);
+
+	pthread_mutex_lock(&queue -> mutex);
+	while (queue -> count == 0U) {
+		if (!fakeWait(&queue -> changed, &queue -> mutex, wait, &deadline)) {
+			pthread_mutex_unlock(&queue -> mutex);
+			return pdFALSE;
+		}
+	}
+	if (queue -> size > 0U) {
+		memcpy(item, queue -> items + queue -> head * queue -> size, queue -> size);
+	}
+	queue -> head = (queue -> head + 1U) % queue -> length;
+	queue -> count--;
+	pthread_cond_broadcast(&queue -> changed);
+	pthread_mutex_unlock(&queue -> mutex);
+
+	return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t handle) {
+
+	fake_queue_t *queue = handle;
+
+	pthread_mutex_lock(&queue -> mutex);
+	queue -> head = 0U;
+	queue -> count = 0U;
+	pthread_cond_broadcast(&queue -> changed);
+	pthread_mutex_unlock(&queue -> mutex);
+
+	return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+
+	fake_queue_t *queue = handle;
+
+	pthread_mutex_lock(&queue -> mutex);
+	UBaseType_t count = queue -> count;
+	pthread_mutex_unlock(&queue -> mutex);
+
+	return count;
+}
+
+void vQueueDelete(QueueHandle_t handle) {
+
+	fake_queue_t *queue = handle;
+
+	free(queue -> items);
+	free(queue);
+}
+
+/****************************
+ * Semaphores
+****************************/
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+	return fakeQueueCreate(1U, 0U, 0U);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+	return fakeQueueCreate(1U, 0U, 1U);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+	return fakeQueueCreate(max, 0U, initial);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer) {
+	return xSemaphoreCreateBinary();
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic(StaticSemaphore_t *buffer) {
+
+	fake_queue_t *queue = fakeQueueCreate(1U, 0U, 1U);
+	if (queue != NULL) {
+		queue -> recursive = true;
+	}
+	return queue;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t wait) {
+	return xQueueReceive(semaphore, NULL, wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+	return xQueueSend(semaphore, NULL, 0U);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *woken) {
+	return xQueueSendFromISR(semaphore, NULL, woken);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+	vQueueDelete(semaphore);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semaphore, TickType_t wait) {
+
+	fake_queue_t *queue = semaphore;
+
+	pthread_mutex_lock(&queue -> mutex);
+	bool held = queue -> depth > 0U && pthread_equal(queue -> owner, pthread_self());
+	pthread_mutex_unlock(&queue -> mutex);
+
+	if (!held && xQueueReceive(semaphore, NULL, wait) != pdTRUE) {
+		return pdFALSE;
+	}
+
+	pthread_mutex_lock(&queue -> mutex);
+	queue -> owner = pthread_self();
+	queue -> depth++;
+	pthread_mutex_unlock(&queue -> mutex);
+
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semaphore) {
+
+	fake_queue_t *queue = semaphore;
+
+	pthread_mutex_lock(&queue -> mutex);
+	if (queue -> depth == 0U || !pthread_equal(queue -> owner, pthread_self())) {
+		pthread_mutex_unlock(&queue -> mutex);
+		return pdFALSE;
+	}
+	bool release = --queue -> depth == 0U;
+	pthread_mutex_unlock(&queue -> mutex);
+
+	if (release) {
+		xQueueSend(semaphore, NULL, 0U);
+	}
+	return pdTRUE;
+}
@@ -0,0 +1,224 @@
+/*
+	fake_i2s.c - I2S ADC DMA driver for host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include "fake.h"
+
+#include <driver/i2s.h>
+#include <driver/adc.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+// DMA buffers rotate like the IDF driver, oldest unread is dropped on overflow
+static struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t changed;
+	bool installed;
+	bool stalled; // reads held by test
+	QueueHandle_t events;
+	uint16_t *buffers; // bufferCount * bufferLength samples
+	uint16_t *lengths; // samples in each buffer
+	int bufferCount;
+	int bufferLength;
+	int head; // oldest unread buffer
+	int filled; // unread buffers
+	uint32_t sampleRate;
+} dma = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.changed = PTHREAD_COND_INITIALIZER,
+};
+
+esp_err_t i2s_driver_install(i2s_port_t port, const i2s_config_t *config, int queueSize, void *queue) {
+
+	if (config == NULL || config -> dma_buf_count < 2 || config -> dma_buf_len <= 0) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	pthread_mutex_lock(&dma.mutex);
+	if (dma.installed) {
+		pthread_mutex_unlock(&dma.mutex);
+		return ESP_ERR_INVALID_STATE;
+	}
+
+	dma.bufferCount = config -> dma_buf_count;
+	dma.bufferLength = config -> dma_buf_len;
+	dma.buffers = calloc((size_t)dma.bufferCount * (size_t)dma.bufferLength, sizeof(uint16_t));
+	dma.lengths = calloc((size_t)dma.bufferCount, sizeof(uint16_t));
+	dma.events = xQueueCreate((UBaseType_t)queueSize, sizeof(i2s_event_t));
+	dma.head = 0;
+	dma.filled = 0;
+	dma.sampleRate = config -> sample_rate;
+	dma.installed = true;
+
+	if (queue != NULL) {
+		*(QueueHandle_t *)queue = dma.events;
+	}
+	pthread_mutex_unlock(&dma.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t i2s_driver_uninstall(i2s_port_t port) {
+
+	pthread_mutex_lock(&dma.mutex);
+	if (!dma.installed) {
+		pthread_mutex_unlock(&dma.mutex);
+		return ESP_ERR_INVALID_STATE;
+	}
+	dma.installed = false;
+	vQueueDelete(dma.events);
+	dma.events = NULL;
+	free(dma.buffers);
+	free(dma.lengths);
+	dma.buffers = NULL;
+	dma.lengths = NULL;
+	pthread_cond_broadcast(&dma.changed);
+	pthread_mutex_unlock(&dma.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t i2s_read(i2s_port_t port, void *dest, size_t size, size_t *read, TickType_t wait) {
+
+	struct timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += wait / 1000U;
+	deadline.tv_nsec += (long)(wait % 1000U) * 1000000L;
+	if (deadline.tv_nsec >= 1000000000L) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000L;
+	}
+
+	pthread_mutex_lock(&dma.mutex);
+	while (dma.installed && (dma.stalled || dma.filled == 0)) {
+		if (dma.stalled) {
+			// stalls ignore the wait so tests decide when reads finish
+			pthread_cond_wait(&dma.changed, &dma.mutex);
+		}
+		else if (pthread_cond_timedwait(&dma.changed, &dma.mutex, &deadline) == ETIMEDOUT) {
+			break;
+		}
+	}
+
+	size_t copied = 0U;
+	if (dma.installed && dma.filled > 0) {
+		size_t available = (size_t)dma.lengths[dma.head] * sizeof(uint16_t);
+		copied = size < available ? size : available;
+		memcpy(dest, dma.buffers + (size_t)dma.head * (size_t)dma.bufferLength, copied);
+		dma.head = (dma.head + 1) % dma.bufferCount;
+		dma.filled--;
+	}
+	pthread_mutex_unlock(&dma.mutex);
+
+	if (read != NULL) {
+		*read = copied;
+	}
+	return copied > 0U ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+bool fakeI2sDmaFill(const uint16_t *samples, uint16_t count) {
+
+	pthread_mutex_lock(&dma.mutex);
+	if (!dma.installed || count > dma.bufferLength) {
+		pthread_mutex_unlock(&dma.mutex);
+		return false;
+	}
+
+	i2s_event_t event = {.type = I2S_EVENT_RX_DONE, .size = (size_t)count * sizeof(uint16_t)};
+
+	if (dma.filled == dma.bufferCount) {
+		dma.head = (dma.head + 1) % dma.bufferCount;
+		dma.filled--;
+		i2s_event_t overflow = {.type = I2S_EVENT_RX_Q_OVF, .size = 0U};
+		xQueueSend(dma.events, &overflow, 0U);
+	}
+
+	int tail = (dma.head + dma.filled) % dma.bufferCount;
+	memcpy(dma.buffers + (size_t)tail * (size_t)dma.bufferLength, samples, (size_t)count * sizeof(uint16_t));
+	dma.lengths[tail] = count;
+	dma.filled++;
+	xQueueSend(dma.events, &event, 0U);
+
+	pthread_cond_broadcast(&dma.changed);
+	pthread_mutex_unlock(&dma.mutex);
+
+	return true;
+}
+
+void fakeI2sStall(bool stall) {
+
+	pthread_mutex_lock(&dma.mutex);
+	dma.stalled = stall;
+	pthread_cond_broadcast(&dma.changed);
+	pthread_mutex_unlock(&dma.mutex);
+}
+
+bool fakeI2sInstalled(void) {
+
+	pthread_mutex_lock(&dma.mutex);
+	bool installed = dma.installed;
+	pthread_mutex_unlock(&dma.mutex);
+
+	return installed;
+}
+
+esp_err_t i2s_set_adc_mode(adc_unit_t unit, adc1_channel_t channel) {
+	return ESP_OK;
+}
+
+esp_err_t i2s_adc_enable(i2s_port_t port) {
+	return ESP_OK;
+}
+
+esp_err_t i2s_adc_disable(i2s_port_t port) {
+	return ESP_OK;
+}
+
+esp_err_t i2s_set_sample_rates(i2s_port_t port, uint32_t rate) {
+	dma.sampleRate = rate;
+	return ESP_OK;
+}
+
+float i2s_get_clk(i2s_port_t port) {
+	return (float)dma.sampleRate;
+}
+
+esp_err_t i2s_zero_dma_buffer(i2s_port_t port) {
+	return ESP_OK;
+}
+
+esp_err_t adc1_config_width(adc_bits_width_t width) {
+	return ESP_OK;
+}
+
+esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten) {
+	return ESP_OK;
+}
+
+esp_err_t adc_digi_init(void) {
+	return ESP_OK;
+}
+
+esp_err_t adc_digi_controller_config(const adc_digi_config_t *config) {
+	return config != NULL && config -> adc1_pattern_len > 0U ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
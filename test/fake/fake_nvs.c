@@ -0,0 +1,442 @@
+/*
+	fake_nvs.c - in-memory NVS partition for host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "fake.h"
+
+#include <nvs.h>
+#include <nvs_flash.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define FAKE_NVS_ITEMS 512U // keys partition holds
+#define FAKE_NVS_ENTRY_BYTES 32U // bytes of each NVS entry
+#define FAKE_NVS_TOTAL_ENTRIES (126U * 16U) // entries of a 64kB partition
+
+// type of stored item, integer types match order of nvs_set_* below
+enum FakeNvsType {
+	FAKE_NVS_U8,
+	FAKE_NVS_I8,
+	FAKE_NVS_U16,
+	FAKE_NVS_I16,
+	FAKE_NVS_U32,
+	FAKE_NVS_I32,
+	FAKE_NVS_U64,
+	FAKE_NVS_I64,
+	FAKE_NVS_STR,
+	FAKE_NVS_BLOB,
+};
+
+typedef struct fake_nvs_item_s {
+	char key[NVS_KEY_NAME_MAX_SIZE];
+	uint8_t type; // FakeNvsType
+	uint64_t value; // integer value, sign extended
+	uint8_t *data; // string or blob bytes
+	size_t length; // bytes of data, strings count their end of char
+	bool used;
+} fake_nvs_item_t;
+
+static fake_nvs_item_t items[FAKE_NVS_ITEMS];
+static struct fakeNvsCounts counts;
+static uint32_t appended = 0U; // entries written since erase, NVS only appends
+static pthread_mutex_t nvsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t callsInside = 0U; // calls running now
+static bool writeInside = false; // a write is running now
+static uint32_t delayUS = 0U;
+static bool failWrites = false;
+
+/**
+ * Gets entries data of a string or blob takes
+ *
+ * @param length bytes of data
+ *
+ * @return entries, one header plus data entries
+ */
+static uint32_t fakeNvsEntries(size_t length) {
+	return 1U + (uint32_t)((length + FAKE_NVS_ENTRY_BYTES - 1U) / FAKE_NVS_ENTRY_BYTES);
+}
+
+/**
+ * Enters a call, counting overlap with running writes
+ *
+ * @param write if call changes flash
+ *
+ * @note reads may overlap reads, writes overlap nothing
+ */
+static void fakeNvsEnter(bool write) {
+
+	pthread_mutex_lock(&nvsMutex);
+	if (writeInside || (write && callsInside != 0U)) {
+		counts.overlaps++;
+	}
+	callsInside++;
+	if (write) {
+		writeInside = true;
+	}
+	uint32_t delay = delayUS;
+	pthread_mutex_unlock(&nvsMutex);
+
+	// widens the window other calls can land in
+	if (delay != 0U) {
+		usleep(delay);
+	}
+}
+
+/**
+ * Leaves a call entered with 'fakeNvsEnter'
+ *
+ * @param write if call changes flash
+ */
+static void fakeNvsLeave(bool write) {
+
+	pthread_mutex_lock(&nvsMutex);
+	callsInside--;
+	if (write) {
+		writeInside = false;
+	}
+	pthread_mutex_unlock(&nvsMutex);
+}
+
+/**
+ * Finds item of key
+ *
+ * @param key name of key
+ *
+ * @note caller holds 'nvsMutex'
+ *
+ * @return item, NULL if key is not stored
+ */
+static fake_nvs_item_t *fakeNvsFind(const char *key) {
+
+	for (uint32_t i = 0U; i < FAKE_NVS_ITEMS; i++) {
+		if (items[i].used && strcmp(items[i].key, key) == 0) {
+			return &items[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Drops item of key
+ *
+ * @param item item to drop
+ *
+ * @note caller holds 'nvsMutex'
+ */
+static void fakeNvsDrop(fake_nvs_item_t *item) {
+
+	free(item -> data);
+	memset(item, 0, sizeof(fake_nvs_item_t));
+}
+
+/**
+ * Stores value under key, replacing value of any type
+ *
+ * @param key name of key
+ * @param type FakeNvsType of value
+ * @param value integer value
+ * @param data string or blob bytes, NULL for integers
+ * @param length bytes of data
+ *
+ * @return NVS result of write
+ */
+static esp_err_t fakeNvsSet(const char *key, uint8_t type, uint64_t value, const void *data, size_t length) {
+
+	if (key == NULL || strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	fakeNvsEnter(true);
+	pthread_mutex_lock(&nvsMutex);
+
+	esp_err_t err = ESP_OK;
+	fake_nvs_item_t *item = fakeNvsFind(key);
+	if (failWrites) {
+		err = ESP_FAIL;
+	}
+	else {
+		if (item == NULL) {
+			for (uint32_t i = 0U; i < FAKE_NVS_ITEMS && item == NULL; i++) {
+				if (!items[i].used) {
+					item = &items[i];
+				}
+			}
+		}
+		if (item == NULL) {
+			err = ESP_ERR_NVS_NO_FREE_PAGES;
+		}
+	}
+
+	if (err == ESP_OK) {
+		fakeNvsDrop(item);
+		strcpy(item -> key, key);
+		item -> type = type;
+		item -> value = value;
+		item -> used = true;
+		if (data != NULL) {
+			item -> data = malloc(length);
+			memcpy(item -> data, data, length);
+			item -> length = length;
+		}
+
+		uint32_t entries = (data == NULL) ? 1U : fakeNvsEntries(length);
+		counts.sets++;
+		counts.entries += entries;
+		appended += entries;
+	}
+
+	pthread_mutex_unlock(&nvsMutex);
+	fakeNvsLeave(true);
+
+	return err;
+}
+
+/**
+ * Reads integer value of key
+ *
+ * @param key name of key
+ * @param type FakeNvsType of value
+ * @param value pointer to store value
+ *
+ * @return NVS result of read, not found when stored with another type
+ */
+static esp_err_t fakeNvsGet(const char *key, uint8_t type, uint64_t *value) {
+
+	fakeNvsEnter(false);
+	pthread_mutex_lock(&nvsMutex);
+
+	counts.gets++;
+	fake_nvs_item_t *item = fakeNvsFind(key);
+	esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+	if (item != NULL && item -> type == type) {
+		*value = item -> value;
+		err = ESP_OK;
+	}
+
+	pthread_mutex_unlock(&nvsMutex);
+	fakeNvsLeave(false);
+
+	return err;
+}
+
+/**
+ * Reads string or blob of key
+ *
+ * @param key name of key
+ * @param type FAKE_NVS_STR or FAKE_NVS_BLOB
+ * @param data storage of bytes, NULL asks for length
+ * @param length pointer to storage size, changed to bytes stored
+ *
+ * @return NVS result of read
+ */
+static esp_err_t fakeNvsGetData(const char *key, uint8_t type, void *data, size_t *length) {
+
+	fakeNvsEnter(false);
+	pthread_mutex_lock(&nvsMutex);
+
+	counts.gets++;
+	fake_nvs_item_t *item = fakeNvsFind(key);
+	esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+	if (item != NULL && item -> type == type) {
+		if (data == NULL) {
+			*length = item -> length;
+			err = ESP_OK;
+		}
+		else if (*length < item -> length) {
+			err = ESP_ERR_NVS_INVALID_LENGTH;
+		}
+		else {
+			memcpy(data, item -> data, item -> length);
+			*length = item -> length;
+			err = ESP_OK;
+		}
+	}
+
+	pthread_mutex_unlock(&nvsMutex);
+	fakeNvsLeave(false);
+
+	return err;
+}
+
+/****************************
+ * NVS
+****************************/
+
+esp_err_t nvs_flash_init(void) {
+	return ESP_OK;
+}
+
+esp_err_t nvs_flash_deinit(void) {
+	return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+
+	fakeNvsEnter(true);
+	pthread_mutex_lock(&nvsMutex);
+	for (uint32_t i = 0U; i < FAKE_NVS_ITEMS; i++) {
+		fakeNvsDrop(&items[i]);
+	}
+	appended = 0U;
+	counts.flashErases++;
+	pthread_mutex_unlock(&nvsMutex);
+	fakeNvsLeave(true);
+
+	return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t m, nvs_handle_t *h) {
+
+	*h = 1U;
+	return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t h) {
+}
+
+esp_err_t nvs_commit(nvs_handle_t h) {
+
+	fakeNvsEnter(true);
+	pthread_mutex_lock(&nvsMutex);
+	esp_err_t err = failWrites ? ESP_FAIL : ESP_OK;
+	if (err == ESP_OK) {
+		counts.commits++;
+	}
+	pthread_mutex_unlock(&nvsMutex);
+	fakeNvsLeave(true);
+
+	return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t h, const char *k) {
+
+	fakeNvsEnter(true);
+	pthread_mutex_lock(&nvsMutex);
+	fake_nvs_item_t *item = fakeNvsFind(k);
+	esp_err_t err = ESP_ERR_NVS_NOT_FOUND;
+	if (failWrites) {
+		err = ESP_FAIL;
+	}
+	else if (item != NULL) {
+		fakeNvsDrop(item);
+		counts.erases++;
+		err = ESP_OK;
+	}
+	pthread_mutex_unlock(&nvsMutex);
+	fakeNvsLeave(true);
+
+	return err;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t h) {
+	return nvs_flash_erase();
+}
+
+esp_err_t nvs_get_stats(const char *part, nvs_stats_t *s) {
+
+	pthread_mutex_lock(&nvsMutex);
+	size_t used = 0U;
+	for (uint32_t i = 0U; i < FAKE_NVS_ITEMS; i++) {
+		if (items[i].used) {
+			used += (items[i].data == NULL) ? 1U : fakeNvsEntries(items[i].length);
+		}
+	}
+	s -> used_entries = used;
+	s -> free_entries = (appended < FAKE_NVS_TOTAL_ENTRIES) ? FAKE_NVS_TOTAL_ENTRIES - appended : 0U;
+	s -> total_entries = FAKE_NVS_TOTAL_ENTRIES;
+	s -> namespace_count = 1U;
+	pthread_mutex_unlock(&nvsMutex);
+
+	return ESP_OK;
+}
+
+#define FAKE_NVS_INT(t, n, type) \
+	esp_err_t nvs_set_##n(nvs_handle_t h, const char *k, t v) { \
+		return fakeNvsSet(k, type, (uint64_t)v, NULL, 0U); \
+	} \
+	esp_err_t nvs_get_##n(nvs_handle_t h, const char *k, t *v) { \
+		uint64_t value; \
+		esp_err_t err = fakeNvsGet(k, type, &value); \
+		if (err == ESP_OK) { \
+			*v = (t)value; \
+		} \
+		return err; \
+	}
+
+FAKE_NVS_INT(uint8_t, u8, FAKE_NVS_U8)
+FAKE_NVS_INT(int8_t, i8, FAKE_NVS_I8)
+FAKE_NVS_INT(uint16_t, u16, FAKE_NVS_U16)
+FAKE_NVS_INT(int16_t, i16, FAKE_NVS_I16)
+FAKE_NVS_INT(uint32_t, u32, FAKE_NVS_U32)
+FAKE_NVS_INT(int32_t, i32, FAKE_NVS_I32)
+FAKE_NVS_INT(uint64_t, u64, FAKE_NVS_U64)
+FAKE_NVS_INT(int64_t, i64, FAKE_NVS_I64)
+
+esp_err_t nvs_set_str(nvs_handle_t h, const char *k, const char *v) {
+	return fakeNvsSet(k, FAKE_NVS_STR, 0U, v, strlen(v) + 1U);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t h, const char *k, char *v, size_t *len) {
+	return fakeNvsGetData(k, FAKE_NVS_STR, v, len);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *k, const void *v, size_t len) {
+	return fakeNvsSet(k, FAKE_NVS_BLOB, 0U, v, len);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *k, void *v, size_t *len) {
+	return fakeNvsGetData(k, FAKE_NVS_BLOB, v, len);
+}
+
+/****************************
+ * Test Controls
+****************************/
+
+void fakeNvsGetCounts(struct fakeNvsCounts *out) {
+
+	pthread_mutex_lock(&nvsMutex);
+	*out = counts;
+	pthread_mutex_unlock(&nvsMutex);
+}
+
+void fakeNvsResetCounts(void) {
+
+	pthread_mutex_lock(&nvsMutex);
+	memset(&counts, 0, sizeof(counts));
+	pthread_mutex_unlock(&nvsMutex);
+}
+
+bool fakeNvsHas(const char *key) {
+
+	pthread_mutex_lock(&nvsMutex);
+	bool found = fakeNvsFind(key) != NULL;
+	pthread_mutex_unlock(&nvsMutex);
+
+	return found;
+}
+
+void fakeNvsSetDelay(uint32_t us) {
+	__atomic_store_n(&delayUS, us, __ATOMIC_RELEASE);
+}
+
+void fakeNvsFailWrites(bool fail) {
+	__atomic_store_n(&failWrites, fail, __ATOMIC_RELEASE);
+}
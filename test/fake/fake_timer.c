@@ -0,0 +1,555 @@
+/*
+	fake_timer.c - host timer group driver and registers
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+
+#include "fake.h"
+
+#include <driver/timer.h>
+#include <soc/timer_group_reg.h>
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define FAKE_GROUPS 2 // timer groups
+#define FAKE_TIMERS 2 // timers per group
+#define FAKE_GROUP_SPAN 0x1000U // register bytes per group
+#define FAKE_TIMER_SPAN 0x24U // register bytes per timer
+
+// register offsets within a timer
+#define FAKE_REG_CONFIG 0x00U
+#define FAKE_REG_LO 0x04U
+#define FAKE_REG_HI 0x08U
+#define FAKE_REG_UPDATE 0x0cU
+#define FAKE_REG_ALARM_LO 0x10U
+#define FAKE_REG_ALARM_HI 0x14U
+#define FAKE_REG_LOAD_LO 0x18U
+#define FAKE_REG_LOAD_HI 0x1cU
+#define FAKE_REG_LOAD 0x20U
+
+// register offsets within a group
+#define FAKE_REG_INT_ENA 0x98U
+#define FAKE_REG_INT_RAW 0x9cU
+#define FAKE_REG_INT_CLR 0xa4U
+
+// config register bits
+#define FAKE_CONFIG_EN BIT(31)
+#define FAKE_CONFIG_AUTORELOAD BIT(29)
+#define FAKE_CONFIG_DIVIDER_SHIFT 13U
+#define FAKE_CONFIG_DIVIDER_MASK 0xFFFFU
+
+// timers count APB_CLK / divider while enabled, from time spent enabled
+typedef struct fake_hw_timer_s {
+	bool initialized;
+	bool running;
+	bool alarmEnabled;
+	bool autoReload;
+	uint32_t divider;
+	uint64_t counter; // count when running last changed or counter was set
+	uint64_t sinceNS; // time of counter value
+	uint64_t latched; // count copied by update register
+	uint64_t alarm;
+	uint64_t load; // value reload and load register copy into counter
+	timer_isr_t isr; // IDF dispatcher callback
+	void *arg;
+	uint32_t alarms; // alarms raised
+} fake_hw_timer_t;
+
+static uint32_t regDelayNS = 0U; // bus time of each register write
+
+static struct {
+	pthread_mutex_t mutex;
+	fake_hw_timer_t timers[FAKE_GROUPS][FAKE_TIMERS];
+	uint32_t intEnable[FAKE_GROUPS];
+	uint32_t intRaw[FAKE_GROUPS];
+} timg = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// interrupt sources of each timer
+static const int fakeSources[FAKE_GROUPS][FAKE_TIMERS] = {
+	{ETS_TG0_T0_LEVEL_INTR_SOURCE, ETS_TG0_T1_LEVEL_INTR_SOURCE},
+	{ETS_TG1_T0_LEVEL_INTR_SOURCE, ETS_TG1_T1_LEVEL_INTR_SOURCE},
+};
+
+/**
+ * Gets time since an arbitrary point
+ *
+ * @return nanoseconds
+ */
+static uint64_t fakeNowNS(void) {
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * Gets timer of group and number
+ *
+ * @param group timer group
+ * @param num timer number
+ *
+ * @return timer, aborts on bad index
+ */
+static fake_hw_timer_t *fakeTimer(int group, int num) {
+
+	if (group < 0 || group >= FAKE_GROUPS || num < 0 || num >= FAKE_TIMERS) {
+		abort();
+	}
+	return &timg.timers[group][num];
+}
+
+/**
+ * Gets current count of timer, lock held
+ *
+ * @param timer timer to read
+ *
+ * @return count
+ */
+static uint64_t fakeCount(const fake_hw_timer_t *timer) {
+
+	if (!timer -> running || timer -> divider == 0U) {
+		return timer -> counter;
+	}
+
+	uint64_t cycles = (fakeNowNS() - timer -> sinceNS) * (APB_CLK_FREQ / 1000000U) / 1000U;
+	return timer -> counter + cycles / timer -> divider;
+}
+
+/**
+ * Sets count of timer, lock held
+ *
+ * @param timer timer to set
+ * @param count new count
+ */
+static void fakeSetCount(fake_hw_timer_t *timer, uint64_t count) {
+
+	timer -> counter = count;
+	timer -> sinceNS = fakeNowNS();
+}
+
+/**
+ * Starts or stops counting, lock held
+ *
+ * @param timer timer to change
+ * @param running if timer counts
+ */
+static void fakeSetRunning(fake_hw_timer_t *timer, bool running) {
+
+	if (timer -> running != running) {
+		fakeSetCount(timer, fakeCount(timer));
+		timer -> running = running;
+	}
+}
+
+/****************************
+ * Registers
+****************************/
+
+/**
+ * Splits register address into group, timer and offset
+ *
+ * @param address register address
+ * @param group pointer to store group
+ * @param num pointer to store timer, -1 for group registers
+ *
+ * @return offset within timer or group
+ */
+static uint32_t fakeRegDecode(uint32_t address, int *group, int *num) {
+
+	uint32_t base = REG_TIMG_BASE(0);
+	if (address < base || address >= base + FAKE_GROUPS * FAKE_GROUP_SPAN) {
+		abort();
+	}
+
+	uint32_t offset = (address - base) % FAKE_GROUP_SPAN;
+	*group = (int)((address - base) / FAKE_GROUP_SPAN);
+	*num = -1;
+
+	if (offset < FAKE_TIMERS * FAKE_TIMER_SPAN) {
+		*num = (int)(offset / FAKE_TIMER_SPAN);
+		offset %= FAKE_TIMER_SPAN;
+	}
+	return offset;
+}
+
+uint32_t fakeRegRead(uint32_t address) {
+
+	int group;
+	int num;
+	uint32_t offset = fakeRegDecode(address, &group, &num);
+	uint32_t value = 0U;
+
+	pthread_mutex_lock(&timg.mutex);
+	if (num < 0) {
+		if (offset == FAKE_REG_INT_ENA) {
+			value = timg.intEnable[group];
+		}
+		else if (offset == FAKE_REG_INT_RAW) {
+			value = timg.intRaw[group];
+		}
+	}
+	else {
+		fake_hw_timer_t *timer = fakeTimer(group, num);
+		switch (offset) {
+			case FAKE_REG_CONFIG:
+				value = (timer -> running ? FAKE_CONFIG_EN : 0U) | (timer -> autoReload ? FAKE_CONFIG_AUTORELOAD : 0U) |
+					(timer -> alarmEnabled ? TIMG_T0_ALARM_EN : 0U) | ((timer -> divider & FAKE_CONFIG_DIVIDER_MASK) << FAKE_CONFIG_DIVIDER_SHIFT);
+				break;
+			case FAKE_REG_LO:
+				value = (uint32_t)timer -> latched;
+				break;
+			case FAKE_REG_HI:
+				value = (uint32_t)(timer -> latched >> 32);
+				break;
+			case FAKE_REG_ALARM_LO:
+				value = (uint32_t)timer -> alarm;
+				break;
+			case FAKE_REG_ALARM_HI:
+				value = (uint32_t)(timer -> alarm >> 32);
+				break;
+			case FAKE_REG_LOAD_LO:
+				value = (uint32_t)timer -> load;
+				break;
+			case FAKE_REG_LOAD_HI:
+				value = (uint32_t)(timer -> load >> 32);
+				break;
+		}
+	}
+	pthread_mutex_unlock(&timg.mutex);
+
+	return value;
+}
+
+void fakeRegWrite(uint32_t address, uint32_t value) {
+
+	int group;
+	int num;
+	uint32_t offset = fakeRegDecode(address, &group, &num);
+
+	pthread_mutex_lock(&timg.mutex);
+	if (num < 0) {
+		if (offset == FAKE_REG_INT_ENA) {
+			timg.intEnable[group] = value;
+		}
+		else if (offset == FAKE_REG_INT_CLR) {
+			timg.intRaw[group] &= ~value;
+		}
+	}
+	else {
+		fake_hw_timer_t *timer = fakeTimer(group, num);
+		switch (offset) {
+			case FAKE_REG_CONFIG:
+				fakeSetRunning(timer, (value & FAKE_CONFIG_EN) != 0U);
+				timer -> autoReload = (value & FAKE_CONFIG_AUTORELOAD) != 0U;
+				timer -> alarmEnabled = (value & TIMG_T0_ALARM_EN) != 0U;
+				timer -> divider = (value >> FAKE_CONFIG_DIVIDER_SHIFT) & FAKE_CONFIG_DIVIDER_MASK;
+				break;
+			case FAKE_REG_UPDATE:
+				timer -> latched = fakeCount(timer);
+				break;
+			case FAKE_REG_ALARM_LO:
+				timer -> alarm = (timer -> alarm & ~(uint64_t)UINT32_MAX) | value;
+				break;
+			case FAKE_REG_ALARM_HI:
+				timer -> alarm = (timer -> alarm & UINT32_MAX) | ((uint64_t)value << 32);
+				break;
+			case FAKE_REG_LOAD_LO:
+				timer -> load = (timer -> load & ~(uint64_t)UINT32_MAX) | value;
+				break;
+			case FAKE_REG_LOAD_HI:
+				timer -> load = (timer -> load & UINT32_MAX) | ((uint64_t)value << 32);
+				break;
+			case FAKE_REG_LOAD:
+				fakeSetCount(timer, timer -> load);
+				break;
+		}
+	}
+	pthread_mutex_unlock(&timg.mutex);
+
+	uint64_t until = fakeNowNS() + __atomic_load_n(&regDelayNS, __ATOMIC_RELAXED);
+	while (fakeNowNS() < until) {
+	}
+}
+
+/****************************
+ * Timer Driver
+****************************/
+
+esp_err_t timer_init(timer_group_t group, timer_idx_t num, const timer_config_t *config) {
+
+	if (config == NULL || config -> divider < 2U || config -> divider > FAKE_CONFIG_DIVIDER_MASK) {
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	*timer = (fake_hw_timer_t){
+		.initialized = true,
+		.running = config -> counter_en == TIMER_START,
+		.alarmEnabled = config -> alarm_en == TIMER_ALARM_EN,
+		.autoReload = config -> auto_reload == TIMER_AUTORELOAD_EN,
+		.divider = config -> divider,
+		.sinceNS = fakeNowNS(),
+	};
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_deinit(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	esp_err_t result = timer -> initialized ? ESP_OK : ESP_ERR_INVALID_STATE;
+	*timer = (fake_hw_timer_t){0};
+	pthread_mutex_unlock(&timg.mutex);
+
+	return result;
+}
+
+esp_err_t timer_start(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fakeSetRunning(fakeTimer(group, num), true);
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_pause(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fakeSetRunning(fakeTimer(group, num), false);
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_set_counter_value(timer_group_t group, timer_idx_t num, uint64_t value) {
+
+	// like the IDF driver, value goes through the load register and stays there
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	timer -> load = value;
+	fakeSetCount(timer, value);
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_get_counter_value(timer_group_t group, timer_idx_t num, uint64_t *value) {
+
+	pthread_mutex_lock(&timg.mutex);
+	*value = fakeCount(fakeTimer(group, num));
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+uint64_t timer_group_get_counter_value_in_isr(timer_group_t group, timer_idx_t num) {
+
+	uint64_t value;
+	timer_get_counter_value(group, num, &value);
+
+	return value;
+}
+
+esp_err_t timer_set_alarm_value(timer_group_t group, timer_idx_t num, uint64_t value) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fakeTimer(group, num) -> alarm = value;
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+void timer_group_set_alarm_value_in_isr(timer_group_t group, timer_idx_t num, uint64_t value) {
+	timer_set_alarm_value(group, num, value);
+}
+
+esp_err_t timer_get_alarm_value(timer_group_t group, timer_idx_t num, uint64_t *value) {
+
+	pthread_mutex_lock(&timg.mutex);
+	*value = fakeTimer(group, num) -> alarm;
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_set_alarm(timer_group_t group, timer_idx_t num, timer_alarm_t enable) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fakeTimer(group, num) -> alarmEnabled = enable == TIMER_ALARM_EN;
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+void timer_group_enable_alarm_in_isr(timer_group_t group, timer_idx_t num) {
+	timer_set_alarm(group, num, TIMER_ALARM_EN);
+}
+
+esp_err_t timer_set_auto_reload(timer_group_t group, timer_idx_t num, timer_autoreload_t reload) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fakeTimer(group, num) -> autoReload = reload == TIMER_AUTORELOAD_EN;
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+uint64_t timer_group_get_auto_reload_in_isr(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	bool reload = fakeTimer(group, num) -> autoReload;
+	pthread_mutex_unlock(&timg.mutex);
+
+	return reload;
+}
+
+esp_err_t timer_set_divider(timer_group_t group, timer_idx_t num, uint32_t divider) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	fakeSetCount(timer, fakeCount(timer));
+	timer -> divider = divider;
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_isr_callback_add(timer_group_t group, timer_idx_t num, timer_isr_t isr, void *arg, int flags) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	esp_err_t result = timer -> isr == NULL ? ESP_OK : ESP_ERR_INVALID_STATE;
+	if (result == ESP_OK) {
+		timer -> isr = isr;
+		timer -> arg = arg;
+		timg.intEnable[group] |= BIT(num);
+	}
+	pthread_mutex_unlock(&timg.mutex);
+
+	return result;
+}
+
+esp_err_t timer_isr_callback_remove(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	timer -> isr = NULL;
+	timer -> arg = NULL;
+	timg.intEnable[group] &= ~BIT(num);
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_enable_intr(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	timg.intEnable[group] |= BIT(num);
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+esp_err_t timer_disable_intr(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	timg.intEnable[group] &= ~BIT(num);
+	pthread_mutex_unlock(&timg.mutex);
+
+	return ESP_OK;
+}
+
+void timer_group_clr_intr_status_in_isr(timer_group_t group, timer_idx_t num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	timg.intRaw[group] &= ~BIT(num);
+	pthread_mutex_unlock(&timg.mutex);
+}
+
+/****************************
+ * Test Controls
+****************************/
+
+bool fakeTimerAlarm(int group, int num) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	if (!timer -> running || !timer -> alarmEnabled) {
+		pthread_mutex_unlock(&timg.mutex);
+		return false;
+	}
+
+	// hardware drops alarm enable and reloads counter at alarm
+	timer -> alarms++;
+	timer -> alarmEnabled = false;
+	fakeSetCount(timer, timer -> autoReload ? timer -> load : timer -> alarm);
+	timg.intRaw[group] |= BIT(num);
+
+	timer_isr_t isr = timer -> isr;
+	void *arg = timer -> arg;
+	bool enabled = (timg.intEnable[group] & BIT(num)) != 0U;
+	pthread_mutex_unlock(&timg.mutex);
+
+	if (!enabled) {
+		return true;
+	}
+	if (isr == NULL) {
+		// raw handler allocated straight to the source
+		fakeIntrFire(fakeSources[group][num]);
+		return true;
+	}
+
+	// IDF dispatcher acknowledges, runs callback, then re-arms auto reload alarms
+	timer_group_clr_intr_status_in_isr(group, num);
+	isr(arg);
+	pthread_mutex_lock(&timg.mutex);
+	if (timer -> autoReload) {
+		timer -> alarmEnabled = true;
+	}
+	pthread_mutex_unlock(&timg.mutex);
+
+	return true;
+}
+
+void fakeTimerSetRegDelay(uint32_t ns) {
+	__atomic_store_n(&regDelayNS, ns, __ATOMIC_RELAXED);
+}
+
+void fakeTimerGetState(int group, int num, struct fakeTimerState *state) {
+
+	pthread_mutex_lock(&timg.mutex);
+	fake_hw_timer_t *timer = fakeTimer(group, num);
+	state -> initialized = timer -> initialized;
+	state -> running = timer -> running;
+	state -> alarmEnabled = timer -> alarmEnabled;
+	state -> autoReload = timer -> autoReload;
+	state -> divider = timer -> divider;
+	state -> counter = fakeCount(timer);
+	state -> alarm = timer -> alarm;
+	state -> load = timer -> load;
+	state -> alarms = timer -> alarms;
+	pthread_mutex_unlock(&timg.mutex);
+}
@@ -0,0 +1,152 @@
+/*
+	fake_uart.c - host UART driver capturing TX bytes
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "fake.h"
+
+#include <driver/uart.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+
+#define UART_CAPTURE_SIZE (1024U * 1024U) // TX bytes kept for tests
+
+// TX bytes are captured in order, one driver write is never split like the IDF driver
+static struct {
+	pthread_mutex_t mutex;
+	bool installed;
+	bool failInstall; // driver install fails
+	uint32_t baud;
+	size_t txFree; // free TX ring buffer bytes reported
+	uint32_t writes; // calls of uart_write_bytes
+	size_t length; // captured bytes
+	uint8_t bytes[UART_CAPTURE_SIZE];
+} uart = {
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.txFree = UART_CAPTURE_SIZE,
+};
+
+esp_err_t uart_driver_install(uart_port_t port, int rx, int tx, int queueSize, QueueHandle_t *queue, int flags) {
+
+	pthread_mutex_lock(&uart.mutex);
+	bool failed = uart.failInstall;
+	uart.installed = !failed;
+	pthread_mutex_unlock(&uart.mutex);
+
+	return failed ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t uart_driver_delete(uart_port_t port) {
+
+	pthread_mutex_lock(&uart.mutex);
+	uart.installed = false;
+	pthread_mutex_unlock(&uart.mutex);
+
+	return ESP_OK;
+}
+
+bool uart_is_driver_installed(uart_port_t port) {
+
+	pthread_mutex_lock(&uart.mutex);
+	bool installed = uart.installed;
+	pthread_mutex_unlock(&uart.mutex);
+
+	return installed;
+}
+
+esp_err_t uart_set_baudrate(uart_port_t port, uint32_t baud) {
+	uart.baud = baud;
+	return ESP_OK;
+}
+
+esp_err_t uart_get_baudrate(uart_port_t port, uint32_t *baud) {
+	*baud = uart.baud;
+	return ESP_OK;
+}
+
+int uart_write_bytes(uart_port_t port, const void *src, size_t size) {
+
+	pthread_mutex_lock(&uart.mutex);
+	if (!uart.installed || uart.length + size > UART_CAPTURE_SIZE) {
+		pthread_mutex_unlock(&uart.mutex);
+		return -1;
+	}
+	memcpy(&uart.bytes[uart.length], src, size);
+	uart.length += size;
+	uart.writes++;
+	pthread_mutex_unlock(&uart.mutex);
+
+	// other writers get in between writes, as with tasks on two cores
+	sched_yield();
+
+	return (int)size;
+}
+
+int uart_tx_chars(uart_port_t port, const char *buf, uint32_t len) {
+	return uart_write_bytes(port, buf, len);
+}
+
+int uart_read_bytes(uart_port_t port, void *buf, uint32_t len, TickType_t wait) {
+	return 0;
+}
+
+esp_err_t uart_wait_tx_done(uart_port_t port, TickType_t wait) {
+	return ESP_OK;
+}
+
+esp_err_t uart_flush_input(uart_port_t port) {
+	return ESP_OK;
+}
+
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t port, size_t *size) {
+
+	pthread_mutex_lock(&uart.mutex);
+	*size = uart.txFree;
+	pthread_mutex_unlock(&uart.mutex);
+
+	return ESP_OK;
+}
+
+void fakeUartFailInstall(bool fail) {
+
+	pthread_mutex_lock(&uart.mutex);
+	uart.failInstall = fail;
+	pthread_mutex_unlock(&uart.mutex);
+}
+
+void fakeUartSetTxFree(size_t size) {
+
+	pthread_mutex_lock(&uart.mutex);
+	uart.txFree = size;
+	pthread_mutex_unlock(&uart.mutex);
+}
+
+size_t fakeUartTake(const uint8_t **bytes, uint32_t *writes) {
+
+	pthread_mutex_lock(&uart.mutex);
+	size_t length = uart.length;
+	*bytes = uart.bytes;
+	if (writes != NULL) {
+		*writes = uart.writes;
+	}
+	uart.length = 0U;
+	uart.writes = 0U;
+	pthread_mutex_unlock(&uart.mutex);
+
+	return length;
+}
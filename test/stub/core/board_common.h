@@ -0,0 +1,18 @@
+/* host stand-in for Core board_common.h, declares only what the board layer uses */
+#ifndef BOARD_COMMON_H
+#define BOARD_COMMON_H
+#include "boards/board.h"
+enum pinModeState {PIN_MODE_DISABLED, PIN_MODE_OUTPUT, PIN_MODE_INPUT, PIN_MODE_INPUT_PULL_UP};
+enum digitalState {LOW_STATE, HIGH_STATE};
+bool initBoard();
+void hardPinMode(pin_t pin, enum pinModeState mode);
+void hardDigitalWrite(pin_t pin, enum digitalState value);
+void hardDelayMS(uint32_t delayAmount);
+void hardDelayUS(uint32_t delayAmount);
+bool startThreadSafety(void);
+bool endThreadSafety(void);
+#define ONE_BYTE 0xFFU
+#define END_OF_CHAR '\0'
+#define CHAR_LEN_ERROR UINT8_MAX
+uint8_t charArraySize(char *value);
+#endif
@@ -0,0 +1,8 @@
+/* host stand-in for Core boards/board.h, selects the ESP32 board layer */
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "board_generic.h"
+#include "board_esp32.h"
+
+#endif
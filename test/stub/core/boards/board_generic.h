@@ -0,0 +1,11 @@
+/* host stand-in for Core boards/board_generic.h, declares only what the board layer uses */
+#ifndef BOARD_GENERIC_H
+#define BOARD_GENERIC_H
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+typedef uint8_t pin_t;
+typedef uint32_t nvm_size_t;
+#define FLASH_NVM_SIZE 4096
+#define BAUD_RATE 115200
+#endif
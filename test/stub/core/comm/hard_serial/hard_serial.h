@@ -0,0 +1,6 @@
+/* host stand-in for Core comm/hard_serial/hard_serial.h, declares only what the board layer uses */
+#ifndef HARD_SERIAL_H
+#define HARD_SERIAL_H
+#include "../../boards/board.h"
+void hardPrintBegin(uint32_t baud);
+#endif
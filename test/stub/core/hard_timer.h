@@ -0,0 +1,18 @@
+/* host stand-in for Core hard_timer.h, declares only what the board layer uses */
+#ifndef HARD_TIMER_H
+#define HARD_TIMER_H
+#include "boards/board.h"
+typedef uint8_t hard_timer_t;
+typedef uint32_t freq_t;
+typedef uint8_t timer_priority_t;
+#define HARD_TIMER_INVALID UINT8_MAX
+typedef hard_timer_return_t (*hard_timer_function_ptr_t)(hard_timer_param_t);
+struct hardTimerPriority { timer_priority_t priority; };
+enum HardTimerStatusReturn {HARD_TIMER_OK, HARD_TIMER_SLIGHTLY_OFF, HARD_TIMER_FAIL};
+hard_timer_t claimTimer(struct hardTimerPriority *priority);
+bool unclaimTimer(hard_timer_t timer);
+bool hardTimerClaimed(hard_timer_t timer);
+bool hardTimerStarted(hard_timer_t timer);
+bool cancelHardTimer(hard_timer_t timer);
+bool setHardTimer(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority);
+#endif
@@ -0,0 +1,41 @@
+/* host stand-in for Core nvm/generic_nvm.h, declares only what the board layer uses */
+#ifndef GENERIC_NVM_H
+#define GENERIC_NVM_H
+#include "../boards/board.h"
+#define NVM_MAX_SIZE_BYTES 4U
+#define NVM_MAX_SIZE UINT32_MAX
+#define DEFAULT_NVM_SIZE 0U
+#define DEFAULT_BOOL false
+#define DEFAULT_INT 0
+enum NVMStartCode {NVM_OK, NVM_STARTED, NVM_INVALID_SIZE, NVM_FAILED};
+enum NVMDefaultCode {NVM_DEFAULT_OK, NVM_DEFAULT_SIZE_TOO_BIG, NVM_DEFAULT_FAIL_MAX_SIZE, NVM_DEFAULT_FAIL_CLEAR, NVM_DEFAULT_FAIL_STOP, NVM_DEFAULT_FAIL_INIT};
+enum NVMStartCode nvmInit(nvm_size_t setNVMSize);
+bool nvmMaxSize(nvm_size_t *size);
+enum NVMDefaultCode nvmSetDefaults(void);
+enum NVMDefaultCode nvmSetCritDefaults(nvm_size_t maxSize);
+enum NVMDefaultCode nvmSetEnvDefaults(void);
+bool nvmWriteBool(nvm_size_t key, bool value);
+bool nvmWriteI8(nvm_size_t key, int8_t value);
+bool nvmWriteUI8(nvm_size_t key, uint8_t value);
+bool nvmWriteI16(nvm_size_t key, int16_t value);
+bool nvmWriteUI16(nvm_size_t key, uint16_t value);
+bool nvmWriteI32(nvm_size_t key, int32_t value);
+bool nvmWriteUI32(nvm_size_t key, uint32_t value);
+bool nvmWriteI64(nvm_size_t key, int64_t value);
+bool nvmWriteUI64(nvm_size_t key, uint64_t value);
+bool nvmWriteFloat(nvm_size_t key, float value);
+bool nvmWriteDouble(nvm_size_t key, double value);
+bool nvmWriteCharArray(nvm_size_t key, char* value, uint8_t maxLength);
+bool nvmGetCharArray(nvm_size_t key, char* value, uint8_t maxLength);
+bool nvmGetBool(nvm_size_t key, bool *value, bool canDefault);
+bool nvmGetI8(nvm_size_t key, int8_t *value, bool canDefault);
+bool nvmGetUI8(nvm_size_t key, uint8_t *value, bool canDefault);
+bool nvmGetI16(nvm_size_t key, int16_t *value, bool canDefault);
+bool nvmGetUI16(nvm_size_t key, uint16_t *value, bool canDefault);
+bool nvmGetI32(nvm_size_t key, int32_t *value, bool canDefault);
+bool nvmGetUI32(nvm_size_t key, uint32_t *value, bool canDefault);
+bool nvmGetI64(nvm_size_t key, int64_t *value, bool canDefault);
+bool nvmGetUI64(nvm_size_t key, uint64_t *value, bool canDefault);
+bool nvmGetFloat(nvm_size_t key, float *value, bool canDefault);
+bool nvmGetDouble(nvm_size_t key, double *value, bool canDefault);
+#endif
@@ -0,0 +1,16 @@
+/* host stand-in for <driver/adc.h>, declares only what the board layer uses */
+#pragma once
+#include "../esp_err.h"
+typedef enum {ADC1_CHANNEL_0, ADC1_CHANNEL_1, ADC1_CHANNEL_2, ADC1_CHANNEL_3, ADC1_CHANNEL_4, ADC1_CHANNEL_5, ADC1_CHANNEL_6, ADC1_CHANNEL_7, ADC1_CHANNEL_MAX} adc1_channel_t;
+typedef enum {ADC_UNIT_1 = 1, ADC_UNIT_2 = 2} adc_unit_t;
+typedef enum {ADC_ATTEN_DB_0, ADC_ATTEN_DB_2_5, ADC_ATTEN_DB_6, ADC_ATTEN_DB_11, ADC_ATTEN_MAX} adc_atten_t;
+typedef enum {ADC_WIDTH_BIT_9, ADC_WIDTH_BIT_10, ADC_WIDTH_BIT_11, ADC_WIDTH_BIT_12, ADC_WIDTH_MAX} adc_bits_width_t;
+typedef enum {ADC_CONV_SINGLE_UNIT_1 = 1} adc_digi_convert_mode_t;
+typedef enum {ADC_DIGI_FORMAT_12BIT, ADC_DIGI_FORMAT_11BIT} adc_digi_output_format_t;
+typedef struct { union { struct { uint8_t atten:2; uint8_t bit_width:2; uint8_t channel:4; }; uint8_t val; }; } adc_digi_pattern_table_t;
+typedef struct { bool conv_limit_en; uint32_t conv_limit_num; uint32_t adc1_pattern_len; uint32_t adc2_pattern_len; adc_digi_pattern_table_t *adc1_pattern; adc_digi_pattern_table_t *adc2_pattern; adc_digi_convert_mode_t conv_mode; adc_digi_output_format_t format; } adc_digi_config_t;
+esp_err_t adc1_config_width(adc_bits_width_t w);
+esp_err_t adc1_config_channel_atten(adc1_channel_t c, adc_atten_t a);
+int adc1_get_raw(adc1_channel_t c);
+esp_err_t adc_digi_init(void);
+esp_err_t adc_digi_controller_config(const adc_digi_config_t *config);
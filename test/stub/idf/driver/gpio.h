@@ -0,0 +1,7 @@
+/* host stand-in for <driver/gpio.h>, declares only what the board layer uses */
+#pragma once
+#include "../esp_err.h"
+#include "../hal/gpio_types.h"
+esp_err_t gpio_set_direction(int pin, int mode);
+esp_err_t gpio_set_pull_mode(int pin, int mode);
+esp_err_t gpio_set_level(int pin, uint32_t v);
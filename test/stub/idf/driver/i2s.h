@@ -0,0 +1,26 @@
+/* host stand-in for <driver/i2s.h>, declares only what the board layer uses */
+#pragma once
+#include "../esp_err.h"
+#include "adc.h"
+#include "../freertos/queue.h"
+typedef int i2s_port_t;
+#define I2S_NUM_0 0
+#define I2S_MODE_MASTER 1
+#define I2S_MODE_RX 4
+#define I2S_MODE_ADC_BUILT_IN 32
+typedef int i2s_mode_t;
+typedef enum {I2S_BITS_PER_SAMPLE_16BIT = 16} i2s_bits_per_sample_t;
+typedef enum {I2S_CHANNEL_FMT_RIGHT_LEFT, I2S_CHANNEL_FMT_ALL_RIGHT, I2S_CHANNEL_FMT_ALL_LEFT, I2S_CHANNEL_FMT_ONLY_RIGHT, I2S_CHANNEL_FMT_ONLY_LEFT} i2s_channel_fmt_t;
+typedef enum {I2S_COMM_FORMAT_STAND_I2S = 1} i2s_comm_format_t;
+typedef struct { i2s_mode_t mode; uint32_t sample_rate; i2s_bits_per_sample_t bits_per_sample; i2s_channel_fmt_t channel_format; i2s_comm_format_t communication_format; int intr_alloc_flags; int dma_buf_count; int dma_buf_len; bool use_apll; bool tx_desc_auto_clear; int fixed_mclk; } i2s_config_t;
+typedef enum {I2S_EVENT_DMA_ERROR, I2S_EVENT_TX_DONE, I2S_EVENT_RX_DONE, I2S_EVENT_TX_Q_OVF, I2S_EVENT_RX_Q_OVF, I2S_EVENT_MAX} i2s_event_type_t;
+typedef struct { i2s_event_type_t type; size_t size; } i2s_event_t;
+esp_err_t i2s_driver_install(i2s_port_t p, const i2s_config_t *c, int qs, void *q);
+esp_err_t i2s_driver_uninstall(i2s_port_t p);
+esp_err_t i2s_set_adc_mode(adc_unit_t u, adc1_channel_t c);
+esp_err_t i2s_adc_enable(i2s_port_t p);
+esp_err_t i2s_adc_disable(i2s_port_t p);
+esp_err_t i2s_read(i2s_port_t p, void *dest, size_t size, size_t *read, TickType_t wait);
+esp_err_t i2s_set_sample_rates(i2s_port_t p, uint32_t rate);
+float i2s_get_clk(i2s_port_t p);
+esp_err_t i2s_zero_dma_buffer(i2s_port_t p);
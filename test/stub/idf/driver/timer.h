@@ -0,0 +1,32 @@
+/* host stand-in for <driver/timer.h>, declares only what the board layer uses */
+#pragma once
+#include "../esp_err.h"
+#include "../esp_intr_alloc.h"
+typedef int timer_group_t; typedef int timer_idx_t;
+typedef bool (*timer_isr_t)(void *);
+typedef enum {TIMER_PAUSE, TIMER_START} timer_start_t;
+typedef enum {TIMER_ALARM_DIS, TIMER_ALARM_EN} timer_alarm_t;
+typedef enum {TIMER_INTR_LEVEL} timer_intr_mode_t;
+typedef enum {TIMER_COUNT_DOWN, TIMER_COUNT_UP} timer_count_dir_t;
+typedef enum {TIMER_AUTORELOAD_DIS, TIMER_AUTORELOAD_EN} timer_autoreload_t;
+typedef struct { timer_alarm_t alarm_en; timer_start_t counter_en; timer_intr_mode_t intr_type; timer_count_dir_t counter_dir; timer_autoreload_t auto_reload; uint32_t divider; } timer_config_t;
+esp_err_t timer_init(timer_group_t g, timer_idx_t n, const timer_config_t *c);
+esp_err_t timer_deinit(timer_group_t g, timer_idx_t n);
+esp_err_t timer_start(timer_group_t g, timer_idx_t n);
+esp_err_t timer_pause(timer_group_t g, timer_idx_t n);
+esp_err_t timer_set_counter_value(timer_group_t g, timer_idx_t n, uint64_t v);
+esp_err_t timer_get_counter_value(timer_group_t g, timer_idx_t n, uint64_t *v);
+uint64_t timer_group_get_counter_value_in_isr(timer_group_t g, timer_idx_t n);
+esp_err_t timer_set_alarm_value(timer_group_t g, timer_idx_t n, uint64_t v);
+esp_err_t timer_get_alarm_value(timer_group_t g, timer_idx_t n, uint64_t *v);
+esp_err_t timer_set_alarm(timer_group_t g, timer_idx_t n, timer_alarm_t en);
+esp_err_t timer_set_auto_reload(timer_group_t g, timer_idx_t n, timer_autoreload_t r);
+esp_err_t timer_set_divider(timer_group_t g, timer_idx_t n, uint32_t d);
+esp_err_t timer_isr_callback_add(timer_group_t g, timer_idx_t n, timer_isr_t isr, void *arg, int flags);
+esp_err_t timer_isr_callback_remove(timer_group_t g, timer_idx_t n);
+esp_err_t timer_enable_intr(timer_group_t g, timer_idx_t n);
+esp_err_t timer_disable_intr(timer_group_t g, timer_idx_t n);
+void timer_group_clr_intr_status_in_isr(timer_group_t g, timer_idx_t n);
+void timer_group_enable_alarm_in_isr(timer_group_t g, timer_idx_t n);
+void timer_group_set_alarm_value_in_isr(timer_group_t g, timer_idx_t n, uint64_t v);
+uint64_t timer_group_get_auto_reload_in_isr(timer_group_t g, timer_idx_t n);
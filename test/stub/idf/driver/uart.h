@@ -0,0 +1,20 @@
+/* host stand-in for <driver/uart.h>, declares only what the board layer uses */
+#pragma once
+#include "../esp_err.h"
+#include "../freertos/FreeRTOS.h"
+#include "../freertos/queue.h"
+typedef int uart_port_t;
+#define UART_NUM_0 0
+#define UART_PIN_NO_CHANGE -1
+#define UART_FIFO_LEN 128
+esp_err_t uart_set_baudrate(uart_port_t p, uint32_t b);
+esp_err_t uart_get_baudrate(uart_port_t p, uint32_t *b);
+esp_err_t uart_driver_install(uart_port_t p, int rx, int tx, int qs, QueueHandle_t *q, int flags);
+esp_err_t uart_driver_delete(uart_port_t p);
+bool uart_is_driver_installed(uart_port_t p);
+int uart_write_bytes(uart_port_t p, const void *src, size_t size);
+int uart_tx_chars(uart_port_t p, const char *buf, uint32_t len);
+int uart_read_bytes(uart_port_t p, void *buf, uint32_t len, TickType_t wait);
+esp_err_t uart_wait_tx_done(uart_port_t p, TickType_t wait);
+esp_err_t uart_flush_input(uart_port_t p);
+esp_err_t uart_get_tx_buffer_free_size(uart_port_t p, size_t *size);
@@ -0,0 +1,5 @@
+/* host stand-in for <esp_attr.h>, declares only what the board layer uses */
+#pragma once
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define WORD_ALIGNED_ATTR __attribute__((aligned(4)))
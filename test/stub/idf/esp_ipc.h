@@ -0,0 +1,5 @@
+/* host stand-in for <esp_ipc.h>, declares only what the board layer uses */
+#pragma once
+#include "esp_err.h"
+typedef void (*esp_ipc_func_t)(void *arg);
+esp_err_t esp_ipc_call_blocking(uint32_t cpu_id, esp_ipc_func_t func, void *arg);
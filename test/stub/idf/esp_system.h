@@ -0,0 +1,3 @@
+/* host stand-in for <esp_system.h>, declares only what the board layer uses */
+#pragma once
+#include "esp_err.h"
@@ -0,0 +1,12 @@
+/* host stand-in for <freertos/portmacro.h>, declares only what the board layer uses */
+#pragma once
+#include <stdint.h>
+typedef struct { uint32_t owner; uint32_t count; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0,0}
+void taskENTER_CRITICAL(portMUX_TYPE *m);
+void taskEXIT_CRITICAL(portMUX_TYPE *m);
+void portENTER_CRITICAL_ISR(portMUX_TYPE *m);
+void portEXIT_CRITICAL_ISR(portMUX_TYPE *m);
+void vPortCPUInitializeMutex(portMUX_TYPE *m);
+void portYIELD_FROM_ISR(void);
+int xPortGetCoreID(void);
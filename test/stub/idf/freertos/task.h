@@ -0,0 +1,13 @@
+/* host stand-in for <freertos/task.h>, declares only what the board layer uses */
+#pragma once
+#include "FreeRTOS.h"
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t f, const char *n, uint32_t stack, void *p, UBaseType_t prio, TaskHandle_t *h, BaseType_t core);
+void vTaskDelete(TaskHandle_t t);
+void vTaskDelay(TickType_t t);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+void vTaskNotifyGiveFromISR(TaskHandle_t t, BaseType_t *woken);
+void xTaskNotifyGive(TaskHandle_t t);
@@ -0,0 +1,10 @@
+/* host stand-in for <freertos/timers.h>, declares only what the board layer uses */
+#pragma once
+#include "FreeRTOS.h"
+typedef void* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t);
+TimerHandle_t xTimerCreate(const char *n, TickType_t period, UBaseType_t reload, void *id, TimerCallbackFunction_t cb);
+BaseType_t xTimerStart(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerStop(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerReset(TimerHandle_t t, TickType_t wait);
+BaseType_t xTimerDelete(TimerHandle_t t, TickType_t wait);
@@ -0,0 +1,7 @@
+/* host stand-in for <hal/gpio_types.h>, declares only what the board layer uses */
+#pragma once
+#define GPIO_MODE_DISABLE 0
+#define GPIO_MODE_OUTPUT 1
+#define GPIO_MODE_INPUT 2
+#define GPIO_PULLUP_DISABLE 0
+#define GPIO_PULLUP_ENABLE 1
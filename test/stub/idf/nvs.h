@@ -0,0 +1,23 @@
+/* host stand-in for <nvs.h>, declares only what the board layer uses */
+#pragma once
+#include "esp_err.h"
+typedef uint32_t nvs_handle_t;
+typedef enum {NVS_READONLY, NVS_READWRITE} nvs_open_mode_t;
+#define ESP_ERR_NVS_NOT_FOUND 0x1102
+#define ESP_ERR_NVS_NO_FREE_PAGES 0x110d
+#define ESP_ERR_NVS_NEW_VERSION_FOUND 0x1110
+#define ESP_ERR_NVS_INVALID_LENGTH 0x110c
+#define NVS_KEY_NAME_MAX_SIZE 16
+typedef struct { size_t used_entries; size_t free_entries; size_t total_entries; size_t namespace_count; } nvs_stats_t;
+esp_err_t nvs_open(const char *ns, nvs_open_mode_t m, nvs_handle_t *h);
+void nvs_close(nvs_handle_t h);
+esp_err_t nvs_commit(nvs_handle_t h);
+esp_err_t nvs_erase_key(nvs_handle_t h, const char *k);
+esp_err_t nvs_erase_all(nvs_handle_t h);
+esp_err_t nvs_get_stats(const char *part, nvs_stats_t *s);
+#define NVS_DECL(t, n) esp_err_t nvs_set_##n(nvs_handle_t h, const char *k, t v); esp_err_t nvs_get_##n(nvs_handle_t h, const char *k, t *v);
+NVS_DECL(uint8_t,u8) NVS_DECL(int8_t,i8) NVS_DECL(uint16_t,u16) NVS_DECL(int16_t,i16) NVS_DECL(uint32_t,u32) NVS_DECL(int32_t,i32) NVS_DECL(uint64_t,u64) NVS_DECL(int64_t,i64)
+esp_err_t nvs_set_str(nvs_handle_t h, const char *k, const char *v);
+esp_err_t nvs_get_str(nvs_handle_t h, const char *k, char *v, size_t *len);
+esp_err_t nvs_set_blob(nvs_handle_t h, const char *k, const void *v, size_t len);
+esp_err_t nvs_get_blob(nvs_handle_t h, const char *k, void *v, size_t *len);
@@ -0,0 +1,6 @@
+/* host stand-in for <nvs_flash.h>, declares only what the board layer uses */
+#pragma once
+#include "nvs.h"
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_deinit(void);
+esp_err_t nvs_flash_erase(void);
@@ -0,0 +1,4 @@
+/* host stand-in for <rom/ets_sys.h>, declares only what the board layer uses */
+#pragma once
+#include <stdint.h>
+uint32_t ets_get_cpu_frequency(void);
@@ -0,0 +1,16 @@
+/* host stand-in for <soc/soc.h>, declares only what the board layer uses */
+#pragma once
+#define APB_CLK_FREQ 80000000
+#include <stdint.h>
+#define BIT(n) (1UL << (n))
+/* registers go through the timer fake, which models the timer groups */
+uint32_t fakeRegRead(uint32_t address);
+void fakeRegWrite(uint32_t address, uint32_t value);
+#define REG_WRITE(r, v) fakeRegWrite((uint32_t)(r), (uint32_t)(v))
+#define REG_READ(r) fakeRegRead((uint32_t)(r))
+#define REG_SET_BIT(r, b) fakeRegWrite((uint32_t)(r), fakeRegRead((uint32_t)(r)) | (uint32_t)(b))
+#define REG_CLR_BIT(r, b) fakeRegWrite((uint32_t)(r), fakeRegRead((uint32_t)(r)) & ~(uint32_t)(b))
+#define ETS_TG0_T0_LEVEL_INTR_SOURCE 14
+#define ETS_TG0_T1_LEVEL_INTR_SOURCE 15
+#define ETS_TG1_T0_LEVEL_INTR_SOURCE 18
+#define ETS_TG1_T1_LEVEL_INTR_SOURCE 19
@@ -0,0 +1,19 @@
+/* host stand-in for <soc/timer_group_reg.h>, declares only what the board layer uses */
+#pragma once
+#include "soc.h"
+#define REG_TIMG_BASE(i) (0x3FF5F000 + (i) * 0x1000)
+#define TIMG_T0CONFIG_REG(i) (REG_TIMG_BASE(i) + 0x0000)
+#define TIMG_T1CONFIG_REG(i) (REG_TIMG_BASE(i) + 0x0024)
+#define TIMG_T0_ALARM_EN BIT(10)
+#define TIMG_INT_CLR_TIMERS_REG(i) (REG_TIMG_BASE(i) + 0x00a4)
+#define TIMG_T0_EN BIT(31)
+#define TIMG_T0UPDATE_REG(i) (REG_TIMG_BASE(i) + 0x000c)
+#define TIMG_T1UPDATE_REG(i) (REG_TIMG_BASE(i) + 0x0030)
+#define TIMG_T0LO_REG(i) (REG_TIMG_BASE(i) + 0x0004)
+#define TIMG_T1LO_REG(i) (REG_TIMG_BASE(i) + 0x0028)
+#define TIMG_T0LOADLO_REG(i) (REG_TIMG_BASE(i) + 0x0018)
+#define TIMG_T1LOADLO_REG(i) (REG_TIMG_BASE(i) + 0x003c)
+#define TIMG_T0LOADHI_REG(i) (REG_TIMG_BASE(i) + 0x001c)
+#define TIMG_T1LOADHI_REG(i) (REG_TIMG_BASE(i) + 0x0040)
+#define TIMG_T0ALARMLO_REG(i) (REG_TIMG_BASE(i) + 0x0010)
+#define TIMG_T1ALARMLO_REG(i) (REG_TIMG_BASE(i) + 0x0034)
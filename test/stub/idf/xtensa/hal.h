@@ -0,0 +1,4 @@
+/* host stand-in for <xtensa/hal.h>, declares only what the board layer uses */
+#pragma once
+#include <stdint.h>
+uint32_t xthal_get_ccount(void);
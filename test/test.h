@@ -0,0 +1,72 @@
+/*
+	test.h - checks shared by host tests
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+static unsigned testFailures = 0U; // failed checks of this test program
+
+/**
+ * Records failure when condition is false
+ *
+ * @param cond condition expected to hold
+ */
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		testFailures++; \
+	} \
+} while (0)
+
+/**
+ * Records failure when values differ
+ *
+ * @param actual value produced
+ * @param expected value wanted
+ */
+#define CHECK_EQ(actual, expected) do { \
+	long long checkActual = (long long)(actual); \
+	long long checkExpected = (long long)(expected); \
+	if (checkActual != checkExpected) { \
+		printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, checkActual, checkExpected); \
+		testFailures++; \
+	} \
+} while (0)
+
+/**
+ * Runs test case
+ *
+ * @param test function taking no parameters
+ */
+#define RUN_TEST(test) do { \
+	unsigned runFailures = testFailures; \
+	test(); \
+	printf("%s %s\n", testFailures == runFailures ? "PASS" : "FAIL", #test); \
+	fflush(stdout); \
+} while (0)
+
+/**
+ * Ends test program
+ *
+ * @return process exit code
+ */
+#define TEST_END() (testFailures == 0U ? 0 : 1)
+
+#endif
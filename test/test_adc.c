@@ -0,0 +1,277 @@
+/*
+	test_adc.c - host tests of continuous ADC capture
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "fake.h"
+
+#include "board_esp32_adc.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#define TEST_RATE 100000U // requested sample rate
+#define TEST_WAIT_MS 1000U // max wait for capture task
+#define TEST_CHANNEL 0U // ADC1 channel of ADC0
+
+static uint16_t pattern[ADC_BLOCK_SIZE];
+
+/**
+ * Completes DMA buffer tagged with a marker
+ *
+ * @param marker value of first sample, later samples count up from it
+ */
+static void fill(uint16_t marker) {
+
+	for (uint16_t i = 0U; i < ADC_BLOCK_SIZE; i++) {
+		pattern[i] = (uint16_t)((TEST_CHANNEL << 12U) | ((marker + i) & 0x0FFFU));
+	}
+	CHECK(fakeI2sDmaFill(pattern, ADC_BLOCK_SIZE));
+}
+
+/**
+ * Waits until capture task handled an amount of DMA buffers
+ *
+ * @param handled blocks given to consumer plus blocks dropped
+ *
+ * @return if amount was reached in time
+ */
+static bool waitHandled(uint32_t handled) {
+
+	for (uint32_t ms = 0U; ms < TEST_WAIT_MS; ms++) {
+		struct adcCaptureStats stats;
+		adcCaptureGetStats(&stats);
+		if (stats.blocks + stats.blockOverruns + stats.dmaOverruns >= handled) {
+			return true;
+		}
+		usleep(1000U);
+	}
+	return false;
+}
+
+/**
+ * Starts capture of ADC0 at test rate
+ */
+static void start(void) {
+
+	freq_t freq = TEST_RATE;
+	CHECK(adcCaptureStart(ADC0, &freq));
+	CHECK_EQ(freq, TEST_RATE);
+	CHECK(fakeI2sInstalled());
+}
+
+/**
+ * Waits for a block that never comes, like a consumer stop catches
+ *
+ * @param params bool to store result of take
+ *
+ * @return unused
+ */
+static void *blockedTake(void *params) {
+
+	adc_block_t block;
+	*(bool *)params = adcCaptureTake(&block, 10U * TEST_WAIT_MS);
+
+	return NULL;
+}
+
+static void testStartStop(void) {
+
+	freq_t freq = 0U;
+	CHECK(!adcCaptureStart(ADC0, &freq));
+	freq = ADC_FREQ_MAX + 1U;
+	CHECK(!adcCaptureStart(ADC0, &freq));
+	freq = TEST_RATE;
+	CHECK(!adcCaptureStart(D2, &freq));
+	CHECK(!fakeI2sInstalled());
+
+	start();
+	freq = TEST_RATE;
+	CHECK(!adcCaptureStart(ADC0, &freq));
+
+	CHECK(adcCaptureStop());
+	CHECK(!adcCaptureRunning());
+	CHECK(!fakeI2sInstalled());
+	CHECK(!adcCaptureStop());
+}
+
+static void testRotation(void) {
+
+	start();
+
+	for (uint16_t n = 0U; n < 6U; n++) {
+		fill((uint16_t)(n * 100U));
+
+		adc_block_t block;
+		CHECK(adcCaptureTake(&block, TEST_WAIT_MS));
+		CHECK_EQ(block.length, ADC_BLOCK_SIZE);
+		CHECK_EQ(block.sequence, n);
+		CHECK_EQ(block.slot, n % ADC_BLOCK_COUNT);
+		CHECK_EQ(ADC_SAMPLE_VALUE(block.samples[0]), n * 100U);
+		CHECK_EQ(ADC_SAMPLE_VALUE(block.samples[ADC_BLOCK_SIZE - 1U]), n * 100U + ADC_BLOCK_SIZE - 1U);
+		CHECK(adcCaptureRelease(&block));
+		CHECK(block.samples == NULL);
+	}
+
+	struct adcCaptureStats stats;
+	adcCaptureGetStats(&stats);
+	CHECK_EQ(stats.blocks, 6U);
+	CHECK_EQ(stats.blockOverruns, 0U);
+	CHECK_EQ(stats.dmaOverruns, 0U);
+
+	CHECK(adcCaptureStop());
+}
+
+static void testConsumerBehind(void) {
+
+	start();
+
+	// consumer holds nothing back yet, then falls behind by two blocks
+	for (uint16_t n = 0U; n < ADC_BLOCK_COUNT + 2U; n++) {
+		fill((uint16_t)(n * 10U));
+		CHECK(waitHandled(n + 1U));
+	}
+
+	struct adcCaptureStats stats;
+	adcCaptureGetStats(&stats);
+	CHECK_EQ(stats.blocks, ADC_BLOCK_COUNT);
+	CHECK_EQ(stats.blockOverruns, 2U);
+
+	adc_block_t blocks[ADC_BLOCK_COUNT];
+	for (uint8_t i = 0U; i < ADC_BLOCK_COUNT; i++) {
+		CHECK(adcCaptureTake(&blocks[i], TEST_WAIT_MS));
+		CHECK_EQ(blocks[i].sequence, i);
+		CHECK_EQ(ADC_SAMPLE_VALUE(blocks[i].samples[0]), i * 10U);
+	}
+	adc_block_t extra;
+	CHECK(!adcCaptureTake(&extra, 10U));
+
+	for (uint8_t i = 0U; i < ADC_BLOCK_COUNT; i++) {
+		CHECK(adcCaptureRelease(&blocks[i]));
+	}
+
+	// gap in sequence shows the dropped blocks
+	fill(500U);
+	CHECK(adcCaptureTake(&extra, TEST_WAIT_MS));
+	CHECK_EQ(extra.sequence, ADC_BLOCK_COUNT + 2U);
+	CHECK_EQ(ADC_SAMPLE_VALUE(extra.samples[0]), 500U);
+	CHECK(adcCaptureRelease(&extra));
+
+	CHECK(adcCaptureStop());
+}
+
+static void testDmaOverrun(void) {
+
+	start();
+
+	// capture task stalls on its first read while DMA keeps filling
+	fakeI2sStall(true);
+	for (uint16_t n = 0U; n <= ADC_DMA_BUF_COUNT; n++) {
+		fill((uint16_t)(n * 1000U));
+	}
+	fakeI2sStall(false);
+
+	// oldest buffer was dropped by driver, later ones arrive in order
+	for (uint16_t n = 1U; n <= ADC_DMA_BUF_COUNT; n++) {
+		adc_block_t block;
+		CHECK(adcCaptureTake(&block, TEST_WAIT_MS));
+		CHECK_EQ(block.length, ADC_BLOCK_SIZE);
+		CHECK_EQ(ADC_SAMPLE_VALUE(block.samples[0]), n * 1000U);
+		CHECK(adcCaptureRelease(&block));
+	}
+
+	CHECK(waitHandled(ADC_DMA_BUF_COUNT + 1U));
+
+	// event of the dropped buffer finds no data and hands out nothing
+	adc_block_t empty;
+	CHECK(!adcCaptureTake(&empty, 50U));
+
+	struct adcCaptureStats stats;
+	adcCaptureGetStats(&stats);
+	CHECK_EQ(stats.dmaOverruns, 1U);
+	CHECK_EQ(stats.blocks, ADC_DMA_BUF_COUNT);
+	CHECK_EQ(stats.blockOverruns, 0U);
+
+	CHECK(adcCaptureStop());
+}
+
+static void testScanSplit(void) {
+
+	pin_t pins[] = {ADC0, ADC2};
+	freq_t freq = TEST_RATE;
+	CHECK(adcScanStart(pins, 2U, &freq));
+
+	uint8_t second;
+	CHECK(adcPinChannel(ADC2, &second));
+
+	// time order a0 b0 a1 b1 then a lone a2, stored with word halves swapped
+	adc_sample_t samples[6] = {
+		(adc_sample_t)((second << 12U) | 10U), (adc_sample_t)((TEST_CHANNEL << 12U) | 1U),
+		(adc_sample_t)((second << 12U) | 20U), (adc_sample_t)((TEST_CHANNEL << 12U) | 2U),
+		(adc_sample_t)((TEST_CHANNEL << 12U) | 3U), (adc_sample_t)((TEST_CHANNEL << 12U) | 4095U),
+	};
+	adc_block_t block = {.samples = samples, .length = 5U};
+
+	uint16_t first[4];
+	uint16_t other[4];
+	adc_scan_buffers_t buffers = {
+		.channels = {first, other},
+		.length = {0U, 0U},
+		.capacity = 4U,
+	};
+
+	// last word is partial, its partner past the end must not be read
+	CHECK_EQ(adcScanSplit(&block, &buffers), 1U);
+	CHECK_EQ(buffers.length[0], 2U);
+	CHECK_EQ(buffers.length[1], 2U);
+	CHECK_EQ(first[0], 1U);
+	CHECK_EQ(first[1], 2U);
+	CHECK_EQ(other[0], 10U);
+	CHECK_EQ(other[1], 20U);
+
+	CHECK(adcCaptureStop());
+}
+
+static void testStopWakesWaiters(void) {
+
+	start();
+
+	bool taken = true;
+	pthread_t thread;
+	CHECK(pthread_create(&thread, NULL, blockedTake, &taken) == 0);
+	usleep(20000U);
+
+	// waiter returns before queues are freed, not after its timeout
+	CHECK(adcCaptureStop());
+	pthread_join(thread, NULL);
+	CHECK(!taken);
+
+	adc_block_t block;
+	CHECK(!adcCaptureTake(&block, 0U));
+}
+
+int main(void) {
+
+	RUN_TEST(testStartStop);
+	RUN_TEST(testRotation);
+	RUN_TEST(testConsumerBehind);
+	RUN_TEST(testDmaOverrun);
+	RUN_TEST(testScanSplit);
+	RUN_TEST(testStopWakesWaiters);
+
+	return TEST_END();
+}
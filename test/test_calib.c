@@ -0,0 +1,215 @@
+/*
+	test_calib.c - host tests of fixed point calibration tables
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+// built in to reach table storage between boots
+#include "board_esp32_calib.c"
+
+#include <string.h>
+
+#define TEST_ATTEN ADC_ATTEN_DB_11 // attenuation in default CALIB_ATTEN_MASK
+#define TEST_GAIN 52429U // 0.8 mV per code in characterization scale
+#define TEST_OFFSET 142U // mV of code 0
+
+static uint8_t storedBlob[sizeof(calib_blob_t)];
+static size_t storedLength = 0U;
+static uint32_t blobWrites = 0U;
+
+static uint32_t gain = TEST_GAIN;
+static uint16_t jumpCode = 0U; // first code raised by jumpMV, 0 for none
+static uint32_t jumpMV = 0U;
+
+/****************************
+ * Fakes
+****************************/
+
+bool nvmWriteBlob(nvm_size_t key, const void *value, size_t length) {
+
+	if (key != CALIB_NVM_KEY + TEST_ATTEN || length > sizeof(storedBlob)) {
+		return false;
+	}
+	memcpy(storedBlob, value, length);
+	storedLength = length;
+	blobWrites++;
+
+	return true;
+}
+
+bool nvmGetBlob(nvm_size_t key, void *value, size_t *length) {
+
+	if (key != CALIB_NVM_KEY + TEST_ATTEN || storedLength == 0U || *length < storedLength) {
+		return false;
+	}
+	memcpy(value, storedBlob, storedLength);
+	*length = storedLength;
+
+	return true;
+}
+
+esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width, uint32_t vref, esp_adc_cal_characteristics_t *chars) {
+
+	memset(chars, 0, sizeof(esp_adc_cal_characteristics_t));
+	chars -> adc_num = unit;
+	chars -> atten = atten;
+	chars -> bit_width = width;
+	chars -> coeff_a = gain;
+	chars -> coeff_b = TEST_OFFSET;
+	chars -> vref = vref;
+
+	return ESP_ADC_CAL_VAL_EFUSE_TP;
+}
+
+uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t *chars) {
+
+	// IDF linear math plus a whole mV curve correction
+	uint32_t mv = ((chars -> coeff_a * raw + CALIB_COEFF_A_SCALE / 2U) / CALIB_COEFF_A_SCALE) + chars -> coeff_b;
+	if (jumpCode != 0U && raw >= jumpCode) {
+		mv += jumpMV;
+	}
+	return mv;
+}
+
+/**
+ * Forgets tables in RAM as if rebooted
+ */
+static void reboot(void) {
+
+	calibTables[TEST_ATTEN] = NULL;
+	loadedCount = 0U;
+}
+
+/**
+ * Sets characterization and clears stored table
+ *
+ * @param newGain characterization gain
+ * @param code first code of curve jump, 0 for none
+ * @param mv size of curve jump
+ */
+static void setup(uint32_t newGain, uint16_t code, uint32_t mv) {
+
+	reboot();
+	gain = newGain;
+	jumpCode = code;
+	jumpMV = mv;
+	storedLength = 0U;
+	blobWrites = 0U;
+}
+
+/****************************
+ * Tests
+****************************/
+
+static void testSubMillivolt(void) {
+
+	setup(TEST_GAIN, 0U, 0U);
+	CHECK(calibInit());
+	CHECK(calibReady(TEST_ATTEN));
+	CHECK(!calibReady(ADC_ATTEN_DB_0));
+	CHECK_EQ(calibLoadedCount(), 0U);
+
+	// 0.8 mV steps survive instead of rounding to 0 or 1 mV
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 0U), TEST_OFFSET * CALIB_ONE_MV);
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 1U), TEST_OFFSET * CALIB_ONE_MV + 13U);
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 5U), (TEST_OFFSET + 4U) * CALIB_ONE_MV);
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 4000U), (TEST_OFFSET + 3200U) * CALIB_ONE_MV);
+
+	// channel tag is ignored and whole mV rounds to nearest
+	CHECK_EQ(calibToMV(TEST_ATTEN, (adc_sample_t)((5U << 12U) | 5U)), TEST_OFFSET + 4U);
+	CHECK_EQ(calibToMV(TEST_ATTEN, 1U), TEST_OFFSET + 1U);
+	CHECK_EQ(calibToMV(TEST_ATTEN, 2U), TEST_OFFSET + 2U);
+}
+
+static void testNarrowRoundTrip(void) {
+
+	setup(TEST_GAIN, 0U, 0U);
+	CHECK(calibInit());
+	CHECK_EQ(blobWrites, 1U);
+	CHECK_EQ(storedLength, CALIB_BLOB_SIZE(sizeof(int8_t)));
+
+	uint16_t built[CALIB_TABLE_SIZE];
+	memcpy(built, calibTables[TEST_ATTEN], sizeof(built));
+
+	reboot();
+	CHECK(calibInit());
+	CHECK_EQ(calibLoadedCount(), 1U);
+	CHECK_EQ(blobWrites, 1U);
+	CHECK(memcmp(built, calibTables[TEST_ATTEN], sizeof(built)) == 0);
+}
+
+static void testWideSteps(void) {
+
+	// 20 mV curve step is 320 table counts, too big for a byte
+	setup(TEST_GAIN, 2000U, 20U);
+	CHECK(calibInit());
+	CHECK_EQ(storedLength, CALIB_BLOB_SIZE(sizeof(int16_t)));
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 2000U) - calibToFixed(TEST_ATTEN, 1999U), 13U + 20U * CALIB_ONE_MV);
+
+	uint16_t built[CALIB_TABLE_SIZE];
+	memcpy(built, calibTables[TEST_ATTEN], sizeof(built));
+
+	reboot();
+	CHECK(calibInit());
+	CHECK_EQ(calibLoadedCount(), 1U);
+	CHECK(memcmp(built, calibTables[TEST_ATTEN], sizeof(built)) == 0);
+}
+
+static void testStepTooLarge(void) {
+
+	// step past 2 bytes is never truncated into NVM
+	setup(TEST_GAIN, 1000U, 3000U);
+	CHECK(calibInit());
+	CHECK_EQ(blobWrites, 0U);
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 999U), (TEST_OFFSET * CALIB_ONE_MV) + (999U * 4U * CALIB_ONE_MV + 2U) / 5U);
+	CHECK_EQ(calibToFixed(TEST_ATTEN, 1000U), (TEST_OFFSET + 800U + 3000U) * CALIB_ONE_MV);
+
+	reboot();
+	CHECK(calibInit());
+	CHECK_EQ(calibLoadedCount(), 0U);
+}
+
+static void testStaleTable(void) {
+
+	setup(TEST_GAIN, 0U, 0U);
+	CHECK(calibInit());
+	CHECK_EQ(blobWrites, 1U);
+
+	// new eFuse gain makes stored table stale
+	reboot();
+	gain = TEST_GAIN + 100U;
+	CHECK(calibInit());
+	CHECK_EQ(calibLoadedCount(), 0U);
+	CHECK_EQ(blobWrites, 2U);
+
+	// damaged length is not loaded
+	reboot();
+	storedLength--;
+	CHECK(calibInit());
+	CHECK_EQ(calibLoadedCount(), 0U);
+}
+
+int main(void) {
+
+	RUN_TEST(testSubMillivolt);
+	RUN_TEST(testNarrowRoundTrip);
+	RUN_TEST(testWideSteps);
+	RUN_TEST(testStepTooLarge);
+	RUN_TEST(testStaleTable);
+
+	return TEST_END();
+}
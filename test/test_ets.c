@@ -0,0 +1,196 @@
+/*
+	test_ets.c - host tests of equivalent time reconstruction
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+// built in to drive sampling ISR from a simulated timer
+#include "board_esp32_ets.c"
+
+#include <sched.h>
+
+#define TEST_CHANNEL 2U // channel tag of sampled signal
+#define TEST_STEPS 8U // phase steps per sample period
+#define TEST_PERIOD_TICKS 8U // timer ticks per sample, one tick per step
+#define TEST_PRE 2U // samples kept before trigger
+#define TEST_POST 4U // samples after trigger
+#define TEST_LEVEL 2000U // trigger level
+#define TEST_SLOPE 3U // signal rise per timer tick
+#define WAVE_TICKS 128U // sawtooth period, whole sample periods
+#define WAVE_CROSS 64U // tick of sawtooth reaching level
+#define MAX_SAMPLES 1000000U // gives up on a stuck capture
+
+static trigger_t trigger;
+static adc_sample_t history[TEST_PRE];
+static adc_sample_t frame[TEST_PRE + TEST_POST];
+static adc_sample_t output[TEST_POST * TEST_STEPS];
+
+static uint64_t now = 0U; // simulated time of current sample in ticks
+static uint32_t pendingShift = 0U; // delay of next period, set by merge task
+static uint32_t shifts = 0U;
+static bool timerRunning = false;
+
+/****************************
+ * Fakes
+****************************/
+
+bool setHardTimerFine(hard_timer_t *timer, freq_t *freq, hard_timer_function_ptr_t function, timer_priority_t priority, timertick_t *timerTicks) {
+
+	*timer = 0U;
+	*timerTicks = TEST_PERIOD_TICKS;
+	__atomic_store_n(&timerRunning, true, __ATOMIC_RELEASE);
+	return true;
+}
+
+bool hardTimerShiftPhase(hard_timer_t timer, timertick_t ticks) {
+
+	__atomic_fetch_add(&pendingShift, (uint32_t)(ticks % TEST_PERIOD_TICKS), __ATOMIC_ACQ_REL);
+	shifts++;
+	return true;
+}
+
+bool cancelHardTimer(hard_timer_t timer) {
+
+	__atomic_store_n(&timerRunning, false, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * Sawtooth rising TEST_SLOPE per tick, at level WAVE_CROSS ticks into each period
+ *
+ * @return sample of signal at simulated time
+ */
+static adc_sample_t readWave(void) {
+
+	int32_t offset = (int32_t)(now % WAVE_TICKS) - (int32_t)WAVE_CROSS;
+	int32_t value = (int32_t)TEST_LEVEL + offset * (int32_t)TEST_SLOPE;
+	return (adc_sample_t)((TEST_CHANNEL << 12U) | (uint16_t)value);
+}
+
+/**
+ * Runs timer alarms until capture fills, shifts land like the timer ISR applies them
+ *
+ * @return samples taken
+ */
+static uint32_t runTimer(void) {
+
+	uint32_t samples = 0U;
+
+	while (!__atomic_load_n(&timerRunning, __ATOMIC_ACQUIRE)) {
+		sched_yield();
+	}
+	while (__atomic_load_n(&timerRunning, __ATOMIC_ACQUIRE) && samples < MAX_SAMPLES) {
+		etsTimerISR(NULL);
+		samples++;
+
+		// period after this alarm is longer by pending shift
+		now += TEST_PERIOD_TICKS + __atomic_exchange_n(&pendingShift, 0U, __ATOMIC_ACQ_REL);
+		sched_yield();
+	}
+	return samples;
+}
+
+/****************************
+ * Tests
+****************************/
+
+static void testRampReconstruction(void) {
+
+	struct triggerConfig triggerConfig = {
+		.mode = TRIGGER_RISING,
+		.channel = TEST_CHANNEL,
+		.level = TEST_LEVEL,
+		.hysteresis = 50U,
+		.preCount = TEST_PRE,
+		.postCount = TEST_POST,
+	};
+	CHECK(triggerInit(&trigger, &triggerConfig, history, frame));
+
+	struct etsConfig config = {
+		.read = readWave,
+		.trigger = &trigger,
+		.freq = 1000000U,
+		.steps = TEST_STEPS,
+		.output = output,
+		.priority = 1U,
+	};
+	freq_t effective = 0U;
+	CHECK(etsStart(&config, &effective));
+	CHECK_EQ(effective, 1000000U * TEST_STEPS);
+
+	CHECK(runTimer() < MAX_SAMPLES);
+	CHECK(etsWait(1000U));
+
+	// one pass per phase step when every shift lands exactly
+	uint32_t filled;
+	uint32_t passes;
+	CHECK_EQ(etsProgress(&filled, &passes), TEST_POST * TEST_STEPS);
+	CHECK_EQ(filled, TEST_POST * TEST_STEPS);
+	CHECK_EQ(passes, TEST_STEPS);
+	CHECK_EQ(shifts, TEST_STEPS);
+
+	// bin n is n steps after the crossing
+	for (uint32_t i = 0U; i < TEST_POST * TEST_STEPS; i++) {
+		CHECK_EQ(ADC_SAMPLE_VALUE(output[i]), TEST_LEVEL + i * TEST_SLOPE);
+	}
+
+	CHECK(etsStop());
+}
+
+static void testMergeCrossingOnSample(void) {
+
+	struct triggerConfig triggerConfig = {
+		.mode = TRIGGER_RISING,
+		.channel = TEST_CHANNEL,
+		.level = TEST_LEVEL,
+		.hysteresis = 50U,
+		.preCount = TEST_PRE,
+		.postCount = TEST_POST,
+	};
+	CHECK(triggerInit(&trigger, &triggerConfig, history, frame));
+	triggerArm(&trigger);
+
+	ets.trigger = &trigger;
+	ets.steps = TEST_STEPS;
+	ets.output = output;
+	outputLength = TEST_POST * TEST_STEPS;
+	filledCount = 0U;
+	filledBits = calloc(1U, sizeof(uint32_t));
+	CHECK(filledBits != NULL);
+
+	// sample lands exactly on level, so it is the crossing itself
+	for (now = 0U; !triggerPush(&trigger, readWave()); now += TEST_PERIOD_TICKS) {
+	}
+	etsMerge();
+
+	CHECK_EQ(filledCount, TEST_POST);
+	for (uint32_t i = 0U; i < TEST_POST; i++) {
+		CHECK(filledBits[0] & (1UL << (i * TEST_STEPS)));
+		CHECK_EQ(ADC_SAMPLE_VALUE(output[i * TEST_STEPS]), TEST_LEVEL + i * TEST_STEPS * TEST_SLOPE);
+	}
+
+	free(filledBits);
+	filledBits = NULL;
+}
+
+int main(void) {
+
+	RUN_TEST(testRampReconstruction);
+	RUN_TEST(testMergeCrossingOnSample);
+
+	return TEST_END();
+}
@@ -0,0 +1,279 @@
+/*
+	test_frame.c - host loopback tests of binary serial frames
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+// built like host tools build it, without Core, IDF or fakes
+#include "board_esp32_frame.h"
+
+#include <string.h>
+
+#define CAPACITY 32U // payload bytes decoder holds
+#define STREAM_SIZE 1024U // bytes of loopback stream
+
+static uint8_t stream[STREAM_SIZE];
+static uint16_t streamLength = 0U;
+
+static frame_decoder_t decoder;
+static uint8_t payload[CAPACITY];
+
+/**
+ * Appends encoded frame to loopback stream
+ *
+ * @param type frame type
+ * @param seq frame sequence
+ * @param data payload bytes
+ * @param length payload bytes
+ *
+ * @return offset of frame in stream
+ */
+static uint16_t encode(uint8_t type, uint8_t seq, const void *data, uint16_t length) {
+
+	uint16_t offset = streamLength;
+	uint16_t crc = frameBuildHeader(&stream[offset], type, seq, length);
+	crc = frameCRC16(crc, data, length);
+
+	memcpy(&stream[offset + FRAME_HEADER_SIZE], data, length);
+	stream[offset + FRAME_HEADER_SIZE + length] = (uint8_t)crc;
+	stream[offset + FRAME_HEADER_SIZE + length + 1U] = (uint8_t)(crc >> 8);
+
+	streamLength += FRAME_HEADER_SIZE + length + FRAME_CRC_SIZE;
+	return offset;
+}
+
+/**
+ * Appends raw bytes to loopback stream
+ *
+ * @param data bytes to append
+ * @param length amount of bytes
+ */
+static void append(const void *data, uint16_t length) {
+
+	memcpy(&stream[streamLength], data, length);
+	streamLength += length;
+}
+
+/**
+ * Decodes loopback stream and starts it over
+ *
+ * @param seqs storage for sequence of each frame decoded
+ * @param max frames seqs holds
+ * @param errors pointer to store decode errors returned
+ *
+ * @return frames decoded
+ */
+static uint16_t decodeStream(uint8_t *seqs, uint16_t max, uint16_t *errors) {
+
+	uint16_t frames = 0U;
+	*errors = 0U;
+
+	for (uint16_t i = 0U; i < streamLength; i++) {
+		enum FrameDecodeResult result = frameDecodeByte(&decoder, stream[i]);
+		if (result == FRAME_DECODE_ERROR) {
+			(*errors)++;
+		}
+		else if (result == FRAME_DECODE_READY && frames < max) {
+			seqs[frames++] = decoder.seq;
+		}
+	}
+
+	streamLength = 0U;
+	return frames;
+}
+
+static void setup(void) {
+
+	streamLength = 0U;
+	CHECK(frameDecoderInit(&decoder, payload, CAPACITY));
+}
+
+static void testCRC(void) {
+
+	// CCITT check value of "123456789"
+	CHECK_EQ(frameCRC16(FRAME_CRC_INIT, "123456789", 9U), 0x29B1U);
+
+	// header CRC continues over payload like one pass over both
+	uint8_t header[FRAME_HEADER_SIZE];
+	uint16_t crc = frameBuildHeader(header, FRAME_STATS, 7U, 3U);
+	CHECK_EQ(header[0], FRAME_SYNC_0);
+	CHECK_EQ(header[1], FRAME_SYNC_1);
+	CHECK_EQ(header[4], 3U);
+	CHECK_EQ(header[5], 0U);
+	uint8_t whole[] = {FRAME_STATS, 7U, 3U, 0U, 'a', 'b', 'c'};
+	CHECK_EQ(frameCRC16(crc, "abc", 3U), frameCRC16(FRAME_CRC_INIT, whole, sizeof(whole)));
+}
+
+static void testRoundTrip(void) {
+
+	setup();
+	CHECK(!frameDecoderInit(&decoder, NULL, CAPACITY));
+	CHECK(!frameDecoderInit(&decoder, payload, 0U));
+	setup();
+
+	uint8_t data[CAPACITY];
+	for (uint16_t i = 0U; i < CAPACITY; i++) {
+		data[i] = (uint8_t)(i * 7U);
+	}
+
+	encode(FRAME_SAMPLES, 0U, data, CAPACITY);
+	encode(FRAME_CONTROL, 1U, data, 0U);
+
+	uint16_t i = 0U;
+	for (; i < FRAME_HEADER_SIZE + CAPACITY + FRAME_CRC_SIZE - 1U; i++) {
+		CHECK(frameDecodeByte(&decoder, stream[i]) == FRAME_DECODE_BUSY);
+	}
+	CHECK(frameDecodeByte(&decoder, stream[i++]) == FRAME_DECODE_READY);
+	CHECK_EQ(decoder.type, FRAME_SAMPLES);
+	CHECK_EQ(decoder.length, CAPACITY);
+	CHECK(memcmp(payload, data, CAPACITY) == 0);
+
+	// empty payload goes straight to CRC
+	for (; i < streamLength - 1U; i++) {
+		CHECK(frameDecodeByte(&decoder, stream[i]) == FRAME_DECODE_BUSY);
+	}
+	CHECK(frameDecodeByte(&decoder, stream[i]) == FRAME_DECODE_READY);
+	CHECK_EQ(decoder.type, FRAME_CONTROL);
+	CHECK_EQ(decoder.length, 0U);
+	CHECK_EQ(decoder.frames, 2U);
+	CHECK_EQ(decoder.lost, 0U);
+}
+
+static void testCRCError(void) {
+
+	setup();
+	uint8_t data[] = {1U, 2U, 3U, 4U};
+
+	encode(FRAME_SAMPLES, 0U, data, sizeof(data));
+	uint16_t bad = encode(FRAME_SAMPLES, 1U, data, sizeof(data));
+	encode(FRAME_SAMPLES, 2U, data, sizeof(data));
+
+	// one flipped payload bit drops only its own frame
+	stream[bad + FRAME_HEADER_SIZE + 2U] ^= 0x10U;
+
+	uint8_t seqs[4];
+	uint16_t errors;
+	CHECK_EQ(decodeStream(seqs, 4U, &errors), 2U);
+	CHECK_EQ(errors, 1U);
+	CHECK_EQ(seqs[0], 0U);
+	CHECK_EQ(seqs[1], 2U);
+	CHECK_EQ(decoder.crcErrors, 1U);
+	CHECK_EQ(decoder.frames, 2U);
+
+	// dropped frame shows as a sequence gap
+	CHECK_EQ(decoder.lost, 1U);
+
+	// flipped CRC byte is caught as well
+	bad = encode(FRAME_STATS, 3U, data, sizeof(data));
+	stream[bad + FRAME_HEADER_SIZE + sizeof(data) + 1U] ^= 0x01U;
+	CHECK_EQ(decodeStream(seqs, 4U, &errors), 0U);
+	CHECK_EQ(decoder.crcErrors, 2U);
+}
+
+static void testResync(void) {
+
+	setup();
+	uint8_t data[] = {9U, 8U, 7U};
+
+	// line noise, lone and doubled sync bytes before a frame
+	static const uint8_t noise[] = {0x00U, 0xFFU, FRAME_SYNC_1, FRAME_SYNC_0, 0x12U, FRAME_SYNC_0, FRAME_SYNC_0};
+	append(noise, sizeof(noise));
+	encode(FRAME_ENVELOPE, 0U, data, sizeof(data));
+
+	// frame cut short by a restarted sender, then a good frame
+	uint16_t cut = encode(FRAME_ENVELOPE, 1U, data, sizeof(data));
+	streamLength = cut + FRAME_HEADER_SIZE + 1U;
+	encode(FRAME_ENVELOPE, 2U, data, sizeof(data));
+
+	uint8_t seqs[4];
+	uint16_t errors;
+	uint16_t frames = decodeStream(seqs, 4U, &errors);
+
+	// cut frame takes the start of the next one as payload and fails CRC
+	CHECK_EQ(frames, 1U);
+	CHECK_EQ(seqs[0], 0U);
+	CHECK_EQ(errors, 1U);
+	CHECK_EQ(decoder.crcErrors, 1U);
+
+	// decoder is back in sync for the following frame
+	encode(FRAME_ENVELOPE, 3U, data, sizeof(data));
+	CHECK_EQ(decodeStream(seqs, 4U, &errors), 1U);
+	CHECK_EQ(seqs[0], 3U);
+	CHECK_EQ(errors, 0U);
+	CHECK(memcmp(payload, data, sizeof(data)) == 0);
+}
+
+static void testSequenceGaps(void) {
+
+	setup();
+	uint8_t data[] = {5U};
+
+	// gaps of 2 and 5, then sequence wraps past 255
+	static const uint8_t sent[] = {0U, 1U, 4U, 5U, 11U, 254U, 255U, 0U, 1U};
+	for (uint16_t i = 0U; i < sizeof(sent); i++) {
+		encode(FRAME_SAMPLES, sent[i], data, sizeof(data));
+	}
+
+	uint8_t seqs[sizeof(sent)];
+	uint16_t errors;
+	CHECK_EQ(decodeStream(seqs, sizeof(sent), &errors), sizeof(sent));
+	CHECK_EQ(errors, 0U);
+	CHECK(memcmp(seqs, sent, sizeof(sent)) == 0);
+	CHECK_EQ(decoder.lost, 2U + 5U + 242U);
+	CHECK_EQ(decoder.frames, sizeof(sent));
+}
+
+static void testOversize(void) {
+
+	setup();
+	uint8_t data[CAPACITY + 1U];
+	memset(data, 0x33U, sizeof(data));
+
+	encode(FRAME_SAMPLES, 0U, data, CAPACITY);
+	encode(FRAME_SAMPLES, 1U, data, CAPACITY + 1U);
+	encode(FRAME_SAMPLES, 2U, data, CAPACITY);
+
+	// length is refused before any payload is stored
+	uint8_t seqs[4];
+	uint16_t errors;
+	CHECK_EQ(decodeStream(seqs, 4U, &errors), 2U);
+	CHECK_EQ(errors, 1U);
+	CHECK_EQ(decoder.overflows, 1U);
+	CHECK_EQ(decoder.crcErrors, 0U);
+	CHECK_EQ(seqs[0], 0U);
+	CHECK_EQ(seqs[1], 2U);
+	CHECK_EQ(decoder.lost, 1U);
+
+	// length past 16 bit payload storage counts too
+	uint8_t header[FRAME_HEADER_SIZE];
+	frameBuildHeader(header, FRAME_SAMPLES, 3U, UINT16_MAX);
+	append(header, FRAME_HEADER_SIZE);
+	CHECK_EQ(decodeStream(seqs, 4U, &errors), 0U);
+	CHECK_EQ(decoder.overflows, 2U);
+}
+
+int main(void) {
+
+	RUN_TEST(testCRC);
+	RUN_TEST(testRoundTrip);
+	RUN_TEST(testCRCError);
+	RUN_TEST(testResync);
+	RUN_TEST(testSequenceGaps);
+	RUN_TEST(testOversize);
+
+	return TEST_END();
+}
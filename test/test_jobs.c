@@ -0,0 +1,211 @@
+/*
+	test_jobs.c - host tests of jobs sharing one hardware timer
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "fake.h"
+
+// built in to reach job table
+#include "board_esp32_jobs.c"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define TEST_FREQ 10000U // base freq of job timer
+#define REUSE_ROUNDS 100000U // adds and removes of one slot while alarms run
+#define HELD_ROUNDS 20U // removes while a job is inside dispatch
+#define HELD_YIELDS 4U // yields a held job stays inside for
+
+/**
+ * Context of a job, tagged with the function it belongs to
+ */
+struct jobContext {
+	hard_timer_function_ptr_t owner; // function added with this context
+	bool live; // cleared once remove returned
+	uint32_t runs; // times job ran
+};
+
+static hard_timer_t jobTimerID = HARD_TIMER_INVALID;
+static bool alarmsStop = false;
+static uint32_t misuses = 0U; // runs with a stranger or removed context
+static bool held = false; // set once held job is inside dispatch
+
+static hard_timer_return_t jobFirst(hard_timer_param_t params);
+static hard_timer_return_t jobSecond(hard_timer_param_t params);
+static hard_timer_return_t jobHeld(hard_timer_param_t params);
+
+/**
+ * Counts run, checks context still belongs to this job
+ *
+ * @param context context run with
+ * @param self function running
+ */
+static void jobCheck(struct jobContext *context, hard_timer_function_ptr_t self) {
+
+	if (context -> owner != self || !__atomic_load_n(&context -> live, __ATOMIC_ACQUIRE)) {
+		__atomic_add_fetch(&misuses, 1U, __ATOMIC_RELAXED);
+	}
+	__atomic_add_fetch(&context -> runs, 1U, __ATOMIC_RELEASE);
+}
+
+static hard_timer_return_t jobFirst(hard_timer_param_t params) {
+	jobCheck(params, jobFirst);
+	return false;
+}
+
+static hard_timer_return_t jobSecond(hard_timer_param_t params) {
+	jobCheck(params, jobSecond);
+	return false;
+}
+
+/**
+ * Stays inside dispatch for a few yields so remove lands mid pass
+ *
+ * @param params context of job
+ *
+ * @return no task woken
+ */
+static hard_timer_return_t jobHeld(hard_timer_param_t params) {
+
+	__atomic_store_n(&held, true, __ATOMIC_RELEASE);
+	for (uint8_t i = 0U; i < HELD_YIELDS; i++) {
+		sched_yield();
+	}
+	jobCheck(params, jobHeld);
+	return false;
+}
+
+/**
+ * Raises alarms of job timer until told to stop, like the other core
+ *
+ * @param params unused
+ *
+ * @return unused
+ */
+static void *alarmTask(void *params) {
+
+	while (!__atomic_load_n(&alarmsStop, __ATOMIC_ACQUIRE)) {
+		fakeTimerAlarm(jobTimerID % 2U, jobTimerID / 2U);
+		sched_yield();
+	}
+	return NULL;
+}
+
+/****************************
+ * Tests
+****************************/
+
+static void testDividers(void) {
+
+	freq_t freq = TEST_FREQ;
+	CHECK(timerJobsStart(&jobTimerID, &freq, 1U));
+
+	struct jobContext every = {.owner = jobFirst, .live = true};
+	struct jobContext third = {.owner = jobSecond, .live = true};
+	CHECK_EQ(timerJobAdd(NULL, &every, 1U), TIMER_JOB_INVALID);
+	CHECK_EQ(timerJobAdd(jobFirst, &every, 0U), TIMER_JOB_INVALID);
+	timer_job_t first = timerJobAdd(jobFirst, &every, 1U);
+	timer_job_t second = timerJobAdd(jobSecond, &third, 3U);
+	CHECK(first != TIMER_JOB_INVALID && second != TIMER_JOB_INVALID);
+	CHECK_EQ(timerJobCount(), 2U);
+
+	for (uint8_t i = 0U; i < 9U; i++) {
+		CHECK(fakeTimerAlarm(jobTimerID % 2U, jobTimerID / 2U));
+	}
+	CHECK_EQ(every.runs, 9U);
+	CHECK_EQ(third.runs, 3U);
+
+	CHECK(timerJobRemove(first));
+	CHECK(!timerJobRemove(first));
+	CHECK(timerJobRemove(second));
+	CHECK_EQ(timerJobCount(), 0U);
+	CHECK_EQ(misuses, 0U);
+}
+
+static void testReuseWhileRunning(void) {
+
+	// slots change hands while alarms keep running on another thread
+	pthread_t thread;
+	alarmsStop = false;
+	misuses = 0U;
+	CHECK(pthread_create(&thread, NULL, alarmTask, NULL) == 0);
+
+	static struct jobContext contexts[2];
+	for (uint32_t round = 0U; round < REUSE_ROUNDS; round++) {
+		struct jobContext *context = &contexts[round & 1U];
+		context -> owner = (round & 1U) ? jobSecond : jobFirst;
+		__atomic_store_n(&context -> live, true, __ATOMIC_RELEASE);
+
+		uint32_t runs = __atomic_load_n(&context -> runs, __ATOMIC_ACQUIRE);
+		timer_job_t job = timerJobAdd(context -> owner, context, 1U);
+		CHECK_EQ(job, 0U);
+
+		// removed while alarms are being handled
+		while (__atomic_load_n(&context -> runs, __ATOMIC_ACQUIRE) == runs) {
+			sched_yield();
+		}
+		CHECK(timerJobRemove(job));
+
+		// removed job never runs again, its context is free
+		__atomic_store_n(&context -> live, false, __ATOMIC_RELEASE);
+	}
+
+	__atomic_store_n(&alarmsStop, true, __ATOMIC_RELEASE);
+	pthread_join(thread, NULL);
+
+	CHECK_EQ(misuses, 0U);
+	CHECK(contexts[0].runs + contexts[1].runs >= REUSE_ROUNDS);
+	CHECK(timerJobsStop());
+}
+
+static void testRemoveDuringJob(void) {
+
+	// remove called while job is still running must not return until it is done
+	pthread_t thread;
+	alarmsStop = false;
+	misuses = 0U;
+	CHECK(pthread_create(&thread, NULL, alarmTask, NULL) == 0);
+
+	static struct jobContext context = {.owner = jobHeld};
+	for (uint32_t round = 0U; round < HELD_ROUNDS; round++) {
+		__atomic_store_n(&held, false, __ATOMIC_RELEASE);
+		__atomic_store_n(&context.live, true, __ATOMIC_RELEASE);
+
+		timer_job_t job = timerJobAdd(jobHeld, &context, 1U);
+		CHECK_EQ(job, 0U);
+		while (!__atomic_load_n(&held, __ATOMIC_ACQUIRE)) {
+			sched_yield();
+		}
+		CHECK(timerJobRemove(job));
+		__atomic_store_n(&context.live, false, __ATOMIC_RELEASE);
+	}
+
+	__atomic_store_n(&alarmsStop, true, __ATOMIC_RELEASE);
+	pthread_join(thread, NULL);
+
+	CHECK_EQ(misuses, 0U);
+	CHECK(context.runs >= HELD_ROUNDS);
+}
+
+int main(void) {
+
+	RUN_TEST(testDividers);
+	RUN_TEST(testRemoveDuringJob);
+	RUN_TEST(testReuseWhileRunning);
+
+	return TEST_END();
+}
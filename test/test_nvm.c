@@ -0,0 +1,853 @@
+/*
+	test_nvm.c - host tests of NVM cache, batches and lock
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "fake.h"
+
+// built in to reach cache and config record
+#include "board_esp32_nvm.c"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define TEST_KEYS 10U // keys written by each test
+#define TEST_WAIT_US (NVM_COMMIT_DELAY_MS * 4000U) // time commit timer surely fired in
+#define BIG_COUNT (NVM_CACHE_SIZE + 4U) // entries of record from a build with a larger cache
+#define LEGACY_READERS 2U // tasks reading legacy blobs at once
+#define LEGACY_BLOBS 8U // legacy blobs read by each task
+#define LEGACY_BASE 0x11111100U // key of legacy blobs, without zero bytes
+#define STRESS_WRITERS 3U // tasks writing their own keys at once
+#define STRESS_READERS 3U // tasks reading every key meanwhile
+#define STRESS_KEYS 4U // keys written by each writer
+#define STRESS_ROUNDS 200U // values written to each key, counting up
+#define STRESS_FLUSH 50U // rounds between flushes of each writer
+#define STRESS_TEXT 0x100U // first string key, one per writer, read from flash each time
+#define DEFAULT_NUMBER 0x200U // key Core defaults write a number to
+#define DEFAULT_TEXT 0x201U // key Core defaults write a string to
+#define DEFAULT_BLOB 0x202U // key Core defaults write a blob to
+
+/****************************
+ * Core
+****************************/
+
+enum NVMDefaultCode nvmSetCritDefaults(nvm_size_t maxSize) {
+
+	if (!nvmWriteUI32(DEFAULT_NUMBER, 42U) || !nvmWriteCharArray(DEFAULT_TEXT, "default", 16U)) {
+		return NVM_DEFAULT_FAIL_INIT;
+	}
+	return NVM_DEFAULT_OK;
+}
+
+enum NVMDefaultCode nvmSetEnvDefaults(void) {
+
+	static const uint8_t bytes[] = {1U, 2U, 3U, 4U};
+	return nvmWriteBlob(DEFAULT_BLOB, bytes, sizeof(bytes)) ? NVM_DEFAULT_OK : NVM_DEFAULT_FAIL_INIT;
+}
+
+uint8_t charArraySize(char *value) {
+
+	size_t length = strnlen(value, CHAR_LEN_ERROR);
+	return (length == CHAR_LEN_ERROR) ? CHAR_LEN_ERROR : (uint8_t)length;
+}
+
+/**
+ * Starts NVM over on blank flash
+ */
+static void setup(void) {
+
+	if (nvmBegan) {
+		nvmStop();
+	}
+	nvs_flash_erase();
+	CHECK_EQ(nvmInit(NVM_SIZE), NVM_OK);
+	fakeNvsResetCounts();
+	nvmResetTelemetry();
+}
+
+/**
+ * Stops and starts NVM, like a reboot
+ */
+static void reboot(void) {
+
+	CHECK(nvmStop());
+	CHECK_EQ(nvmInit(NVM_SIZE), NVM_OK);
+}
+
+/**
+ * Result of NVM call made by another task
+ */
+struct otherCall {
+	bool write; // writes instead of reads
+	bool done; // call returned true
+	bool busy; // 'nvmWasBusy' after call
+};
+
+/**
+ * Writes or reads key 0 from a task other than the test
+ *
+ * @param params otherCall to run and fill
+ *
+ * @return unused
+ */
+static void *otherTask(void *params) {
+
+	struct otherCall *call = params;
+	uint32_t value = 1U;
+
+	if (call -> write) {
+		call -> done = nvmWriteUI32(0U, 77U);
+	}
+	else {
+		call -> done = nvmGetUI32(0U, &value, true);
+	}
+	call -> busy = nvmWasBusy();
+
+	return NULL;
+}
+
+/**
+ * Runs NVM call on another task and waits for it
+ *
+ * @param write if call writes
+ *
+ * @return result of call
+ */
+static struct otherCall runOther(bool write) {
+
+	struct otherCall call = {.write = write};
+	pthread_t thread;
+	CHECK(pthread_create(&thread, NULL, otherTask, &call) == 0);
+	pthread_join(thread, NULL);
+
+	return call;
+}
+
+/**
+ * Sets defaults from a task other than the test
+ *
+ * @param params NVMDefaultCode to fill
+ *
+ * @return unused
+ */
+static void *defaultsTask(void *params) {
+
+	enum NVMDefaultCode *code = params;
+	*code = nvmSetDefaultsIncremental(NULL);
+
+	return NULL;
+}
+
+/**
+ * Reads legacy blobs of one reader task
+ *
+ * @param params reader number
+ *
+ * @return unused
+ */
+static void *legacyReader(void *params) {
+
+	uint32_t first = LEGACY_BLOBS * (uint32_t)(uintptr_t)params;
+
+	for (uint32_t i = first; i < first + LEGACY_BLOBS; i++) {
+		uint32_t value = 0U;
+		size_t length = sizeof(value);
+		CHECK(nvmGetBlob(LEGACY_BASE | (i + 1U), &value, &length));
+		CHECK_EQ(value, i);
+	}
+	return NULL;
+}
+
+/**
+ * Counts of stress test tasks
+ */
+struct stressCounts {
+	uint32_t busy; // calls that gave up waiting for lock
+	uint32_t failed; // calls that failed otherwise
+	uint32_t regressed; // reads older than a value read before
+};
+
+static struct stressCounts stress;
+static bool stressStop = false;
+
+/**
+ * Counts result of stress test call
+ *
+ * @param done if call returned true
+ *
+ * @return if call is done, retried when busy
+ */
+static bool stressDone(bool done) {
+
+	if (done) {
+		return true;
+	}
+	if (nvmWasBusy()) {
+		__atomic_add_fetch(&stress.busy, 1U, __ATOMIC_RELAXED);
+		return false;
+	}
+	__atomic_add_fetch(&stress.failed, 1U, __ATOMIC_RELAXED);
+	return true;
+}
+
+/**
+ * Writes counting up values to own keys, retrying busy calls
+ *
+ * @param params writer number
+ *
+ * @return unused
+ */
+static void *stressWriter(void *params) {
+
+	nvm_size_t writer = (nvm_size_t)(uintptr_t)params;
+	nvm_size_t first = STRESS_KEYS * writer;
+	char text[16];
+
+	for (uint32_t round = 1U; round <= STRESS_ROUNDS; round++) {
+		for (nvm_size_t key = first; key < first + STRESS_KEYS; key++) {
+			while (!stressDone(nvmWriteUI32(key, round))) {}
+		}
+		snprintf(text, sizeof(text), "%u", (unsigned)round);
+		while (!stressDone(nvmWriteCharArray(STRESS_TEXT + writer, text, sizeof(text)))) {}
+		if (round % STRESS_FLUSH == 0U) {
+			while (!stressDone(nvmFlush())) {}
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Reads every key until writers are done, values only count up
+ *
+ * @param params unused
+ *
+ * @return unused
+ */
+static void *stressReader(void *params) {
+
+	uint32_t last[STRESS_WRITERS * STRESS_KEYS] = {0U};
+	uint32_t lastText[STRESS_WRITERS] = {0U};
+	char text[16];
+
+	while (!__atomic_load_n(&stressStop, __ATOMIC_ACQUIRE)) {
+		for (nvm_size_t key = 0U; key < STRESS_WRITERS * STRESS_KEYS; key++) {
+			uint32_t value = 0U;
+			if (!nvmGetUI32(key, &value, true)) {
+				stressDone(false);
+				continue;
+			}
+			if (value < last[key]) {
+				__atomic_add_fetch(&stress.regressed, 1U, __ATOMIC_RELAXED);
+			}
+			last[key] = value;
+		}
+		for (nvm_size_t writer = 0U; writer < STRESS_WRITERS; writer++) {
+			if (!nvmGetCharArray(STRESS_TEXT + writer, text, sizeof(text))) {
+				stressDone(false);
+				continue;
+			}
+			uint32_t value = (uint32_t)strtoul(text, NULL, 10);
+			if (value < lastText[writer]) {
+				__atomic_add_fetch(&stress.regressed, 1U, __ATOMIC_RELAXED);
+			}
+			lastText[writer] = value;
+		}
+	}
+	return NULL;
+}
+
+/****************************
+ * Tests
+****************************/
+
+static void testCacheHits(void) {
+
+	setup();
+	CHECK(nvmWriteUI32(1U, 5U));
+	CHECK(nvmFlush());
+
+	fakeNvsResetCounts();
+	for (uint32_t i = 0U; i < 100U; i++) {
+		uint32_t value = 0U;
+		CHECK(nvmGetUI32(1U, &value, true));
+		CHECK_EQ(value, 5U);
+	}
+
+	// reads stay in RAM
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.gets, 0U);
+
+	struct nvmTelemetry telemetry;
+	CHECK(nvmGetTelemetry(&telemetry));
+	CHECK_EQ(telemetry.cacheHits, 100U);
+
+	// value only in flash is read once
+	char keyBuffer[KEY_NAME_SIZE];
+	CHECK(nvs_set_i16(handler, nvmKeyName(2U, keyBuffer), -9) == ESP_OK);
+	fakeNvsResetCounts();
+	for (uint32_t i = 0U; i < 10U; i++) {
+		int16_t value = 0;
+		CHECK(nvmGetI16(2U, &value, true));
+		CHECK_EQ(value, -9);
+	}
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.gets, 1U);
+}
+
+static void testDeferredCommit(void) {
+
+	setup();
+
+	// rewrites of a key before commit cost no flash write
+	for (uint32_t round = 1U; round <= 3U; round++) {
+		for (uint32_t key = 0U; key < TEST_KEYS; key++) {
+			CHECK(nvmWriteUI32(key, key * round));
+		}
+	}
+
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 0U);
+	CHECK_EQ(counts.commits, 0U);
+
+	// timer lands every write with one commit, each value under its own key plus journal
+	usleep(TEST_WAIT_US);
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.commits, 1U);
+	CHECK_EQ(counts.sets, TEST_KEYS + 1U);
+	CHECK_EQ(cacheDirty, 0U);
+
+	reboot();
+	for (uint32_t key = 0U; key < TEST_KEYS; key++) {
+		uint32_t value = 0U;
+		CHECK(nvmGetUI32(key, &value, true));
+		CHECK_EQ(value, key * 3U);
+	}
+}
+
+static void testUnchangedSkipped(void) {
+
+	setup();
+	CHECK(nvmWriteI8(3U, -3));
+	CHECK(nvmWriteUI64(4U, UINT64_MAX));
+	CHECK(nvmFlush());
+
+	fakeNvsResetCounts();
+	CHECK(nvmWriteI8(3U, -3));
+	CHECK(nvmWriteUI64(4U, UINT64_MAX));
+	CHECK(nvmFlush());
+	usleep(TEST_WAIT_US);
+
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 0U);
+	CHECK_EQ(counts.commits, 0U);
+
+	// value under its own key is compared on first write
+	char keyBuffer[KEY_NAME_SIZE];
+	CHECK(nvs_set_u16(handler, nvmKeyName(7U, keyBuffer), 700U) == ESP_OK);
+	fakeNvsResetCounts();
+	CHECK(nvmWriteUI16(7U, 700U));
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 0U);
+	CHECK_EQ(counts.gets, 1U);
+}
+
+static void testFlushAndReboot(void) {
+
+	setup();
+	CHECK(nvmWriteFloat(5U, 1.5f));
+	CHECK(nvmWriteBool(6U, true));
+	CHECK(nvmFlush());
+
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.commits, 1U);
+
+	// journaled values load at init, reads stay in RAM
+	reboot();
+	fakeNvsResetCounts();
+	float real = 0.0f;
+	bool flag = false;
+	CHECK(nvmGetFloat(5U, &real, true));
+	CHECK(nvmGetBool(6U, &flag, true));
+	CHECK(real == 1.5f);
+	CHECK(flag);
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.gets, 0U);
+}
+
+static void testJournalFolds(void) {
+
+	setup();
+	for (uint32_t key = 0U; key < NVM_JOURNAL_SIZE; key++) {
+		CHECK(nvmWriteUI32(key, key));
+	}
+	CHECK(nvmFlush());
+	CHECK(fakeNvsHas(JOURNAL_KEY));
+	CHECK(!fakeNvsHas(CONFIG_KEY));
+
+	// one more key than the journal lists rewrites the record instead
+	fakeNvsResetCounts();
+	CHECK(nvmWriteUI32(NVM_JOURNAL_SIZE, 1U));
+	CHECK(nvmFlush());
+
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 1U);
+	CHECK_EQ(counts.erases, NVM_JOURNAL_SIZE + 1U);
+	CHECK(fakeNvsHas(CONFIG_KEY));
+	CHECK(!fakeNvsHas(JOURNAL_KEY));
+
+	char keyBuffer[KEY_NAME_SIZE];
+	CHECK(!fakeNvsHas(nvmKeyName(0U, keyBuffer)));
+
+	// first change of a key writes it and journal, later changes only it
+	fakeNvsResetCounts();
+	CHECK(nvmWriteUI32(3U, 30U));
+	CHECK(nvmFlush());
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 2U);
+	CHECK(counts.entries < nvmDataEntries(CONFIG_HEADER_SIZE + (NVM_JOURNAL_SIZE + 1U) * sizeof(nvm_config_entry_t)));
+
+	fakeNvsResetCounts();
+	CHECK(nvmWriteUI32(3U, 31U));
+	CHECK(nvmFlush());
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 1U);
+
+	// journaled value wins over record after reboot
+	fakeNvsResetCounts();
+	reboot();
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.gets, 3U);
+
+	uint32_t value = 0U;
+	CHECK(nvmGetUI32(3U, &value, true));
+	CHECK_EQ(value, 31U);
+	CHECK(nvmGetUI32(NVM_JOURNAL_SIZE, &value, true));
+	CHECK_EQ(value, 1U);
+
+	// journal follows type of a journaled key
+	CHECK(nvmWriteI16(3U, -3));
+	CHECK(nvmFlush());
+	reboot();
+	int16_t signedValue = 0;
+	CHECK(nvmGetI16(3U, &signedValue, true));
+	CHECK_EQ(signedValue, -3);
+}
+
+static void testLegacyErased(void) {
+
+	setup();
+
+	// version 0 values under legacy and printable names
+	char legacyStr[CHAR_KEY_SIZE];
+	CHECK(nvmLegacyName(0x01020304U, legacyStr));
+	CHECK(nvs_set_u8(handler, legacyStr, 9U) == ESP_OK);
+	char keyBuffer[KEY_NAME_SIZE];
+	const char *ownStr = nvmKeyName(0x55U, keyBuffer);
+	CHECK(nvs_set_i32(handler, ownStr, -55) == ESP_OK);
+
+	uint8_t small = 0U;
+	int32_t wide = 0;
+	CHECK(nvmGetUI8(0x01020304U, &small, true));
+	CHECK(nvmGetI32(0x55U, &wide, true));
+	CHECK_EQ(small, 9U);
+	CHECK_EQ(wide, -55);
+
+	// reads leave them in place until the record holds them
+	CHECK(nvmFlush());
+	CHECK(fakeNvsHas(ownStr));
+	CHECK(fakeNvsHas(legacyStr));
+
+	for (uint32_t key = 0U; key < NVM_JOURNAL_SIZE; key++) {
+		CHECK(nvmWriteUI32(key, key));
+	}
+	CHECK(nvmFlush());
+	CHECK(fakeNvsHas(CONFIG_KEY));
+	CHECK(!fakeNvsHas(legacyStr));
+	CHECK(!fakeNvsHas(ownStr));
+	CHECK(!fakeNvsHas(nvmKeyName(0x01020304U, keyBuffer)));
+
+	reboot();
+	CHECK(nvmGetUI8(0x01020304U, &small, true));
+	CHECK(nvmGetI32(0x55U, &wide, true));
+	CHECK_EQ(small, 9U);
+	CHECK_EQ(wide, -55);
+}
+
+static void testLegacyShared(void) {
+
+	setup();
+
+	// a zero byte cuts legacy names short, so key 0x10005 shares name of key 5
+	char legacyStr[CHAR_KEY_SIZE];
+	CHECK(!nvmLegacyName(0x10005U, legacyStr));
+	CHECK(!nvmLegacyName(0U, legacyStr));
+	CHECK(nvmLegacyName(5U, legacyStr));
+	CHECK(nvs_set_u8(handler, legacyStr, 50U) == ESP_OK);
+	char stringStr[CHAR_KEY_SIZE];
+	CHECK(nvmLegacyName(7U, stringStr));
+	CHECK(nvs_set_str(handler, stringStr, "seven") == ESP_OK);
+
+	uint8_t small = 0U;
+	char text[16];
+	CHECK(!nvmGetUI8(0x10005U, &small, false));
+	CHECK(!nvmGetCharArray(0x20007U, text, sizeof(text)));
+	CHECK(nvmGetUI8(5U, &small, false));
+	CHECK_EQ(small, 50U);
+
+	// strings move to printable name, reads erase nothing
+	CHECK(nvmGetCharArray(7U, text, sizeof(text)));
+	CHECK(strcmp(text, "seven") == 0);
+	CHECK(nvmFlush());
+	char keyBuffer[KEY_NAME_SIZE];
+	CHECK(fakeNvsHas(nvmKeyName(7U, keyBuffer)));
+	CHECK(fakeNvsHas(stringStr));
+	CHECK(fakeNvsHas(legacyStr));
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.erases, 0U);
+
+	// written string outdates the legacy one
+	CHECK(nvmWriteCharArray(7U, "eight", sizeof(text)));
+	CHECK(!fakeNvsHas(stringStr));
+	CHECK(nvmGetCharArray(7U, text, sizeof(text)));
+	CHECK(strcmp(text, "eight") == 0);
+}
+
+static void testLegacyMigrateLock(void) {
+
+	setup();
+
+	char legacyStr[CHAR_KEY_SIZE];
+	for (uint32_t i = 0U; i < LEGACY_READERS * LEGACY_BLOBS; i++) {
+		CHECK(nvmLegacyName(LEGACY_BASE | (i + 1U), legacyStr));
+		CHECK(nvs_set_blob(handler, legacyStr, &i, sizeof(i)) == ESP_OK);
+	}
+	fakeNvsResetCounts();
+
+	// copies are written under the write lock, never beside a read
+	fakeNvsSetDelay(200U);
+	pthread_t threads[LEGACY_READERS];
+	for (uintptr_t i = 0U; i < LEGACY_READERS; i++) {
+		CHECK(pthread_create(&threads[i], NULL, legacyReader, (void *)i) == 0);
+	}
+	for (uint8_t i = 0U; i < LEGACY_READERS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	fakeNvsSetDelay(0U);
+
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.overlaps, 0U);
+	CHECK_EQ(counts.sets, LEGACY_READERS * LEGACY_BLOBS);
+	CHECK_EQ(counts.erases, 0U);
+
+	char keyBuffer[KEY_NAME_SIZE];
+	for (uint32_t i = 0U; i < LEGACY_READERS * LEGACY_BLOBS; i++) {
+		CHECK(fakeNvsHas(nvmKeyName(LEGACY_BASE | (i + 1U), keyBuffer)));
+	}
+}
+
+static void testOversizeRecord(void) {
+
+	setup();
+
+	// record of a build with a larger cache
+	size_t length = CONFIG_HEADER_SIZE + BIG_COUNT * sizeof(nvm_config_entry_t);
+	nvm_config_record_t *big = calloc(1U, length);
+	CHECK(big != NULL);
+	big -> version = CONFIG_VERSION;
+	big -> count = BIG_COUNT;
+	big -> entrySize = sizeof(nvm_config_entry_t);
+	big -> entriesWritten = 1234U;
+	for (uint16_t i = 0U; i < BIG_COUNT; i++) {
+		big -> entries[i].key = 1000U + i;
+		big -> entries[i].value = i;
+		big -> entries[i].type = NVM_TYPE_U16;
+	}
+	big -> crc = frameCRC16(FRAME_CRC_INIT, big -> entries, BIG_COUNT * sizeof(nvm_config_entry_t));
+	big -> crc = frameCRC16(big -> crc, &big -> entriesWritten, sizeof(big -> entriesWritten));
+	CHECK(nvs_set_blob(handler, CONFIG_KEY, big, length) == ESP_OK);
+	free(big);
+
+	// not damaged, values past the cache move to their own keys
+	reboot();
+	CHECK(!configDamaged);
+	CHECK(nvmFlush());
+
+	struct nvmDefaultStats stats;
+	CHECK_EQ(nvmSetDefaultsIncremental(&stats), NVM_DEFAULT_OK);
+	CHECK(!stats.erased);
+
+	reboot();
+	for (uint16_t i = 0U; i < BIG_COUNT; i++) {
+		uint16_t value = UINT16_MAX;
+		CHECK(nvmGetUI16(1000U + i, &value, true));
+		CHECK_EQ(value, i);
+	}
+
+	struct nvmTelemetry telemetry;
+	nvmGetTelemetry(&telemetry);
+	CHECK(telemetry.entriesWritten >= 1234U);
+}
+
+static void testDefaultsIncremental(void) {
+
+	setup();
+
+	// blank flash takes every default
+	struct nvmDefaultStats stats;
+	CHECK_EQ(nvmSetDefaultsIncremental(&stats), NVM_DEFAULT_OK);
+	CHECK(!stats.erased);
+	CHECK_EQ(stats.keys, 3U);
+
+	// stored defaults, strings and blobs too, cost no write
+	fakeNvsResetCounts();
+	CHECK_EQ(nvmSetDefaultsIncremental(&stats), NVM_DEFAULT_OK);
+	CHECK_EQ(stats.keys, 0U);
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 0U);
+
+	// only the changed string is rewritten, other keys are kept
+	CHECK(nvmWriteCharArray(DEFAULT_TEXT, "changed", 16U));
+	CHECK(nvmWriteUI32(0U, 5U));
+	CHECK_EQ(nvmSetDefaultsIncremental(&stats), NVM_DEFAULT_OK);
+	CHECK_EQ(stats.keys, 1U);
+	char text[16];
+	CHECK(nvmGetCharArray(DEFAULT_TEXT, text, sizeof(text)));
+	CHECK(strcmp(text, "default") == 0);
+	uint32_t value = 0U;
+	CHECK(nvmGetUI32(0U, &value, true));
+	CHECK_EQ(value, 5U);
+
+	// busy NVM is reported as such, nothing changes
+	CHECK(nvmWriteCharArray(DEFAULT_TEXT, "changed", 16U));
+	CHECK(nvmBeginBatch());
+	enum NVMDefaultCode code = NVM_DEFAULT_OK;
+	pthread_t thread;
+	CHECK(pthread_create(&thread, NULL, defaultsTask, &code) == 0);
+	pthread_join(thread, NULL);
+	CHECK(nvmCommitBatch(NULL));
+	CHECK_EQ(code, NVM_DEFAULT_BUSY);
+	CHECK(nvmGetCharArray(DEFAULT_TEXT, text, sizeof(text)));
+	CHECK(strcmp(text, "changed") == 0);
+
+	// damaged record erases, every default is counted again
+	configDamaged = true;
+	CHECK_EQ(nvmSetDefaultsIncremental(&stats), NVM_DEFAULT_OK);
+	CHECK(stats.erased);
+	CHECK_EQ(stats.keys, 3U);
+	CHECK(!nvmGetUI32(0U, &value, false));
+	CHECK(nvmGetCharArray(DEFAULT_TEXT, text, sizeof(text)));
+	CHECK(strcmp(text, "default") == 0);
+}
+
+static void testBatch(void) {
+
+	setup();
+	CHECK(nvmWriteUI32(0U, 100U));
+	CHECK(nvmFlush());
+	fakeNvsResetCounts();
+
+	CHECK(nvmBeginBatch());
+	CHECK(!nvmBeginBatch());
+	for (uint32_t round = 1U; round <= 3U; round++) {
+		for (uint32_t key = 0U; key < TEST_KEYS; key++) {
+			CHECK(nvmWriteUI32(key, key + round));
+		}
+	}
+
+	// owner reads its staged values before commit
+	uint32_t value = 0U;
+	CHECK(nvmGetUI32(2U, &value, true));
+	CHECK_EQ(value, 5U);
+
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 0U);
+
+	struct nvmBatchStats stats;
+	CHECK(nvmCommitBatch(&stats));
+	CHECK_EQ(stats.writes, TEST_KEYS);
+	CHECK(stats.entries != 0U);
+	CHECK_EQ(stats.pages, 1U);
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.commits, 1U);
+	CHECK(!nvmCommitBatch(NULL));
+
+	// aborted batch writes nothing
+	fakeNvsResetCounts();
+	CHECK(nvmBeginBatch());
+	CHECK(nvmWriteUI32(0U, 1U));
+	CHECK(nvmAbortBatch());
+	CHECK(!nvmAbortBatch());
+	CHECK(nvmFlush());
+	CHECK(nvmGetUI32(0U, &value, true));
+	CHECK_EQ(value, 3U);
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.sets, 0U);
+	CHECK_EQ(counts.commits, 0U);
+}
+
+static void testBatchHoldsLock(void) {
+
+	setup();
+	CHECK(nvmWriteUI32(0U, 1U));
+	CHECK(nvmBeginBatch());
+
+	// other tasks give up busy instead of failing
+	struct otherCall call = runOther(true);
+	CHECK(!call.done);
+	CHECK(call.busy);
+	call = runOther(false);
+	CHECK(!call.done);
+	CHECK(call.busy);
+
+	CHECK(nvmCommitBatch(NULL));
+	call = runOther(true);
+	CHECK(call.done);
+	CHECK(!call.busy);
+
+	uint32_t value = 0U;
+	CHECK(nvmGetUI32(0U, &value, true));
+	CHECK_EQ(value, 77U);
+
+	struct nvmTelemetry telemetry;
+	CHECK(nvmGetTelemetry(&telemetry));
+	CHECK_EQ(telemetry.busy, 2U);
+}
+
+static void testAsyncLandFails(void) {
+
+	setup();
+	CHECK(nvmAsyncStart());
+
+	// dropped writes fail the flush waiting on them, not as busy
+	fakeNvsFailWrites(true);
+	nvm_async_t handle = {0};
+	CHECK(nvmWriteUI32Async(1U, 5U, &handle));
+	CHECK(!nvmAsyncDrain());
+	CHECK(!nvmWasBusy());
+	CHECK_EQ(nvmAsyncWait(&handle, 0U), NVM_ASYNC_FAILED);
+	CHECK(!nvmFlush());
+	CHECK(!nvmWasBusy());
+
+	// later flushes are not failed by earlier lands
+	fakeNvsFailWrites(false);
+	CHECK(nvmWriteUI32Async(1U, 6U, &handle));
+	CHECK(nvmFlush());
+	CHECK_EQ(nvmAsyncWait(&handle, 0U), NVM_ASYNC_WRITTEN);
+	CHECK(nvmAsyncStop());
+
+	reboot();
+	uint32_t value = 0U;
+	CHECK(nvmGetUI32(1U, &value, true));
+	CHECK_EQ(value, 6U);
+}
+
+static void testLockStress(void) {
+
+	setup();
+
+	for (nvm_size_t key = 0U; key < STRESS_WRITERS * STRESS_KEYS; key++) {
+		CHECK(nvmWriteUI32(key, 0U));
+	}
+	for (nvm_size_t writer = 0U; writer < STRESS_WRITERS; writer++) {
+		CHECK(nvmWriteCharArray(STRESS_TEXT + writer, "0", 16U));
+	}
+	CHECK(nvmFlush());
+	fakeNvsResetCounts();
+	stress = (struct stressCounts){0U};
+	stressStop = false;
+
+	// slow flash widens the window of every call
+	fakeNvsSetDelay(20U);
+	pthread_t readers[STRESS_READERS];
+	pthread_t writers[STRESS_WRITERS];
+	for (uintptr_t i = 0U; i < STRESS_READERS; i++) {
+		CHECK(pthread_create(&readers[i], NULL, stressReader, NULL) == 0);
+	}
+	for (uintptr_t i = 0U; i < STRESS_WRITERS; i++) {
+		CHECK(pthread_create(&writers[i], NULL, stressWriter, (void *)i) == 0);
+	}
+	for (uint8_t i = 0U; i < STRESS_WRITERS; i++) {
+		pthread_join(writers[i], NULL);
+	}
+	__atomic_store_n(&stressStop, true, __ATOMIC_RELEASE);
+	for (uint8_t i = 0U; i < STRESS_READERS; i++) {
+		pthread_join(readers[i], NULL);
+	}
+	fakeNvsSetDelay(0U);
+
+	// busy calls were retried, none failed
+	CHECK_EQ(stress.failed, 0U);
+	CHECK_EQ(stress.regressed, 0U);
+
+	// flash was never written beside another call
+	struct fakeNvsCounts counts;
+	fakeNvsGetCounts(&counts);
+	CHECK_EQ(counts.overlaps, 0U);
+
+	// no write was lost on the way to flash
+	CHECK(nvmFlush());
+	reboot();
+	for (nvm_size_t key = 0U; key < STRESS_WRITERS * STRESS_KEYS; key++) {
+		uint32_t value = 0U;
+		CHECK(nvmGetUI32(key, &value, false));
+		CHECK_EQ(value, STRESS_ROUNDS);
+	}
+	char text[16];
+	for (nvm_size_t writer = 0U; writer < STRESS_WRITERS; writer++) {
+		CHECK(nvmGetCharArray(STRESS_TEXT + writer, text, sizeof(text)));
+		CHECK_EQ(strtoul(text, NULL, 10), STRESS_ROUNDS);
+	}
+
+	// failing flash is told apart from a busy lock
+	fakeNvsFailWrites(true);
+	CHECK(nvmWriteUI32(0U, 1U));
+	CHECK(!nvmFlush());
+	CHECK(!nvmWasBusy());
+	fakeNvsFailWrites(false);
+	CHECK(nvmFlush());
+}
+
+int main(void) {
+
+	RUN_TEST(testCacheHits);
+	RUN_TEST(testDeferredCommit);
+	RUN_TEST(testUnchangedSkipped);
+	RUN_TEST(testFlushAndReboot);
+	RUN_TEST(testJournalFolds);
+	RUN_TEST(testLegacyErased);
+	RUN_TEST(testLegacyShared);
+	RUN_TEST(testLegacyMigrateLock);
+	RUN_TEST(testOversizeRecord);
+	RUN_TEST(testDefaultsIncremental);
+	RUN_TEST(testBatch);
+	RUN_TEST(testBatchHoldsLock);
+	RUN_TEST(testLockStress);
+	RUN_TEST(testAsyncLandFails);
+
+	return TEST_END();
+}
@@ -0,0 +1,210 @@
+/*
+	test_ring.c - host tests of lock-free sample ring
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "board_esp32_ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#define RING_SIZE 8U // items in small rings
+#define STRESS_SIZE 64U // items in stress ring
+#define STRESS_ITEMS 2000000U // items pushed by stress producer
+#define STRESS_BATCH 17U // pop size not dividing ring size
+
+static sample_ring_t ring;
+static ring_item_t storage[RING_SIZE];
+
+static sample_ring_t stressRing;
+static ring_item_t stressStorage[STRESS_SIZE];
+
+static void testInit(void) {
+
+	CHECK(!sampleRingInit(&ring, storage, 0U));
+	CHECK(!sampleRingInit(&ring, storage, 6U));
+	CHECK(!sampleRingInit(&ring, NULL, RING_SIZE));
+	CHECK(sampleRingInit(&ring, storage, RING_SIZE));
+	CHECK_EQ(sampleRingCount(&ring), 0U);
+}
+
+static void testFullEmpty(void) {
+
+	CHECK(sampleRingInit(&ring, storage, RING_SIZE));
+
+	ring_item_t item;
+	ring_item_t *span;
+	CHECK_EQ(sampleRingPop(&ring, &item, 1U), 0U);
+	CHECK_EQ(sampleRingPeek(&ring, &span), 0U);
+	CHECK_EQ(sampleRingConsume(&ring, 1U), 0U);
+
+	for (uint32_t i = 0U; i < RING_SIZE; i++) {
+		CHECK(sampleRingPush(&ring, (ring_item_t)i));
+	}
+	CHECK_EQ(sampleRingCount(&ring), RING_SIZE);
+	CHECK(!sampleRingPush(&ring, 99U));
+	CHECK(!sampleRingPush(&ring, 99U));
+	CHECK_EQ(sampleRingDropped(&ring), 2U);
+	CHECK_EQ(sampleRingHighWater(&ring), RING_SIZE);
+
+	// one slot freed takes exactly one more push
+	CHECK_EQ(sampleRingPop(&ring, &item, 1U), 1U);
+	CHECK_EQ(item, 0U);
+	CHECK(sampleRingPush(&ring, 8U));
+	CHECK(!sampleRingPush(&ring, 99U));
+
+	ring_item_t out[RING_SIZE + 2U];
+	CHECK_EQ(sampleRingPop(&ring, out, RING_SIZE + 2U), RING_SIZE);
+	for (uint32_t i = 0U; i < RING_SIZE; i++) {
+		CHECK_EQ(out[i], i + 1U);
+	}
+	CHECK_EQ(sampleRingCount(&ring), 0U);
+	CHECK_EQ(sampleRingHighWater(&ring), RING_SIZE);
+}
+
+static void testWrapSpans(void) {
+
+	CHECK(sampleRingInit(&ring, storage, RING_SIZE));
+
+	// moves start of stored items to the last 3 slots
+	for (uint32_t i = 0U; i < RING_SIZE - 3U; i++) {
+		CHECK(sampleRingPush(&ring, 0U));
+	}
+	CHECK_EQ(sampleRingConsume(&ring, RING_SIZE - 3U), RING_SIZE - 3U);
+
+	for (uint32_t i = 0U; i < 6U; i++) {
+		CHECK(sampleRingPush(&ring, (ring_item_t)(100U + i)));
+	}
+
+	// peek stops at end of storage, second peek gets wrapped items
+	ring_item_t *span;
+	CHECK_EQ(sampleRingPeek(&ring, &span), 3U);
+	CHECK(span == &storage[RING_SIZE - 3U]);
+	CHECK_EQ(span[0], 100U);
+	CHECK_EQ(span[2], 102U);
+	CHECK_EQ(sampleRingConsume(&ring, 3U), 3U);
+
+	CHECK_EQ(sampleRingPeek(&ring, &span), 3U);
+	CHECK(span == &storage[0]);
+	CHECK_EQ(span[0], 103U);
+	CHECK_EQ(sampleRingConsume(&ring, 10U), 3U);
+	CHECK_EQ(sampleRingCount(&ring), 0U);
+
+	// batch pop copies across the wrap in one call
+	for (uint32_t i = 0U; i < 6U; i++) {
+		CHECK(sampleRingPush(&ring, (ring_item_t)(200U + i)));
+	}
+	ring_item_t out[6];
+	CHECK_EQ(sampleRingPop(&ring, out, 6U), 6U);
+	for (uint32_t i = 0U; i < 6U; i++) {
+		CHECK_EQ(out[i], 200U + i);
+	}
+}
+
+static void testCounterWrap(void) {
+
+	CHECK(sampleRingInit(&ring, storage, RING_SIZE));
+
+	// free running counters roll over 32 bits mid ring
+	ring.head = UINT32_MAX - 2U;
+	ring.tail = UINT32_MAX - 2U;
+
+	for (uint32_t i = 0U; i < RING_SIZE; i++) {
+		CHECK(sampleRingPush(&ring, (ring_item_t)(300U + i)));
+	}
+	CHECK(!sampleRingPush(&ring, 99U));
+	CHECK_EQ(sampleRingCount(&ring), RING_SIZE);
+
+	ring_item_t out[RING_SIZE];
+	CHECK_EQ(sampleRingPop(&ring, out, RING_SIZE), RING_SIZE);
+	for (uint32_t i = 0U; i < RING_SIZE; i++) {
+		CHECK_EQ(out[i], 300U + i);
+	}
+	CHECK_EQ(sampleRingCount(&ring), 0U);
+}
+
+/**
+ * Pushes counting items as fast as ring allows
+ *
+ * @param params unused
+ *
+ * @return unused
+ */
+static void *stressProducer(void *params) {
+
+	for (uint32_t i = 0U; i < STRESS_ITEMS;) {
+		if (sampleRingPush(&stressRing, (ring_item_t)i)) {
+			i++;
+		}
+		else {
+			// lets consumer run when both share one CPU
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void testStress(void) {
+
+	CHECK(sampleRingInit(&stressRing, stressStorage, STRESS_SIZE));
+
+	pthread_t producer;
+	CHECK(pthread_create(&producer, NULL, stressProducer, NULL) == 0);
+
+	// consumer alternates batch pops and zero copy spans
+	uint32_t expected = 0U;
+	uint32_t bad = 0U;
+	ring_item_t batch[STRESS_BATCH];
+
+	while (expected < STRESS_ITEMS) {
+		if (sampleRingCount(&stressRing) == 0U) {
+			sched_yield();
+		}
+		else if ((expected & 1U) != 0U) {
+			uint32_t count = sampleRingPop(&stressRing, batch, STRESS_BATCH);
+			for (uint32_t i = 0U; i < count; i++, expected++) {
+				bad += batch[i] != (ring_item_t)expected;
+			}
+		}
+		else {
+			ring_item_t *span;
+			uint32_t count = sampleRingPeek(&stressRing, &span);
+			for (uint32_t i = 0U; i < count; i++, expected++) {
+				bad += span[i] != (ring_item_t)expected;
+			}
+			sampleRingConsume(&stressRing, count);
+		}
+	}
+	pthread_join(producer, NULL);
+
+	CHECK_EQ(bad, 0U);
+	CHECK_EQ(sampleRingCount(&stressRing), 0U);
+	CHECK(sampleRingHighWater(&stressRing) <= STRESS_SIZE);
+	CHECK(sampleRingHighWater(&stressRing) > 0U);
+}
+
+int main(void) {
+
+	RUN_TEST(testInit);
+	RUN_TEST(testFullEmpty);
+	RUN_TEST(testWrapSpans);
+	RUN_TEST(testCounterWrap);
+	RUN_TEST(testStress);
+
+	return TEST_END();
+}
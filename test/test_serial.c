@@ -0,0 +1,223 @@
+/*
+	test_serial.c - host tests of binary frame TX
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "fake.h"
+
+#include "../board.h"
+#include "board_esp32_frame.h"
+
+#include <driver/uart.h>
+#include <pthread.h>
+#include <string.h>
+
+#define TEST_BAUD 921600U // baud frames are sent at
+#define CAPACITY 256U // payload bytes decoder holds
+#define SENDERS 2U // tasks sending frames at once
+#define SENDER_FRAMES 500U // frames sent by each task
+#define TEXT_LINES 500U // text lines printed meanwhile
+
+static frame_decoder_t decoder;
+static uint8_t payload[CAPACITY];
+
+/**
+ * Decodes captured TX bytes
+ *
+ * @param writes pointer to store UART writes made, can be NULL
+ * @param errors pointer to store decode errors
+ *
+ * @return frames decoded
+ */
+static uint32_t decodeTx(uint32_t *writes, uint32_t *errors) {
+
+	const uint8_t *bytes;
+	size_t length = fakeUartTake(&bytes, writes);
+	uint32_t frames = 0U;
+	*errors = 0U;
+
+	for (size_t i = 0U; i < length; i++) {
+		enum FrameDecodeResult result = frameDecodeByte(&decoder, bytes[i]);
+		if (result == FRAME_DECODE_READY) {
+			frames++;
+		}
+		else if (result == FRAME_DECODE_ERROR) {
+			(*errors)++;
+		}
+	}
+
+	return frames;
+}
+
+/**
+ * Sends frames whose payload repeats sender number
+ *
+ * @param params sender number
+ *
+ * @return unused
+ */
+static void *sender(void *params) {
+
+	uint8_t id = (uint8_t)(uintptr_t)params;
+	uint8_t data[CAPACITY];
+
+	for (uint32_t i = 0U; i < SENDER_FRAMES; i++) {
+		uint16_t length = (uint16_t)(1U + (i * 37U) % CAPACITY);
+		memset(data, id, length);
+		serialFrameSend(FRAME_SAMPLES, data, length);
+	}
+	return NULL;
+}
+
+/**
+ * Prints text lines straight to the UART, like printf does
+ *
+ * @param params unused
+ *
+ * @return unused
+ */
+static void *printer(void *params) {
+
+	static const char line[] = "text between frames\n";
+
+	for (uint32_t i = 0U; i < TEXT_LINES; i++) {
+		uart_write_bytes(UART_NUM_0, line, sizeof(line) - 1U);
+	}
+	return NULL;
+}
+
+static void setup(void) {
+
+	CHECK(serialFrameBegin(TEST_BAUD));
+	CHECK(frameDecoderInit(&decoder, payload, CAPACITY));
+	fakeUartSetTxFree(SERIAL_TX_BUFFER_SIZE);
+
+	const uint8_t *bytes;
+	fakeUartTake(&bytes, NULL);
+}
+
+static void testOneWritePerFrame(void) {
+
+	setup();
+
+	static const uint8_t data[] = {1U, 2U, 3U, 4U, 5U};
+	CHECK(serialFrameSend(FRAME_STATS, data, sizeof(data)));
+	CHECK(serialFrameSend(FRAME_CONTROL, NULL, 0U));
+	CHECK(!serialFrameSend(FRAME_STATS, NULL, 1U));
+	CHECK(!serialFrameSend(FRAME_STATS, data, FRAME_MAX_PAYLOAD + 1U));
+
+	uint32_t writes;
+	uint32_t errors;
+	CHECK_EQ(decodeTx(&writes, &errors), 2U);
+	CHECK_EQ(writes, 2U);
+	CHECK_EQ(errors, 0U);
+	CHECK_EQ(decoder.type, FRAME_CONTROL);
+	CHECK_EQ(decoder.seq, 1U);
+
+	struct serialFrameStats stats;
+	serialFrameGetStats(&stats);
+	CHECK_EQ(stats.sent, 2U);
+	CHECK_EQ(stats.dropped, 0U);
+	CHECK_EQ(stats.bytes, 2U * (FRAME_HEADER_SIZE + FRAME_CRC_SIZE) + sizeof(data));
+}
+
+static void testFullBuffer(void) {
+
+	setup();
+
+	static const uint8_t data[16] = {0U};
+	fakeUartSetTxFree(FRAME_HEADER_SIZE + sizeof(data) + FRAME_CRC_SIZE - 1U);
+	CHECK(!serialFrameSend(FRAME_SAMPLES, data, sizeof(data)));
+	CHECK(serialFrameSend(FRAME_SAMPLES, data, 4U));
+
+	fakeUartSetTxFree(SERIAL_TX_BUFFER_SIZE);
+	CHECK(serialFrameSend(FRAME_SAMPLES, data, sizeof(data)));
+
+	// dropped frame still takes a sequence so the host sees the gap
+	uint32_t writes;
+	uint32_t errors;
+	CHECK_EQ(decodeTx(&writes, &errors), 2U);
+	CHECK_EQ(writes, 2U);
+	CHECK_EQ(decoder.lost, 1U);
+
+	struct serialFrameStats stats;
+	serialFrameGetStats(&stats);
+	CHECK_EQ(stats.sent, 2U);
+	CHECK_EQ(stats.dropped, 1U);
+}
+
+static void testConcurrentSenders(void) {
+
+	setup();
+
+	pthread_t threads[SENDERS + 1U];
+	for (uintptr_t i = 0U; i < SENDERS; i++) {
+		CHECK(pthread_create(&threads[i], NULL, sender, (void *)(i + 1U)) == 0);
+	}
+	CHECK(pthread_create(&threads[SENDERS], NULL, printer, NULL) == 0);
+	for (uint8_t i = 0U; i <= SENDERS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	// senders never wait on each other, a frame sent meanwhile is dropped
+	struct serialFrameStats stats;
+	serialFrameGetStats(&stats);
+	CHECK_EQ(stats.sent + stats.dropped, SENDERS * SENDER_FRAMES);
+
+	// text lands between frames, never inside one
+	uint32_t writes;
+	uint32_t errors;
+	CHECK_EQ(decodeTx(&writes, &errors), stats.sent);
+	CHECK_EQ(writes, stats.sent + TEXT_LINES);
+	CHECK_EQ(errors, 0U);
+	CHECK_EQ(decoder.crcErrors, 0U);
+
+	// sequence is taken in write order, dropped frames leave gaps
+	CHECK(decoder.lost <= stats.dropped);
+	CHECK(stats.dropped != 0U || decoder.lost == 0U);
+}
+
+static void testNegotiateWithoutDriver(void) {
+
+	uart_driver_delete(UART_NUM_0);
+	uart_set_baudrate(UART_NUM_0, 9600U);
+	fakeUartFailInstall(true);
+
+	// baud is still set, like a plain begin
+	CHECK_EQ(serialLinkNegotiate(TEST_BAUD, SERIAL_BAUD_MAX), TEST_BAUD);
+	uint32_t baud = 0U;
+	CHECK(uart_get_baudrate(UART_NUM_0, &baud) == ESP_OK);
+	CHECK_EQ(baud, TEST_BAUD);
+
+	struct serialLinkStats stats;
+	serialLinkGetStats(&stats);
+	CHECK_EQ(stats.baud, TEST_BAUD);
+
+	fakeUartFailInstall(false);
+}
+
+int main(void) {
+
+	CHECK(!serialFrameSend(FRAME_STATS, NULL, 0U));
+
+	RUN_TEST(testOneWritePerFrame);
+	RUN_TEST(testFullBuffer);
+	RUN_TEST(testConcurrentSenders);
+	RUN_TEST(testNegotiateWithoutDriver);
+
+	return TEST_END();
+}
@@ -0,0 +1,415 @@
+/*
+	test_timer.c - host tests of timer divisor solving and setup
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "fake.h"
+
+// built in to reach timer states
+#include "board_esp32_timer.c"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#define SWEEP_DENSE 5000U // every freq up to here is swept
+#define SWEEP_STRIDE 9973U // stride of sparse sweep above SWEEP_DENSE
+#define TEST_CONTEXT 0x5AU // context byte passed to timer function
+#define CLAIMERS 4U // threads claiming timers at once
+#define STARTERS 2U // threads starting unclaimed timers at once
+#define STRESS_ROUNDS 20000U // claims or starts made by each thread
+#define GROUP_WRITE_NS 20000U // register write time while group starts
+#define SKEW_LIMIT_NS 50000000U // host scheduling allowance of group skew
+#define LATENCY_LIMIT_NS 10000000U // host scheduling allowance of ISR latency
+
+#define PRIME_FREQ 23U // freq whose count is an odd prime
+#define PRIME_COUNT 3478261U // APB_CLK ticks of PRIME_FREQ
+
+static uint32_t owners[NUM_TIMERS]; // threads holding each timer
+static uint32_t collisions = 0U; // times a held timer was handed out again
+static uint32_t grants = 0U;
+
+static uint8_t contextByte = TEST_CONTEXT;
+static void *seenContext = NULL;
+static uint32_t calls = 0U;
+
+_Static_assert(HARD_TIMER_STATIC_EXACT(1024U), "1024 Hz splits exactly");
+_Static_assert(!HARD_TIMER_STATIC_EXACT(1U * APB_CLK_FREQ), "count below smallest divider");
+
+/**
+ * Timer function recording its context
+ *
+ * @param context user context
+ *
+ * @return no yield needed
+ */
+static bool alarmFunction(void *context) {
+
+	seenContext = context;
+	calls++;
+	return false;
+}
+
+/**
+ * Gets whether timer groups can split count into divider and ticks
+ *
+ * @param count APB_CLK ticks per alarm
+ *
+ * @return if some divider in range divides count
+ */
+static bool bruteSplits(uint32_t count) {
+
+	if (count < HARD_TIMER_MIN_SCALAR) {
+		return false;
+	}
+	for (uint32_t divider = HARD_TIMER_MIN_SCALAR; divider <= HARD_TIMER_MAX_SCALAR && divider <= count; divider++) {
+		if (count % divider == 0U) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Marks timer held by caller, counting it if someone else holds it
+ *
+ * @param timer timer handed out
+ */
+static void holdTimer(hard_timer_t timer) {
+
+	if (__atomic_add_fetch(&owners[timer], 1U, __ATOMIC_ACQ_REL) != 1U) {
+		__atomic_add_fetch(&collisions, 1U, __ATOMIC_RELAXED);
+	}
+	__atomic_add_fetch(&grants, 1U, __ATOMIC_RELAXED);
+	sched_yield();
+	__atomic_sub_fetch(&owners[timer], 1U, __ATOMIC_ACQ_REL);
+}
+
+/**
+ * Claims and unclaims timers with ISR core of thread number
+ *
+ * @param params thread number
+ *
+ * @return unused
+ */
+static void *claimer(void *params) {
+
+	uint8_t core = (uint8_t)((uintptr_t)params % CORE_COUNT);
+	struct hardTimerPriority priority = {.priority = 1U};
+
+	fakeSetCore(core);
+	for (uint32_t i = 0U; i < STRESS_ROUNDS; i++) {
+		hard_timer_t timer = claimTimerCore(&priority, core);
+		if (timer == HARD_TIMER_INVALID) {
+			continue;
+		}
+		if (timerCores[timer] != core) {
+			__atomic_add_fetch(&collisions, 1U, __ATOMIC_RELAXED);
+		}
+		holdTimer(timer);
+		unclaimTimer(timer);
+	}
+	return NULL;
+}
+
+/**
+ * Starts and cancels unclaimed timers
+ *
+ * @param params thread number
+ *
+ * @return unused
+ */
+static void *starter(void *params) {
+
+	fakeSetCore((int)((uintptr_t)params % CORE_COUNT));
+	for (uint32_t i = 0U; i < STRESS_ROUNDS; i++) {
+		hard_timer_t timer = HARD_TIMER_INVALID;
+		freq_t freq = 1000U;
+		if (!setHardTimer(&timer, &freq, alarmFunction, 1U)) {
+			continue;
+		}
+		holdTimer(timer);
+		cancelHardTimer(timer);
+	}
+	return NULL;
+}
+
+/**
+ * Checks solver against every splittable count near APB_CLK / freq
+ *
+ * @param freq frequency to check
+ */
+static void checkSolve(freq_t freq) {
+
+	struct hardTimerDivisor divisor;
+	enum HardTimerStatusReturn status = hardTimerSolve(freq, &divisor);
+	CHECK(status != HARD_TIMER_FAIL);
+	if (status == HARD_TIMER_FAIL) {
+		return;
+	}
+
+	uint64_t count = (uint64_t)divisor.scalar * divisor.timerTicks;
+	CHECK(divisor.scalar >= HARD_TIMER_MIN_SCALAR);
+	CHECK_EQ(divisor.freq, APB_CLK_FREQ / count);
+	CHECK_EQ(status == HARD_TIMER_OK, count * freq == APB_CLK_FREQ);
+
+	// no splittable count lands closer to freq
+	uint64_t error = llabs((long long)(count * freq) - (long long)APB_CLK_FREQ);
+	uint32_t center = APB_CLK_FREQ / freq;
+	for (uint32_t candidate = (center > 2U) ? center - 2U : 1U; candidate <= center + 2U; candidate++) {
+		uint64_t candidateError = llabs((long long)((uint64_t)candidate * freq) - (long long)APB_CLK_FREQ);
+		if (candidateError < error && bruteSplits(candidate)) {
+			CHECK_EQ(candidate, count);
+		}
+	}
+}
+
+/**
+ * Checks static macros split freq like solver
+ *
+ * @param freq constant frequency
+ * @param scalar divider of static macros
+ * @param timerTicks ticks of static macros
+ */
+static void checkStatic(freq_t freq, prescalar_t scalar, timertick_t timerTicks) {
+
+	struct hardTimerDivisor divisor;
+	CHECK(hardTimerSolve(freq, &divisor) != HARD_TIMER_FAIL);
+	CHECK_EQ(scalar, divisor.scalar);
+	CHECK_EQ(timerTicks, divisor.timerTicks);
+	CHECK_EQ(HARD_TIMER_STATIC_FREQ(freq), divisor.freq);
+	CHECK_EQ(HARD_TIMER_STATIC_COUNT(freq), (uint64_t)scalar * timerTicks);
+}
+
+#define CHECK_STATIC(freq) CHECK(HARD_TIMER_STATIC_EXACT(freq)); checkStatic((freq), HARD_TIMER_STATIC_SCALAR(freq), HARD_TIMER_STATIC_TICKS(freq))
+
+/****************************
+ * Tests
+****************************/
+
+static void testSolverSweep(void) {
+
+	for (freq_t freq = 1U; freq <= SWEEP_DENSE; freq++) {
+		checkSolve(freq);
+	}
+	for (freq_t freq = SWEEP_DENSE; freq <= APB_CLK_FREQ / HARD_TIMER_MIN_SCALAR; freq += SWEEP_STRIDE) {
+		checkSolve(freq);
+	}
+	checkSolve(APB_CLK_FREQ / HARD_TIMER_MIN_SCALAR);
+
+	struct hardTimerDivisor divisor;
+	CHECK(hardTimerSolve(0U, &divisor) == HARD_TIMER_FAIL);
+	CHECK(hardTimerSolve(APB_CLK_FREQ / HARD_TIMER_MIN_SCALAR + 1U, &divisor) == HARD_TIMER_FAIL);
+}
+
+static void testStaticMatchesSolver(void) {
+
+	CHECK_STATIC(1U);
+	CHECK_STATIC(2U);
+	CHECK_STATIC(3U);
+	CHECK_STATIC(7U);
+	CHECK_STATIC(50U);
+	CHECK_STATIC(60U);
+	CHECK_STATIC(1000U);
+	CHECK_STATIC(1024U);
+	CHECK_STATIC(44100U);
+	CHECK_STATIC(48000U);
+	CHECK_STATIC(1000000U);
+	CHECK_STATIC(40000000U);
+
+	// odd counts past a divider alone are no longer rounded to even
+	CHECK_EQ(HARD_TIMER_STATIC_SCALAR(1024U), 5U);
+	CHECK_EQ(HARD_TIMER_STATIC_TICKS(1024U), 15625U);
+	CHECK_EQ(HARD_TIMER_STATIC_FREQ(1024U), 1024U);
+
+	// prime count has no exact split, solver moves it to a neighbour
+	struct hardTimerDivisor divisor;
+	CHECK_EQ(HARD_TIMER_STATIC_COUNT(PRIME_FREQ), PRIME_COUNT);
+	CHECK(!HARD_TIMER_STATIC_EXACT(PRIME_FREQ));
+	CHECK_EQ(HARD_TIMER_STATIC_TICKS(PRIME_FREQ), 0U);
+	CHECK(hardTimerSolve(PRIME_FREQ, &divisor) == HARD_TIMER_SLIGHTLY_OFF);
+	CHECK_EQ((uint64_t)divisor.scalar * divisor.timerTicks, PRIME_COUNT - 1U);
+}
+
+static void testStaticContext(void) {
+
+	hard_timer_t timer = HARD_TIMER_INVALID;
+	calls = 0U;
+	CHECK(SET_HARD_TIMER_STATIC_CONTEXT(&timer, 1024U, alarmFunction, 1U, &contextByte));
+	CHECK(timer != HARD_TIMER_INVALID);
+	CHECK(hardTimerStarted(timer));
+
+	struct fakeTimerState state;
+	fakeTimerGetState(timerGroups[timer].group, timerGroups[timer].num, &state);
+	CHECK(state.running);
+	CHECK(state.alarmEnabled);
+	CHECK(state.autoReload);
+	CHECK_EQ(state.divider, 5U);
+	CHECK_EQ(state.alarm, 15625U);
+	CHECK_EQ(state.load, 0U);
+
+	#ifdef HARD_TIMER_RAW_ISR
+		CHECK_EQ(fakeIntrLive(), 1U);
+	#else
+		CHECK_EQ(fakeIntrLive(), 0U);
+	#endif
+
+	// each alarm reaches function with context and re-arms
+	for (uint32_t i = 0U; i < 3U; i++) {
+		CHECK(fakeTimerAlarm(timerGroups[timer].group, timerGroups[timer].num));
+	}
+	CHECK_EQ(calls, 3U);
+	CHECK(seenContext == &contextByte);
+	fakeTimerGetState(timerGroups[timer].group, timerGroups[timer].num, &state);
+	CHECK(state.alarmEnabled);
+
+	CHECK(cancelHardTimer(timer));
+	CHECK_EQ(fakeIntrLive(), 0U);
+	CHECK(!fakeTimerAlarm(timerGroups[timer].group, timerGroups[timer].num));
+	CHECK_EQ(calls, 3U);
+}
+
+static void testStaticNoContext(void) {
+
+	hard_timer_t timer = HARD_TIMER_INVALID;
+	calls = 0U;
+	seenContext = &contextByte;
+	CHECK(SET_HARD_TIMER_STATIC(&timer, 48000U, alarmFunction, 1U));
+
+	struct fakeTimerState state;
+	fakeTimerGetState(timerGroups[timer].group, timerGroups[timer].num, &state);
+	CHECK_EQ((uint64_t)state.divider * state.alarm, HARD_TIMER_STATIC_COUNT(48000U));
+
+	CHECK(fakeTimerAlarm(timerGroups[timer].group, timerGroups[timer].num));
+	CHECK_EQ(calls, 1U);
+	CHECK(seenContext == NULL);
+	CHECK(cancelHardTimer(timer));
+}
+
+static void testConcurrentClaims(void) {
+
+	pthread_t threads[CLAIMERS + STARTERS];
+	for (uintptr_t i = 0U; i < CLAIMERS; i++) {
+		CHECK(pthread_create(&threads[i], NULL, claimer, (void *)i) == 0);
+	}
+	for (uintptr_t i = 0U; i < STARTERS; i++) {
+		CHECK(pthread_create(&threads[CLAIMERS + i], NULL, starter, (void *)i) == 0);
+	}
+	for (uint8_t i = 0U; i < CLAIMERS + STARTERS; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	// no timer ever had two holders, and every one is free again
+	CHECK_EQ(collisions, 0U);
+	CHECK(grants > STRESS_ROUNDS);
+	CHECK_EQ(__atomic_load_n(&taken, __ATOMIC_ACQUIRE), 0U);
+	CHECK_EQ(__atomic_load_n(&claimed, __ATOMIC_ACQUIRE), 0U);
+	CHECK_EQ(fakeIntrLive(), 0U);
+	for (hard_timer_t timer = 0U; timer < NUM_TIMERS; timer++) {
+		CHECK(!hardTimerStarted(timer));
+		CHECK_EQ(timerCores[timer], HARD_TIMER_ANY_CORE);
+	}
+}
+
+static void testGroupPhases(void) {
+
+	struct hardTimerGroupEntry entries[NUM_TIMERS];
+	for (uint8_t i = 0U; i < NUM_TIMERS; i++) {
+		entries[i] = (struct hardTimerGroupEntry){.timer = HARD_TIMER_INVALID, .function = alarmFunction, .context = NULL, .phase = i};
+	}
+
+	// each enable takes GROUP_WRITE_NS, so counters start that far apart
+	freq_t freq = 1000U;
+	uint32_t skewNS = 0U;
+	fakeTimerSetRegDelay(GROUP_WRITE_NS);
+	CHECK(setHardTimerGroup(entries, NUM_TIMERS, NUM_TIMERS, &freq, 1U, &skewNS));
+	fakeTimerSetRegDelay(0U);
+	// host may preempt between first latch and its cycle stamp, hiding the gap after the first write
+	CHECK(skewNS >= (NUM_TIMERS - 2U) * GROUP_WRITE_NS);
+	CHECK(skewNS < SKEW_LIMIT_NS);
+	CHECK_EQ(freq, 1000U);
+
+	timertick_t period = APB_CLK_FREQ / (HARD_TIMER_MIN_SCALAR * 1000U);
+	for (uint8_t i = 0U; i < NUM_TIMERS; i++) {
+		uint8_t group = timerGroups[entries[i].timer].group;
+		uint8_t num = timerGroups[entries[i].timer].num;
+
+		// phase is in first alarm, reload stays 0 so every period is whole
+		struct fakeTimerState state;
+		fakeTimerGetState(group, num, &state);
+		CHECK(state.running);
+		CHECK(state.autoReload);
+		CHECK_EQ(state.load, 0U);
+		CHECK_EQ(state.alarm, (i == 0U) ? period : period * i / NUM_TIMERS);
+
+		for (uint8_t alarm = 0U; alarm < 2U; alarm++) {
+			CHECK(fakeTimerAlarm(group, num));
+			fakeTimerGetState(group, num, &state);
+			CHECK_EQ(state.alarm, period);
+			CHECK_EQ(state.load, 0U);
+			CHECK(state.counter < period / 2U);
+		}
+	}
+
+	for (uint8_t i = 0U; i < NUM_TIMERS; i++) {
+		CHECK(cancelHardTimer(entries[i].timer));
+	}
+}
+
+#ifdef HARD_TIMER_LATENCY
+
+static void testLatencyAfterPreload(void) {
+
+	// quarter period phase delays first alarm, reload stays 0
+	struct hardTimerGroupEntry entries[2] = {
+		{.timer = HARD_TIMER_INVALID, .function = alarmFunction, .context = NULL, .phase = 0U},
+		{.timer = HARD_TIMER_INVALID, .function = alarmFunction, .context = NULL, .phase = 1U},
+	};
+	freq_t freq = 10U;
+	CHECK(setHardTimerGroup(entries, 2U, 4U, &freq, 1U, NULL));
+
+	for (uint8_t i = 0U; i < 2U; i++) {
+		hard_timer_t timer = entries[i].timer;
+		CHECK(fakeTimerAlarm(timerGroups[timer].group, timerGroups[timer].num));
+
+		// ISR runs right after alarm
+		struct hardTimerLatency latency;
+		CHECK(hardTimerLatencyGet(timer, &latency));
+		CHECK_EQ(latency.count, 1U);
+		CHECK(latency.maxNS < LATENCY_LIMIT_NS);
+	}
+
+	CHECK(cancelHardTimer(entries[0].timer));
+	CHECK(cancelHardTimer(entries[1].timer));
+}
+
+#endif
+
+int main(void) {
+
+	RUN_TEST(testSolverSweep);
+	RUN_TEST(testStaticMatchesSolver);
+	RUN_TEST(testStaticContext);
+	RUN_TEST(testStaticNoContext);
+	RUN_TEST(testConcurrentClaims);
+	RUN_TEST(testGroupPhases);
+	#ifdef HARD_TIMER_LATENCY
+		RUN_TEST(testLatencyAfterPreload);
+	#endif
+
+	return TEST_END();
+}
@@ -0,0 +1,291 @@
+/*
+	test_trigger.c - host tests of trigger engine against sample vectors
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+
+#include "board_esp32_trigger.h"
+
+#include <math.h>
+
+#define TEST_CHANNEL 3U // channel tag watched by tests
+#define PRE_COUNT 5U // history kept by tests
+#define POST_COUNT 4U // samples after trigger, including trigger sample
+#define NOISY_LENGTH 4000U // samples in noisy sine vector
+#define NOISY_PERIOD 250U // samples per sine period
+
+/**
+ * Tags value with channel like the ADC does
+ *
+ * @param value conversion value
+ *
+ * @return raw sample of test channel
+ */
+#define TAG(value) ((adc_sample_t)((TEST_CHANNEL << 12U) | (value)))
+
+static trigger_t trigger;
+static adc_sample_t history[PRE_COUNT];
+static adc_sample_t frame[PRE_COUNT + POST_COUNT];
+
+/**
+ * Sets up and arms test trigger
+ *
+ * @param mode trigger mode
+ * @param level trigger level
+ * @param hysteresis edge hysteresis
+ * @param preCount samples kept before trigger
+ */
+static void arm(enum TriggerMode mode, uint16_t level, uint16_t hysteresis, uint16_t preCount) {
+
+	struct triggerConfig config = {
+		.mode = mode,
+		.channel = TEST_CHANNEL,
+		.level = level,
+		.hysteresis = hysteresis,
+		.preCount = preCount,
+		.postCount = POST_COUNT,
+	};
+	CHECK(triggerInit(&trigger, &config, history, frame));
+	CHECK(trigger.state == TRIGGER_IDLE);
+	triggerArm(&trigger);
+}
+
+/**
+ * Feeds values of test channel one by one
+ *
+ * @param values conversion values
+ * @param count amount of values
+ *
+ * @return index of sample completing frame, count if none did
+ */
+static uint16_t feedValues(const uint16_t *values, uint16_t count) {
+
+	for (uint16_t i = 0U; i < count; i++) {
+		if (triggerPush(&trigger, TAG(values[i]))) {
+			return i;
+		}
+	}
+	return count;
+}
+
+/**
+ * Checks completed frame against expected values
+ *
+ * @param expected values in time order
+ * @param count amount of values
+ */
+static void checkFrame(const uint16_t *expected, uint16_t count) {
+
+	uint16_t length = 0U;
+	const adc_sample_t *samples = triggerGetFrame(&trigger, &length);
+
+	CHECK(samples != NULL);
+	CHECK_EQ(length, count);
+	if (samples == NULL || length != count) {
+		return;
+	}
+	for (uint16_t i = 0U; i < count; i++) {
+		CHECK_EQ(ADC_SAMPLE_VALUE(samples[i]), expected[i]);
+	}
+}
+
+static void testInit(void) {
+
+	struct triggerConfig config = {
+		.mode = TRIGGER_RISING,
+		.channel = TEST_CHANNEL,
+		.preCount = PRE_COUNT,
+		.postCount = POST_COUNT,
+	};
+	CHECK(!triggerInit(&trigger, &config, NULL, frame));
+	CHECK(!triggerInit(&trigger, &config, history, NULL));
+	config.postCount = 0U;
+	CHECK(!triggerInit(&trigger, &config, history, frame));
+	config.preCount = UINT16_MAX;
+	config.postCount = 1U;
+	CHECK(!triggerInit(&trigger, &config, history, frame));
+
+	// idle trigger ignores samples
+	arm(TRIGGER_LEVEL_HIGH, 0U, 0U, 0U);
+	trigger.state = TRIGGER_IDLE;
+	adc_sample_t sample = TAG(100U);
+	CHECK_EQ(triggerFeed(&trigger, &sample, 1U), 0U);
+}
+
+static void testPreHistoryWraps(void) {
+
+	arm(TRIGGER_RISING, 2000U, 100U, PRE_COUNT);
+
+	// 12 samples below level wrap the 5 sample history twice
+	static const uint16_t values[] = {
+		100, 110, 120, 130, 140, 150, 160, 170, 180, 190, 200, 210,
+		2500, 2600, 2700, 2800, 2900, 3000,
+	};
+	uint16_t done = feedValues(values, sizeof(values) / sizeof(values[0]));
+	CHECK_EQ(done, 15U);
+	CHECK(trigger.state == TRIGGER_DONE);
+	CHECK_EQ(trigger.fired, 1U);
+
+	// oldest history first, trigger sample at preCount
+	static const uint16_t expected[] = {170, 180, 190, 200, 210, 2500, 2600, 2700, 2800};
+	checkFrame(expected, PRE_COUNT + POST_COUNT);
+
+	// done trigger ignores samples until armed again
+	adc_sample_t sample = TAG(10U);
+	CHECK_EQ(triggerFeed(&trigger, &sample, 1U), 0U);
+	triggerArm(&trigger);
+	CHECK(trigger.state == TRIGGER_FILLING);
+	CHECK(triggerGetFrame(&trigger, NULL) == NULL);
+}
+
+static void testNoFireWhileFilling(void) {
+
+	arm(TRIGGER_RISING, 2000U, 100U, PRE_COUNT);
+
+	// crossing before history is full is skipped, next edge needs re-arming below band
+	static const uint16_t values[] = {
+		100, 2500, 2600, 2700, 2800, 2900,
+		1950, 2500,
+		1800, 2100, 2200, 2300, 2400,
+	};
+	uint16_t done = feedValues(values, sizeof(values) / sizeof(values[0]));
+	CHECK_EQ(done, 12U);
+
+	static const uint16_t expected[] = {2800, 2900, 1950, 2500, 1800, 2100, 2200, 2300, 2400};
+	checkFrame(expected, PRE_COUNT + POST_COUNT);
+}
+
+static void testFallingAndLevels(void) {
+
+	static const uint16_t falling[] = {3000, 3000, 3000, 3000, 3000, 2050, 1990, 1500, 1000, 500};
+	arm(TRIGGER_FALLING, 2000U, 100U, PRE_COUNT);
+	CHECK_EQ(feedValues(falling, 10U), 9U);
+	static const uint16_t fallingFrame[] = {3000, 3000, 3000, 3000, 2050, 1990, 1500, 1000, 500};
+	checkFrame(fallingFrame, PRE_COUNT + POST_COUNT);
+
+	// level modes fire on the first sample once history is full
+	static const uint16_t levels[] = {4000, 4000, 4000, 4000, 4000, 4000, 1, 2, 3};
+	arm(TRIGGER_LEVEL_HIGH, 3000U, 0U, PRE_COUNT);
+	CHECK_EQ(feedValues(levels, 9U), 8U);
+
+	arm(TRIGGER_LEVEL_LOW, 3000U, 0U, PRE_COUNT);
+	CHECK_EQ(feedValues(levels, 9U), 9U);
+	CHECK(trigger.state == TRIGGER_POST);
+	CHECK_EQ(trigger.frameLength, PRE_COUNT + 3U);
+
+	// no history fires on first matching sample
+	arm(TRIGGER_LEVEL_LOW, 3000U, 0U, 0U);
+	CHECK(trigger.state == TRIGGER_ARMED);
+	CHECK_EQ(feedValues(levels, 9U), 9U);
+	CHECK(trigger.state == TRIGGER_POST);
+}
+
+static void testOtherChannel(void) {
+
+	arm(TRIGGER_RISING, 2000U, 100U, 2U);
+
+	// other channel samples fill history but never fire
+	adc_sample_t samples[] = {
+		TAG(100U), TAG(100U),
+		(adc_sample_t)((1U << 12U) | 4000U),
+		TAG(2500U), TAG(2600U), TAG(2700U), TAG(2800U),
+	};
+	CHECK_EQ(triggerFeed(&trigger, samples, 7U), 7U);
+	CHECK(trigger.state == TRIGGER_DONE);
+
+	uint16_t length;
+	const adc_sample_t *out = triggerGetFrame(&trigger, &length);
+	CHECK_EQ(length, 2U + POST_COUNT);
+	CHECK_EQ(out[0], TAG(100U));
+	CHECK_EQ(out[1], (1U << 12U) | 4000U);
+	CHECK_EQ(out[2], TAG(2500U));
+}
+
+static void testFeedBlock(void) {
+
+	arm(TRIGGER_RISING, 2000U, 100U, 2U);
+
+	// time order 10 20 30 2500 2600 2700 2800 2900 stored in swapped pairs
+	adc_sample_t samples[] = {
+		TAG(20U), TAG(10U), TAG(2500U), TAG(30U),
+		TAG(2700U), TAG(2600U), TAG(2900U), TAG(2800U),
+	};
+	adc_block_t block = {.samples = samples, .length = 8U};
+
+	CHECK_EQ(triggerFeedBlock(&trigger, &block), 7U);
+	static const uint16_t expected[] = {20, 30, 2500, 2600, 2700, 2800};
+	checkFrame(expected, 2U + POST_COUNT);
+}
+
+static void testNoisySine(void) {
+
+	// recorded style vector, sine with noise bigger than the level step
+	static adc_sample_t samples[NOISY_LENGTH];
+	uint32_t seed = 12345U;
+	for (uint16_t i = 0U; i < NOISY_LENGTH; i++) {
+		seed = seed * 1103515245U + 12345U;
+		int32_t noise = (int32_t)((seed >> 16U) % 61U) - 30;
+		double phase = 2.0 * M_PI * (double)i / NOISY_PERIOD;
+		int32_t value = 2048 + (int32_t)lround(1500.0 * sin(phase)) + noise;
+		samples[i] = TAG((uint16_t)value);
+	}
+
+	// hysteresis over noise gives one edge per period
+	arm(TRIGGER_RISING, 2048U, 80U, PRE_COUNT);
+
+	uint16_t used = 0U;
+	uint16_t frames = 0U;
+	uint16_t lastTrigger = 0U;
+	while (used < NOISY_LENGTH) {
+		uint16_t count = triggerFeed(&trigger, samples + used, NOISY_LENGTH - used);
+		used += count;
+		if (trigger.state != TRIGGER_DONE) {
+			break;
+		}
+
+		uint16_t length;
+		const adc_sample_t *out = triggerGetFrame(&trigger, &length);
+		CHECK(ADC_SAMPLE_VALUE(out[PRE_COUNT]) >= 2048U);
+		CHECK(ADC_SAMPLE_VALUE(out[0]) < 2048U + 100U);
+
+		// sample index of trigger, edges sit near each period start
+		uint16_t at = used - POST_COUNT;
+		uint16_t offset = at % NOISY_PERIOD;
+		CHECK(offset < 10U || offset > NOISY_PERIOD - 10U);
+		if (frames > 0U) {
+			CHECK((uint16_t)(at - lastTrigger) > NOISY_PERIOD / 2U);
+		}
+		lastTrigger = at;
+		frames++;
+		triggerArm(&trigger);
+	}
+
+	CHECK_EQ(frames, NOISY_LENGTH / NOISY_PERIOD - 1U);
+}
+
+int main(void) {
+
+	RUN_TEST(testInit);
+	RUN_TEST(testPreHistoryWraps);
+	RUN_TEST(testNoFireWhileFilling);
+	RUN_TEST(testFallingAndLevels);
+	RUN_TEST(testOtherChannel);
+	RUN_TEST(testFeedBlock);
+	RUN_TEST(testNoisySine);
+
+	return TEST_END();
+}
@@ -0,0 +1,207 @@
+/*
+	test_wheel.c - host tests of virtual timer wheel
+	Copyright (C) 2025 Camren Chraplak
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "test.h"
+#include "fake.h"
+
+// built in to reach wheel ticks and slots
+#include "board_esp32_wheel.c"
+
+#include <sched.h>
+#include <stdlib.h>
+
+#define TEST_TIMERS 200U // virtual timers of random sweep
+#define TEST_SPAN 300000U // ticks driven by random sweep, past level 2
+#define TEST_IDLE (1UL << 23U) // ticks skipped while wheel sleeps, level 3
+#define STAT_TICKS ((1UL << 31U) - 1U) // ticks no stepping could catch up on
+
+static hard_timer_t tickTimer = HARD_TIMER_INVALID;
+static wheel_timer_t timers[TEST_TIMERS];
+static uint32_t want[TEST_TIMERS]; // tick of next expected run
+static uint32_t periods[TEST_TIMERS];
+static uint32_t fired[TEST_TIMERS];
+static uint32_t late = 0U; // runs on a tick other than expected
+
+/**
+ * Records run of timer against its expected tick
+ *
+ * @param context index of timer
+ */
+static void recordRun(void *context) {
+
+	uintptr_t index = (uintptr_t)context;
+
+	if (wheelNow != want[index]) {
+		late++;
+	}
+	fired[index]++;
+	want[index] += periods[index];
+}
+
+/**
+ * Counts ticks through timer alarms, like hardware does
+ *
+ * @param ticks alarms to raise
+ */
+static void tick(uint32_t ticks) {
+
+	// timers alternate groups, timer0 is group 0 timer 0, timer1 is group 1 timer 0
+	for (uint32_t i = 0U; i < ticks; i++) {
+		fakeTimerAlarm(tickTimer % 2U, tickTimer / 2U);
+	}
+}
+
+/**
+ * Wakes wheel task and waits for it to process every counted tick
+ *
+ * @note ISR only wakes task for due slots, so idle ticks wait for a wake
+ */
+static void settle(void) {
+
+	xTaskNotifyGive(wheelTask);
+	while (true) {
+		xSemaphoreTake(wheelMutex, portMAX_DELAY);
+		bool caught = wheelNow == wheelTicks;
+		xSemaphoreGive(wheelMutex);
+		if (caught) {
+			return;
+		}
+		sched_yield();
+	}
+}
+
+/**
+ * Gets ticks skipped by idle search
+ *
+ * @return idle ticks after wheelNow
+ */
+static uint32_t idleTicks(void) {
+
+	xSemaphoreTake(wheelMutex, portMAX_DELAY);
+	uint32_t idle = wheelIdleTicks();
+	xSemaphoreGive(wheelMutex);
+
+	return idle;
+}
+
+/****************************
+ * Tests
+****************************/
+
+static void testStartOnCore(void) {
+
+	fakeSetCore(WHEEL_CORE == 0 ? 1 : 0);
+	CHECK(wheelStart(&tickTimer, 1U));
+	CHECK(tickTimer != HARD_TIMER_INVALID);
+
+	// tick ISR sits on WHEEL_CORE beside wheel task
+	CHECK_EQ(fakeIntrLastCore(), WHEEL_CORE);
+	CHECK_EQ(fakeIntrLive(), 1U);
+}
+
+static void testIdleTicks(void) {
+
+	CHECK_EQ(idleTicks(), UINT32_MAX);
+
+	// timer on a higher level stops search at next level 0 wrap
+	wheelTimerInit(&timers[1], recordRun, (void *)1U);
+	periods[1] = 0U;
+	want[1] = wheelTicks + 1000U;
+	CHECK(wheelTimerStart(&timers[1], 1000U * WHEEL_TICK_US, 0U));
+	CHECK_EQ(idleTicks(), WHEEL_SLOTS - (wheelNow & WHEEL_MASK) - 1U);
+
+	// level 0 slot stops it sooner
+	wheelTimerInit(&timers[0], recordRun, (void *)0U);
+	periods[0] = 0U;
+	want[0] = wheelTicks + 5U;
+	CHECK(wheelTimerStart(&timers[0], 5U * WHEEL_TICK_US, 0U));
+	CHECK_EQ(idleTicks(), 4U);
+
+	// cancelled slots stay marked, but an empty wheel skips everything
+	CHECK(wheelTimerCancel(&timers[0]));
+	CHECK(wheelTimerCancel(&timers[1]));
+	CHECK_EQ(idleTicks(), UINT32_MAX);
+}
+
+static void testRandomSweep(void) {
+
+	srand(7);
+	late = 0U;
+	uint32_t start = wheelTicks;
+
+	for (uintptr_t i = 0U; i < TEST_TIMERS; i++) {
+		uint32_t delay = 1U + (uint32_t)rand() % ((i % 3U == 0U) ? 200U : TEST_SPAN);
+		periods[i] = (i % 7U == 0U) ? 1U + (uint32_t)rand() % 5000U : 0U;
+		want[i] = start + delay;
+		fired[i] = 0U;
+		wheelTimerInit(&timers[i], recordRun, (void *)i);
+		CHECK(wheelTimerStart(&timers[i], delay * WHEEL_TICK_US, periods[i] * WHEEL_TICK_US));
+	}
+
+	tick(TEST_SPAN);
+	settle();
+
+	// every run lands on its own tick even while task jumps ahead
+	CHECK_EQ(late, 0U);
+	for (uint32_t i = 0U; i < TEST_TIMERS; i++) {
+		uint32_t first = want[i] - fired[i] * periods[i];
+		uint32_t runs = (periods[i] == 0U) ? 1U : 1U + (start + TEST_SPAN - first) / periods[i];
+		CHECK_EQ(fired[i], runs);
+		wheelTimerCancel(&timers[i]);
+	}
+}
+
+static void testIdleJump(void) {
+
+	late = 0U;
+	periods[0] = 0U;
+	fired[0] = 0U;
+	want[0] = wheelTicks + TEST_IDLE;
+	wheelTimerInit(&timers[0], recordRun, (void *)0U);
+	CHECK(wheelTimerStart(&timers[0], TEST_IDLE * WHEEL_TICK_US, 0U));
+
+	// ISR ticks counted while task slept, as after a long busy stretch
+	wheelTicks += TEST_IDLE + 10U;
+	settle();
+	CHECK_EQ(fired[0], 1U);
+	CHECK_EQ(late, 0U);
+
+	// empty wheel catches up on any gap in one step
+	wheelTicks += STAT_TICKS;
+	settle();
+	CHECK_EQ(wheelPending, 0U);
+}
+
+static void testStop(void) {
+
+	CHECK(wheelStop());
+	CHECK(!wheelStop());
+	CHECK_EQ(fakeIntrLive(), 0U);
+	CHECK(!hardTimerStarted(tickTimer));
+}
+
+int main(void) {
+
+	RUN_TEST(testStartOnCore);
+	RUN_TEST(testIdleTicks);
+	RUN_TEST(testRandomSweep);
+	RUN_TEST(testIdleJump);
+	RUN_TEST(testStop);
+
+	return TEST_END();
+}